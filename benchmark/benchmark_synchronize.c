@@ -0,0 +1,213 @@
+// Compares the synchronization backends of the thread pool library, each at 1, 8 and 64 threads
+// (or the thread counts given as arguments).
+//
+// futex backend (linux default):
+//   gcc -O2 -I../threadpool benchmark_synchronize.c ../threadpool/*.c -o benchmark_futex -lpthread
+//
+// pthread backend:
+//   gcc -O2 -DSYNC_USE_PTHREAD -I../threadpool benchmark_synchronize.c ../threadpool/*.c -o benchmark_pthread -lpthread
+
+/*---------------------------------------------------------------------------*/
+/* FILE INCLUSION */
+/*---------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "synchronize.h"
+#include "task_queue.h"
+#include "thread_pool.h"
+
+/*---------------------------------------------------------------------------*/
+/* MACRO DEFINITIONS */
+/*---------------------------------------------------------------------------*/
+
+// lock/unlock pairs executed by all threads of the mutex benchmark together
+#define MUTEX_OPERATIONS        4000000
+
+// bursts of one task per thread submitted by the handoff benchmark
+#define HANDOFF_ROUNDS          2000
+
+// tasks queued by the throughput benchmark
+#define THROUGHPUT_TASKS        1000000
+
+// most threads measured
+#define MAX_THREADS             256
+
+/*---------------------------------------------------------------------------*/
+/* OBJECT DECLARATIONS */
+/*---------------------------------------------------------------------------*/
+
+// mutex benchmark
+static THREAD_MUTEX     benchMutex;
+static unsigned long    benchCounter = 0;
+static unsigned int     benchOperations = 0;
+
+// number of tasks executed
+static THREAD_ATOMIC    tasksDone = 0;
+
+/*---------------------------------------------------------------------------*/
+/* STATIC FUNCTION DEFINITIONS */
+/*---------------------------------------------------------------------------*/
+
+// nanoseconds since an arbitrary point in time
+static double GetTimeNs()
+{
+    struct timespec currentTime;
+    clock_gettime(CLOCK_MONOTONIC, &currentTime);
+    return ((double)currentTime.tv_sec * 1e9) + (double)currentTime.tv_nsec;
+}
+
+// takes and releases the shared mutex around a short critical section
+static THREAD_FUNC WINAPI MutexThreadFunction(void *threadContext)
+{
+    unsigned int i = 0;
+
+    for(i = 0; i < benchOperations; i++)
+    {
+        SyncLockMutex(&benchMutex);
+        benchCounter++;
+        SyncUnlockMutex(&benchMutex);
+    }
+
+    return THREAD_FUNC_RETURN;
+}
+
+static void* TaskFunction(TASK_QUEUE_WORK_DATA *taskData, void *threadContext, void *taskItemData)
+{
+    SyncAtomicIncrement(&tasksDone);
+    return 0;
+}
+
+static void AddTask(THREAD_POOL_DATA *threadPool)
+{
+    TASK_QUEUE_ITEM *taskQueueItem = CreateTaskQueueItem();
+    taskQueueItem->taskItemFunction = TaskFunction;
+    AddTaskToThreadPool(threadPool, taskQueueItem);
+}
+
+// ns per lock/unlock pair with every thread contending for one mutex
+static double BenchmarkMutex(unsigned int numThreads)
+{
+    unsigned int i = 0;
+    double startTime = 0;
+    THREAD threadIds[MAX_THREADS];
+
+    SyncCreateMutex(&benchMutex, NULL);
+    benchCounter = 0;
+    benchOperations = MUTEX_OPERATIONS / numThreads;
+
+    startTime = GetTimeNs();
+    for(i = 0; i < numThreads; i++)
+    {
+        SyncCreateThread(&threadIds[i], NULL, MutexThreadFunction, NULL);
+    }
+    for(i = 0; i < numThreads; i++)
+    {
+        SyncJoinThread(threadIds[i], NULL);
+    }
+
+    SyncDestroyMutex(&benchMutex);
+    return (GetTimeNs() - startTime) / (double)(benchOperations * numThreads);
+}
+
+// us per burst of one task per thread, the threads park between bursts (no spinning)
+static double BenchmarkHandoff(unsigned int numThreads)
+{
+    unsigned int i = 0;
+    unsigned int j = 0;
+    double startTime = 0;
+
+    TASK_QUEUE_DATA *taskQueue = CreateTaskQueue(1);
+    THREAD_POOL_OPTIONS poolOptions;
+    THREAD_POOL_DATA *threadPool = 0;
+
+    memset(&poolOptions, 0, sizeof(THREAD_POOL_OPTIONS));
+    poolOptions.maxBatchSize = 1;
+    threadPool = CreateThreadPoolWithOptions(numThreads, taskQueue, &poolOptions, NULL, NULL, NULL);
+
+    tasksDone = 0;
+    startTime = GetTimeNs();
+    for(i = 0; i < HANDOFF_ROUNDS; i++)
+    {
+        for(j = 0; j < numThreads; j++)
+        {
+            AddTask(threadPool);
+        }
+        while(SyncAtomicLoad(&tasksDone) < (long)((i + 1) * numThreads))
+        {
+            SyncYieldThread();
+        }
+    }
+
+    DestroyThreadPool(threadPool);
+    DestroyTaskQueue(taskQueue);
+    return (GetTimeNs() - startTime) / (HANDOFF_ROUNDS * 1e3);
+}
+
+// ns per task queued and executed through the mutex guarded list queue with the default wait policy
+static double BenchmarkThroughput(unsigned int numThreads)
+{
+    unsigned int i = 0;
+    double startTime = 0;
+
+    TASK_QUEUE_DATA *taskQueue = CreateTaskQueue(1);
+    THREAD_POOL_OPTIONS poolOptions;
+    THREAD_POOL_DATA *threadPool = 0;
+
+    memset(&poolOptions, 0, sizeof(THREAD_POOL_OPTIONS));
+    poolOptions.spinCount = THREAD_POOL_DEFAULT_SPIN_COUNT;
+    poolOptions.yieldCount = THREAD_POOL_DEFAULT_YIELD_COUNT;
+    threadPool = CreateThreadPoolWithOptions(numThreads, taskQueue, &poolOptions, NULL, NULL, NULL);
+
+    tasksDone = 0;
+    startTime = GetTimeNs();
+    for(i = 0; i < THROUGHPUT_TASKS; i++)
+    {
+        AddTask(threadPool);
+    }
+    while(SyncAtomicLoad(&tasksDone) < THROUGHPUT_TASKS)
+    {
+        SyncYieldThread();
+    }
+
+    DestroyThreadPool(threadPool);
+    DestroyTaskQueue(taskQueue);
+    return (GetTimeNs() - startTime) / THROUGHPUT_TASKS;
+}
+
+/*---------------------------------------------------------------------------*/
+/* MAIN */
+/*---------------------------------------------------------------------------*/
+
+int main(int argc, char **argv)
+{
+    int i = 0;
+
+    // thread counts to measure
+    unsigned int defaultCounts[] = { 1, 8, 64 };
+    unsigned int numThreads = 0;
+
+#ifdef SYNC_USE_FUTEX
+    printf("backend: futex\n");
+#else
+    printf("backend: pthread\n");
+#endif
+    printf("%8s %16s %16s %16s\n", "threads", "mutex (ns/op)", "handoff (us)", "queue (ns/task)");
+
+    for(i = 0; i < ((argc > 1) ? argc - 1 : 3); i++)
+    {
+        numThreads = (argc > 1) ? (unsigned int)atoi(argv[i + 1]) : defaultCounts[i];
+        if((numThreads == 0) || (numThreads > MAX_THREADS))
+        {
+            continue;
+        }
+
+        printf("%8u %16.1f %16.1f %16.1f\n", numThreads,
+            BenchmarkMutex(numThreads), BenchmarkHandoff(numThreads), BenchmarkThroughput(numThreads));
+    }
+
+    return 0;
+}
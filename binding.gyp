@@ -14,6 +14,7 @@
             './source/file_manager.cc',
             './source/json_utility.cc',
             './source/callback_queue.cc',
+            './source/resolver_table.cc',
             './source/utilities.cc',
             './source/ndlopen.cc',
             './source/nrequire.cc',
@@ -67,8 +68,10 @@
 
         'sources': [
             './threadpool/synchronize.c',
+            './threadpool/memory_pool.c',
             './threadpool/task_queue.c',
-            './threadpool/thread_pool.c'
+            './threadpool/thread_pool.c',
+            './threadpool/timer_wheel.c'
         ],
 
         'conditions': [
@@ -11,6 +11,7 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <vector>
 
 // memset(...)
 #include <string.h>
@@ -28,6 +29,7 @@
 // custom source
 #include "thread.h"
 #include "file_manager.h"
+#include "resolver_table.h"
 
 /*---------------------------------------------------------------------------*/
 /* NAMESPACES */
@@ -40,13 +42,47 @@ using namespace v8;
 /* MACRO DEFINITIONS */
 /*---------------------------------------------------------------------------*/
 
+// id of the first thread pool (also the id of its task queue)
 #define TASK_QUEUE_ID       1
 
+// prefix of worker thread names (followed by the thread index, e.g. npool-w3)
+#define THREAD_NAME_DEFAULT "npool-w"
+
+// smallest worker thread stack size (bytes) accepted
+#define THREAD_STACK_MIN    (256 * 1024)
+
 /*---------------------------------------------------------------------------*/
 /* TYPE DECLARATIONS */
 /*---------------------------------------------------------------------------*/
 
-/* N/A */
+// thread pool created by createThreadPool, each with its own task queue and threads
+typedef struct THREAD_POOL_INSTANCE_STRUCT
+{
+    // handle returned to javascript and the optional name (empty for the default pool)
+    uint32_t                poolId;
+    std::string             poolName;
+
+    // thread pool
+    THREAD_POOL_DATA        *threadPool;
+    TASK_QUEUE_DATA         *taskQueue;
+
+    // task queue drain notification
+    uv_async_t              *drainAsync;
+    Nan::Callback           *drainCallback;
+
+    // time (ms) a unit of work may run when it does not specify a timeout (0 runs without a limit)
+    uint32_t                timeoutMs;
+
+    // units of work queued to the pool whose callback has not been called
+    THREAD_WORK_GROUP       *workGroup;
+
+    // graceful destruction, the pool rejects work while it drains and is destroyed once it drained
+    // or the drain timer fires, whichever comes first
+    bool                    isDraining;
+    uv_timer_t              *destroyTimer;
+    Nan::Callback           *destroyCallback;
+
+} THREAD_POOL_INSTANCE;
 
 /*---------------------------------------------------------------------------*/
 /* FUNCTION PROTOTYPES */
@@ -56,9 +92,9 @@ using namespace v8;
 /* OBJECT DECLARATIONS */
 /*---------------------------------------------------------------------------*/
 
-// thread pool
-static THREAD_POOL_DATA     *threadPool     = 0;
-static TASK_QUEUE_DATA      *taskQueue      = 0;
+// thread pools and the id of the next one
+static std::vector<THREAD_POOL_INSTANCE*>   threadPools;
+static uint32_t                             nextPoolId      = TASK_QUEUE_ID;
 
 // file loader and hash
 static FileManager          *fileManager    = 0;
@@ -67,6 +103,404 @@ static FileManager          *fileManager    = 0;
 /* STATIC FUNCTION DEFINITIONS */
 /*---------------------------------------------------------------------------*/
 
+// returns false if the options object contains invalid values
+static bool GetTaskQueueOptions(Local<Object> v8Options, TASK_QUEUE_OPTIONS *queueOptions)
+{
+    Nan::HandleScope scope;
+
+    // default to an unbounded list queue
+    memset(queueOptions, 0, sizeof(TASK_QUEUE_OPTIONS));
+    queueOptions->queueType = TASK_QUEUE_TYPE_LIST;
+
+    // queueType
+    Local<Value> queueType = Nan::Get(v8Options, Nan::New<String>("queueType").ToLocalChecked()).ToLocalChecked();
+    if(!queueType->IsUndefined())
+    {
+        Nan::Utf8String queueTypeString(queueType);
+        if(strcmp(*queueTypeString, "ring") == 0)
+        {
+            queueOptions->queueType = TASK_QUEUE_TYPE_RING;
+        }
+        else if(strcmp(*queueTypeString, "fair") == 0)
+        {
+            queueOptions->queueType = TASK_QUEUE_TYPE_FAIR;
+        }
+        else if(strcmp(*queueTypeString, "list") != 0)
+        {
+            return false;
+        }
+    }
+
+    // queueCapacity
+    Local<Value> queueCapacity = Nan::Get(v8Options, Nan::New<String>("queueCapacity").ToLocalChecked()).ToLocalChecked();
+    if(!queueCapacity->IsUndefined())
+    {
+        if(!queueCapacity->IsUint32())
+        {
+            return false;
+        }
+        queueOptions->queueCapacity = queueCapacity->Uint32Value();
+    }
+
+    // queueLowWaterMark
+    Local<Value> queueLowWaterMark = Nan::Get(v8Options, Nan::New<String>("queueLowWaterMark").ToLocalChecked()).ToLocalChecked();
+    if(!queueLowWaterMark->IsUndefined())
+    {
+        if(!queueLowWaterMark->IsUint32())
+        {
+            return false;
+        }
+        queueOptions->queueLowWaterMark = queueLowWaterMark->Uint32Value();
+    }
+
+    // drainCallback (the async handle is created by the caller)
+    Local<Value> queueDrainCallback = Nan::Get(v8Options, Nan::New<String>("drainCallback").ToLocalChecked()).ToLocalChecked();
+    if(!queueDrainCallback->IsUndefined() && !queueDrainCallback->IsFunction())
+    {
+        return false;
+    }
+
+    return true;
+}
+
+// returns true if the options limit the units of work queued, through a capacity or a drain callback
+static bool HasQueueBackpressure(Local<Object> v8Options, const TASK_QUEUE_OPTIONS *queueOptions)
+{
+    Nan::HandleScope scope;
+
+    Local<Value> queueDrainCallback = Nan::Get(v8Options, Nan::New<String>("drainCallback").ToLocalChecked()).ToLocalChecked();
+    return (queueOptions->queueCapacity > 0) || queueDrainCallback->IsFunction();
+}
+
+// called from the thread that drained the task queue
+static void QueueDrainCallback(void* drainContext)
+{
+    uv_async_send((uv_async_t*)drainContext);
+}
+
+// called on the node thread after the task queue drained
+#if NODE_VERSION_AT_LEAST(0, 11, 13)
+static void uvDrainCallback(uv_async_t* handle)
+#else
+static void uvDrainCallback(uv_async_t* handle, int status)
+#endif
+{
+    Nan::HandleScope scope;
+
+    // thread pool of the drained queue
+    THREAD_POOL_INSTANCE *poolInstance = (THREAD_POOL_INSTANCE*)handle->data;
+
+    if(poolInstance->drainCallback != 0)
+    {
+        poolInstance->drainCallback->Call(0, NULL);
+    }
+}
+
+static void uvDrainCloseCallback(uv_handle_t* handle)
+{
+    free(handle);
+}
+
+// destroys the threads and task queue of a pool and releases the pool instance
+// units of work still queued are discarded without their callback
+static void ReleaseThreadPoolInstance(THREAD_POOL_INSTANCE *poolInstance)
+{
+    // units of work waiting for their partial results to be delivered give up, this thread no longer delivers them
+    SyncAtomicStore(&(poolInstance->workGroup->isDestroying), 1);
+
+    // destroy thread pool and task queue
+    DestroyThreadPool(poolInstance->threadPool);
+    DestroyTaskQueue(poolInstance->taskQueue);
+
+    // units of work still awaiting their callback release the group once they are delivered
+    Thread::ReleaseWorkGroup(poolInstance->workGroup);
+
+    // destroy the drain notification
+    if(poolInstance->drainAsync != 0)
+    {
+        uv_close((uv_handle_t*)poolInstance->drainAsync, uvDrainCloseCallback);
+        delete poolInstance->drainCallback;
+    }
+
+    // release the pool instance because its handle is no longer valid
+    for(size_t i = 0; i < threadPools.size(); i++)
+    {
+        if(threadPools[i] == poolInstance)
+        {
+            threadPools.erase(threadPools.begin() + i);
+            break;
+        }
+    }
+    delete poolInstance;
+
+    // no work item runs with a timeout until a pool is created again
+    if(threadPools.empty())
+    {
+        Thread::StopWatchdog();
+    }
+}
+
+// called on the node thread once a draining pool drained or its drain timed out
+#if NODE_VERSION_AT_LEAST(0, 11, 13)
+static void uvDestroyTimerCallback(uv_timer_t* handle)
+#else
+static void uvDestroyTimerCallback(uv_timer_t* handle, int status)
+#endif
+{
+    Nan::HandleScope scope;
+
+    // thread pool being destroyed
+    THREAD_POOL_INSTANCE *poolInstance = (THREAD_POOL_INSTANCE*)handle->data;
+
+    // report whether every unit of work was delivered before the pool is destroyed
+    bool isDrained = (SyncAtomicLoad(&(poolInstance->workGroup->numWorkItems)) == 0);
+    Nan::Callback *destroyCallback = poolInstance->destroyCallback;
+
+    // units of work released while the threads terminate must not restart the timer
+    poolInstance->workGroup->groupDrained = 0;
+    uv_close((uv_handle_t*)handle, uvDrainCloseCallback);
+    ReleaseThreadPoolInstance(poolInstance);
+
+    if(destroyCallback != 0)
+    {
+        const unsigned argc = 1;
+        Local<Value> argv[argc] = { Nan::New<Boolean>(isDrained) };
+        destroyCallback->Call(argc, argv);
+        delete destroyCallback;
+    }
+}
+
+// called on the node thread after the callback of the last unit of work of a draining pool
+static void ThreadPoolDrained(void* groupContext)
+{
+    // destroy the pool once the callback returned
+    THREAD_POOL_INSTANCE *poolInstance = (THREAD_POOL_INSTANCE*)groupContext;
+    uv_timer_start(poolInstance->destroyTimer, uvDestroyTimerCallback, 0, 0);
+}
+
+// returns the thread pool with the given name, an empty name refers to the default pool (0 if it does not exist)
+static THREAD_POOL_INSTANCE* FindThreadPoolInstance(const std::string &poolName)
+{
+    for(size_t i = 0; i < threadPools.size(); i++)
+    {
+        if(threadPools[i]->poolName == poolName)
+        {
+            return threadPools[i];
+        }
+    }
+
+    return 0;
+}
+
+// returns the thread pool a handle refers to (0 if it does not exist)
+// the handle is the id returned by createThreadPool or the pool name, undefined refers to the default pool
+static THREAD_POOL_INSTANCE* GetThreadPoolInstance(Local<Value> v8PoolHandle)
+{
+    Nan::HandleScope scope;
+
+    if(v8PoolHandle->IsUndefined())
+    {
+        return FindThreadPoolInstance(std::string());
+    }
+    else if(v8PoolHandle->IsUint32())
+    {
+        uint32_t poolId = v8PoolHandle->Uint32Value();
+        for(size_t i = 0; i < threadPools.size(); i++)
+        {
+            if(threadPools[i]->poolId == poolId)
+            {
+                return threadPools[i];
+            }
+        }
+    }
+    else if(v8PoolHandle->IsString() && (v8PoolHandle->ToString()->Length() > 0))
+    {
+        Nan::Utf8String poolName(v8PoolHandle);
+        return FindThreadPoolInstance(*poolName);
+    }
+
+    return 0;
+}
+
+// reads an optional uint32 option, false if it is present but not a uint32
+static bool GetUint32Option(Local<Object> v8Options, const char *optionName, uint32_t *optionValue, bool *isSet)
+{
+    Nan::HandleScope scope;
+
+    Local<Value> v8Option = Nan::Get(v8Options, Nan::New<String>(optionName).ToLocalChecked()).ToLocalChecked();
+    *isSet = !v8Option->IsUndefined();
+    if(!*isSet)
+    {
+        return true;
+    }
+    if(!v8Option->IsUint32())
+    {
+        return false;
+    }
+    *optionValue = v8Option->Uint32Value();
+    return true;
+}
+
+// returns false if the options object contains invalid values
+// the processor set and thread name are stored in affinityCpus and threadName, which must outlive poolOptions
+static bool GetThreadPoolOptions(Local<Object> v8Options, uint32_t numThreads, THREAD_POOL_OPTIONS *poolOptions, std::vector<unsigned int> *affinityCpus, std::string *threadName)
+{
+    Nan::HandleScope scope;
+
+    // default to the shared scheduler
+    memset(poolOptions, 0, sizeof(THREAD_POOL_OPTIONS));
+    poolOptions->schedulerType = THREAD_POOL_SCHEDULER_SHARED;
+
+    // scheduler
+    Local<Value> schedulerType = Nan::Get(v8Options, Nan::New<String>("scheduler").ToLocalChecked()).ToLocalChecked();
+    if(!schedulerType->IsUndefined())
+    {
+        Nan::Utf8String schedulerTypeString(schedulerType);
+        if(strcmp(*schedulerTypeString, "workStealing") == 0)
+        {
+            poolOptions->schedulerType = THREAD_POOL_SCHEDULER_WORK_STEALING;
+        }
+        else if(strcmp(*schedulerTypeString, "affinity") == 0)
+        {
+            poolOptions->schedulerType = THREAD_POOL_SCHEDULER_AFFINITY;
+        }
+        else if(strcmp(*schedulerTypeString, "shared") != 0)
+        {
+            return false;
+        }
+    }
+
+    // maxBatchSize
+    Local<Value> maxBatchSize = Nan::Get(v8Options, Nan::New<String>("maxBatchSize").ToLocalChecked()).ToLocalChecked();
+    if(!maxBatchSize->IsUndefined())
+    {
+        if(!maxBatchSize->IsUint32() || (maxBatchSize->Uint32Value() == 0))
+        {
+            return false;
+        }
+        poolOptions->maxBatchSize = maxBatchSize->Uint32Value();
+    }
+
+    // wait policy of idle threads
+    uint32_t spinCount = THREAD_POOL_DEFAULT_SPIN_COUNT, yieldCount = THREAD_POOL_DEFAULT_YIELD_COUNT;
+    bool spinCountSet = false, yieldCountSet = false;
+    if(!GetUint32Option(v8Options, "spinCount", &spinCount, &spinCountSet) ||
+        !GetUint32Option(v8Options, "yieldCount", &yieldCount, &yieldCountSet))
+    {
+        return false;
+    }
+    poolOptions->spinCount = spinCount;
+    poolOptions->yieldCount = yieldCount;
+
+    // elastic sizing, the pool starts with numThreads threads
+    uint32_t minThreads = numThreads, maxThreads = numThreads, idleTimeout = 0, spawnWaitTime = 0;
+    bool minThreadsSet = false, maxThreadsSet = false, idleTimeoutSet = false, spawnWaitTimeSet = false;
+    if(!GetUint32Option(v8Options, "minThreads", &minThreads, &minThreadsSet) ||
+        !GetUint32Option(v8Options, "maxThreads", &maxThreads, &maxThreadsSet) ||
+        !GetUint32Option(v8Options, "idleTimeoutMs", &idleTimeout, &idleTimeoutSet) ||
+        !GetUint32Option(v8Options, "spawnWaitMs", &spawnWaitTime, &spawnWaitTimeSet) ||
+        (minThreads > numThreads) || (maxThreads < numThreads))
+    {
+        return false;
+    }
+    if(minThreadsSet || maxThreadsSet || idleTimeoutSet || spawnWaitTimeSet)
+    {
+        // the other schedulers keep a fixed number of threads
+        if(poolOptions->schedulerType != THREAD_POOL_SCHEDULER_SHARED)
+        {
+            return false;
+        }
+
+        poolOptions->minThreads = minThreads;
+        poolOptions->maxThreads = maxThreads;
+        poolOptions->idleTimeout = (idleTimeoutSet || (minThreads == numThreads)) ? idleTimeout : THREAD_POOL_DEFAULT_IDLE_TIMEOUT;
+        poolOptions->spawnWaitTime = spawnWaitTimeSet ? spawnWaitTime : THREAD_POOL_DEFAULT_SPAWN_WAIT;
+    }
+    else
+    {
+        poolOptions->minThreads = numThreads;
+        poolOptions->maxThreads = numThreads;
+    }
+
+    // time a work item routed to a busy thread waits before an idle thread takes it
+    uint32_t affinityWaitTime = THREAD_POOL_DEFAULT_AFFINITY_WAIT;
+    bool affinityWaitTimeSet = false;
+    if(!GetUint32Option(v8Options, "affinityWaitMs", &affinityWaitTime, &affinityWaitTimeSet) ||
+        (affinityWaitTimeSet && ((affinityWaitTime == 0) || (poolOptions->schedulerType != THREAD_POOL_SCHEDULER_AFFINITY))))
+    {
+        return false;
+    }
+    poolOptions->affinityWaitTime = affinityWaitTime;
+
+    // thread placement
+    Local<Value> affinityPolicy = Nan::Get(v8Options, Nan::New<String>("affinity").ToLocalChecked()).ToLocalChecked();
+    if(!affinityPolicy->IsUndefined())
+    {
+        Nan::Utf8String affinityPolicyString(affinityPolicy);
+        if(strcmp(*affinityPolicyString, "compact") == 0)
+        {
+            poolOptions->affinityPolicy = THREAD_POOL_AFFINITY_COMPACT;
+        }
+        else if(strcmp(*affinityPolicyString, "scatter") == 0)
+        {
+            poolOptions->affinityPolicy = THREAD_POOL_AFFINITY_SCATTER;
+        }
+        else if(strcmp(*affinityPolicyString, "none") != 0)
+        {
+            return false;
+        }
+    }
+
+    Local<Value> v8Cpus = Nan::Get(v8Options, Nan::New<String>("cpus").ToLocalChecked()).ToLocalChecked();
+    if(!v8Cpus->IsUndefined())
+    {
+        if(!v8Cpus->IsArray() || (v8Cpus.As<Array>()->Length() == 0))
+        {
+            return false;
+        }
+        Local<Array> cpuArray = v8Cpus.As<Array>();
+        for(uint32_t i = 0; i < cpuArray->Length(); i++)
+        {
+            Local<Value> v8Cpu = Nan::Get(cpuArray, i).ToLocalChecked();
+            if(!v8Cpu->IsUint32())
+            {
+                return false;
+            }
+            affinityCpus->push_back(v8Cpu->Uint32Value());
+        }
+        poolOptions->affinityCpus = &((*affinityCpus)[0]);
+        poolOptions->numAffinityCpus = (unsigned int)affinityCpus->size();
+    }
+
+    // thread stack size
+    uint32_t stackSize = 0;
+    bool stackSizeSet = false;
+    if(!GetUint32Option(v8Options, "stackSize", &stackSize, &stackSizeSet) ||
+        (stackSizeSet && (stackSize < THREAD_STACK_MIN)))
+    {
+        return false;
+    }
+    poolOptions->stackSize = stackSize;
+
+    // thread name prefix (empty leaves threads unnamed)
+    Local<Value> v8ThreadName = Nan::Get(v8Options, Nan::New<String>("threadName").ToLocalChecked()).ToLocalChecked();
+    if(!v8ThreadName->IsUndefined())
+    {
+        if(!v8ThreadName->IsString())
+        {
+            return false;
+        }
+        *threadName = *Nan::Utf8String(v8ThreadName);
+        if(threadName->length() > THREAD_POOL_MAX_NAME_LENGTH)
+        {
+            return false;
+        }
+    }
+    poolOptions->threadName = threadName->c_str();
+
+    return true;
+}
+
 /*---------------------------------------------------------------------------*/
 /* FUNCTION DEFINITIONS */
 /*---------------------------------------------------------------------------*/
@@ -78,13 +512,29 @@ NAN_METHOD(CreateThreadPool)
     Nan::HandleScope();
 
     // validate input
-    if((info.Length() != 1) || !info[0]->IsNumber())
+    if((info.Length() < 1) || (info.Length() > 2) || !info[0]->IsNumber() ||
+        ((info.Length() == 2) && !info[1]->IsObject()))
     {
-        return Nan::ThrowError("createThreadPool() - Expects 1 arguments: 1) number of threads (uint32)");
+        return Nan::ThrowError("createThreadPool() - Expects 1-2 arguments: 1) number of threads (uint32) 2) options (object, optional)");
+    }
+
+    // pool name, only one pool exists per name (the default pool has none)
+    std::string poolName;
+    if(info.Length() == 2)
+    {
+        Local<Value> v8PoolName = Nan::Get(info[1]->ToObject(), Nan::New<String>("name").ToLocalChecked()).ToLocalChecked();
+        if(!v8PoolName->IsUndefined())
+        {
+            if(!v8PoolName->IsString() || (v8PoolName->ToString()->Length() == 0))
+            {
+                return Nan::ThrowError("createThreadPool() - Options are malformed");
+            }
+            poolName = *Nan::Utf8String(v8PoolName);
+        }
     }
 
     // ensure thread pool has not already been created
-    if((taskQueue != 0) || (threadPool != 0))
+    if(FindThreadPoolInstance(poolName) != 0)
     {
         return Nan::ThrowError("createThreadPool() - Thread pool already created");
     }
@@ -95,11 +545,85 @@ NAN_METHOD(CreateThreadPool)
 
     //fprintf(stdout, "[%u] nPool - Num Threads: %u\n", SyncGetThreadId(), numThreads);
 
+    // task queue and thread pool options
+    TASK_QUEUE_OPTIONS queueOptions;
+    THREAD_POOL_OPTIONS poolOptions;
+    std::vector<unsigned int> affinityCpus;
+    std::string threadName(THREAD_NAME_DEFAULT);
+    memset(&queueOptions, 0, sizeof(TASK_QUEUE_OPTIONS));
+    memset(&poolOptions, 0, sizeof(THREAD_POOL_OPTIONS));
+    poolOptions.spinCount = THREAD_POOL_DEFAULT_SPIN_COUNT;
+    poolOptions.yieldCount = THREAD_POOL_DEFAULT_YIELD_COUNT;
+    poolOptions.threadName = threadName.c_str();
+    uint32_t timeoutMs = 0, maxCallbacks = 0, maxCallbackTimeUs = 0;
+    bool timeoutMsSet = false, maxCallbacksSet = false, maxCallbackTimeUsSet = false;
+    if((info.Length() == 2) &&
+        (!GetTaskQueueOptions(info[1]->ToObject(), &queueOptions) ||
+         !GetThreadPoolOptions(info[1]->ToObject(), numThreads, &poolOptions, &affinityCpus, &threadName) ||
+         !GetUint32Option(info[1]->ToObject(), "timeoutMs", &timeoutMs, &timeoutMsSet) ||
+         !GetUint32Option(info[1]->ToObject(), "maxCallbacksPerTick", &maxCallbacks, &maxCallbacksSet) ||
+         !GetUint32Option(info[1]->ToObject(), "maxCallbackTimeUs", &maxCallbackTimeUs, &maxCallbackTimeUsSet) ||
+         // the other schedulers hand work items to threads without passing through the task queue
+         ((queueOptions.queueType == TASK_QUEUE_TYPE_FAIR) && (poolOptions.schedulerType != THREAD_POOL_SCHEDULER_SHARED)) ||
+         // the other schedulers buffer work items within per-thread inboxes (and deques) the capacity does not bound
+         ((poolOptions.schedulerType != THREAD_POOL_SCHEDULER_SHARED) && HasQueueBackpressure(info[1]->ToObject(), &queueOptions))))
+    {
+        return Nan::ThrowError("createThreadPool() - Options are malformed");
+    }
+
+    // deliver the completions sharing a callback function through one call
+    bool batchCallbacks = false;
+    if(info.Length() == 2)
+    {
+        Local<Value> v8BatchCallbacks = Nan::Get(info[1]->ToObject(), Nan::New<String>("batchCallbacks").ToLocalChecked()).ToLocalChecked();
+        if(!v8BatchCallbacks->IsUndefined() && !v8BatchCallbacks->IsBoolean())
+        {
+            return Nan::ThrowError("createThreadPool() - Options are malformed");
+        }
+        batchCallbacks = v8BatchCallbacks->IsTrue();
+    }
+
+    // create the pool instance
+    THREAD_POOL_INSTANCE *poolInstance = new THREAD_POOL_INSTANCE();
+    poolInstance->poolId = nextPoolId++;
+    poolInstance->poolName = poolName;
+    poolInstance->drainAsync = 0;
+    poolInstance->drainCallback = 0;
+    poolInstance->timeoutMs = timeoutMs;
+    poolInstance->workGroup = Thread::CreateWorkGroup();
+    poolInstance->workGroup->maxCallbacks = maxCallbacks;
+    poolInstance->workGroup->maxCallbackTimeUs = maxCallbackTimeUs;
+    poolInstance->workGroup->batchCallbacks = batchCallbacks;
+    poolInstance->isDraining = false;
+    poolInstance->destroyTimer = 0;
+    poolInstance->destroyCallback = 0;
+
+    // create the drain notification if requested
+    if(info.Length() == 2)
+    {
+        Local<Value> v8DrainCallback = Nan::Get(info[1]->ToObject(), Nan::New<String>("drainCallback").ToLocalChecked()).ToLocalChecked();
+        if(v8DrainCallback->IsFunction())
+        {
+            poolInstance->drainCallback = new Nan::Callback(v8DrainCallback.As<Function>());
+            poolInstance->drainAsync = (uv_async_t*)malloc(sizeof(uv_async_t));
+            memset(poolInstance->drainAsync, 0, sizeof(uv_async_t));
+            uv_async_init(uv_default_loop(), poolInstance->drainAsync, uvDrainCallback);
+            poolInstance->drainAsync->data = poolInstance;
+
+            queueOptions.queueDrainCallback = QueueDrainCallback;
+            queueOptions.queueDrainContext = poolInstance->drainAsync;
+        }
+    }
+
     // create task queue and thread pool
-    taskQueue = CreateTaskQueue(TASK_QUEUE_ID);
-    threadPool = CreateThreadPool(numThreads, taskQueue, Thread::ThreadInit, Thread::ThreadPostInit, Thread::ThreadDestroy);
+    poolInstance->taskQueue = CreateTaskQueueWithOptions(poolInstance->poolId, &queueOptions);
+    poolOptions.threadBatchEnter = Thread::ThreadBatchEnter;
+    poolOptions.threadBatchExit = Thread::ThreadBatchExit;
+    poolInstance->threadPool = CreateThreadPoolWithOptions(numThreads, poolInstance->taskQueue, &poolOptions, Thread::ThreadInit, Thread::ThreadPostInit, Thread::ThreadDestroy);
+    threadPools.push_back(poolInstance);
 
-    info.GetReturnValue().SetUndefined();
+    // return the pool handle
+    info.GetReturnValue().Set(Nan::New<Uint32>(poolInstance->poolId));
 }
 
 NAN_METHOD(DestoryThreadPool)
@@ -108,21 +632,111 @@ NAN_METHOD(DestoryThreadPool)
 
     Nan::HandleScope();
 
+    // the options are optional, a pool handle is never an object
+    int poolArgument = ((info.Length() > 0) && info[0]->IsObject()) ? 1 : 0;
+
+    // validate input
+    if(info.Length() > poolArgument + 1)
+    {
+        return Nan::ThrowError("destroyThreadPool() - Expects 0-2 arguments: 1) options (object, optional) 2) thread pool (uint32 or string, optional)");
+    }
+
+    // drain options
+    bool drain = false;
+    uint32_t timeoutMs = 0;
+    bool timeoutMsSet = false;
+    Local<Value> v8DestroyCallback = Nan::Undefined();
+    if(poolArgument == 1)
+    {
+        Local<Object> v8Options = info[0]->ToObject();
+        Local<Value> v8Drain = Nan::Get(v8Options, Nan::New<String>("drain").ToLocalChecked()).ToLocalChecked();
+        v8DestroyCallback = Nan::Get(v8Options, Nan::New<String>("callback").ToLocalChecked()).ToLocalChecked();
+        if((!v8Drain->IsUndefined() && !v8Drain->IsBoolean()) ||
+            !GetUint32Option(v8Options, "timeoutMs", &timeoutMs, &timeoutMsSet) ||
+            (!v8DestroyCallback->IsUndefined() && !v8DestroyCallback->IsFunction()))
+        {
+            return Nan::ThrowError("destroyThreadPool() - Options are malformed");
+        }
+        drain = v8Drain->IsTrue();
+
+        // the timeout and callback only apply to a draining pool
+        if(!drain && (timeoutMsSet || !v8DestroyCallback->IsUndefined()))
+        {
+            return Nan::ThrowError("destroyThreadPool() - Options are malformed");
+        }
+    }
+
     // ensure thread pool has already been created
-    if((threadPool == 0) || (taskQueue == 0))
+    THREAD_POOL_INSTANCE *poolInstance = GetThreadPoolInstance(info[poolArgument]);
+    if(poolInstance == 0)
     {
         return Nan::ThrowError("destroyThreadPool() - No thread pool exists to destroy");
     }
+    if(poolInstance->isDraining)
+    {
+        return Nan::ThrowError("destroyThreadPool() - Thread pool is already being destroyed");
+    }
 
-    // destroy thread pool and task queue
-    DestroyThreadPool(threadPool);
-    DestroyTaskQueue(taskQueue);
+    // destroy the pool immediately
+    if(!drain)
+    {
+        ReleaseThreadPoolInstance(poolInstance);
+        info.GetReturnValue().SetUndefined();
+        return;
+    }
+
+    // stop accepting work and destroy the pool once every unit of work was delivered (or the timeout expires)
+    poolInstance->isDraining = true;
+    if(v8DestroyCallback->IsFunction())
+    {
+        poolInstance->destroyCallback = new Nan::Callback(v8DestroyCallback.As<Function>());
+    }
+    poolInstance->destroyTimer = (uv_timer_t*)malloc(sizeof(uv_timer_t));
+    memset(poolInstance->destroyTimer, 0, sizeof(uv_timer_t));
+    uv_timer_init(uv_default_loop(), poolInstance->destroyTimer);
+    poolInstance->destroyTimer->data = poolInstance;
 
-    // reset the references because they are no longer valid
-    threadPool = 0;
-    taskQueue = 0;
+    if(SyncAtomicLoad(&(poolInstance->workGroup->numWorkItems)) == 0)
+    {
+        uv_timer_start(poolInstance->destroyTimer, uvDestroyTimerCallback, 0, 0);
+    }
+    else
+    {
+        poolInstance->workGroup->groupContext = poolInstance;
+        poolInstance->workGroup->groupDrained = ThreadPoolDrained;
+        if(timeoutMs > 0)
+        {
+            uv_timer_start(poolInstance->destroyTimer, uvDestroyTimerCallback, timeoutMs, 0);
+        }
+    }
 
-  info.GetReturnValue().SetUndefined();
+    info.GetReturnValue().SetUndefined();
+}
+
+NAN_METHOD(Resize)
+{
+    Nan::HandleScope();
+
+    // validate input
+    if((info.Length() < 1) || (info.Length() > 2) || !info[0]->IsUint32())
+    {
+        return Nan::ThrowError("resize() - Expects 1-2 arguments: 1) number of threads (uint32) 2) thread pool (uint32 or string, optional)");
+    }
+
+    // ensure thread pool has already been created
+    THREAD_POOL_INSTANCE *poolInstance = GetThreadPoolInstance(info[1]);
+    if(poolInstance == 0)
+    {
+        return Nan::ThrowError("resize() - No thread pool exists to resize");
+    }
+
+    // spawn or retire threads
+    if(ResizeThreadPool(poolInstance->threadPool, info[0]->Uint32Value()) != 0)
+    {
+        return Nan::ThrowError("resize() - Number of threads must be between 1 and maxThreads (shared scheduler only)");
+    }
+
+    info.GetReturnValue().SetUndefined();
 }
 
 NAN_METHOD(DestroyIsolates)
@@ -189,23 +803,342 @@ NAN_METHOD(QueueWork)
     Nan::HandleScope();
 
     // validate input
-    if((info.Length() != 1) || !info[0]->IsObject())
+    if((info.Length() < 1) || (info.Length() > 2) || !info[0]->IsObject())
     {
-        return Nan::ThrowError("work() - Expects 1 argument: 1) work item (object)");
+        return Nan::ThrowError("work() - Expects 1-2 arguments: 1) work item (object) 2) thread pool (uint32 or string, optional)");
+    }
+
+    // ensure thread pool has already been created
+    THREAD_POOL_INSTANCE *poolInstance = GetThreadPoolInstance(info[1]);
+    if(poolInstance == 0)
+    {
+        return Nan::ThrowError("queueWork() - No thread pool exists to queue work");
+    }
+    if(poolInstance->isDraining)
+    {
+        return Nan::ThrowError("queueWork() - Thread pool is being destroyed");
     }
 
     // get object from argument
     Local<Value> v8Object = info[0];
-    THREAD_WORK_ITEM* workItem = Thread::BuildWorkItem(v8Object->ToObject());
+
+    // continuations are queued by the thread completing the previous unit of work
+    if(!Nan::Get(v8Object->ToObject(), Nan::New<String>("then").ToLocalChecked()).ToLocalChecked()->IsUndefined())
+    {
+        THREAD_WORK_GRAPH* workChain = Thread::BuildWorkChain(v8Object->ToObject(), poolInstance->timeoutMs, poolInstance->workGroup, poolInstance->threadPool);
+        if(workChain == NULL)
+        {
+            return Nan::ThrowError("queueWork() - Work item is malformed");
+        }
+
+        // report if the work was rejected because the queue is full
+        info.GetReturnValue().Set(Nan::New<Boolean>(Thread::QueueWorkGraph(workChain)));
+        return;
+    }
+
+    THREAD_WORK_ITEM* workItem = Thread::BuildWorkItem(v8Object->ToObject(), poolInstance->timeoutMs, poolInstance->workGroup);
 
     if(workItem == NULL)
     {
         return Nan::ThrowError("queueWork() - Work item is malformed");
     }
-    else
+
+    // queue the work
+    TASK_QUEUE_STATUS addStatus = Thread::QueueWorkItem(poolInstance->threadPool, workItem);
+    if(addStatus == TASK_QUEUE_STATUS_ADD_MALLOC_FAIL)
+    {
+        return Nan::ThrowError("queueWork() - Failed to allocate memory for work item");
+    }
+
+    // report if the work was rejected because the queue is full
+    info.GetReturnValue().Set(Nan::New<Boolean>(addStatus == TASK_QUEUE_STATUS_ADD_SUCCESS));
+}
+
+NAN_METHOD(Run)
+{
+    Nan::HandleScope();
+
+    // the options are optional, a pool handle is never an object
+    int poolArgument = ((info.Length() > 3) && info[3]->IsObject()) ? 4 : 3;
+
+    // validate input
+    if((info.Length() < 3) || (info.Length() > poolArgument + 1) ||
+        !info[0]->IsUint32() || !info[1]->IsString() || !info[2]->IsObject())
+    {
+        return Nan::ThrowError("run() - Expects 3-5 arguments: 1) file key (uint32) 2) work function (string) 3) work param (object) 4) options (object, optional) 5) thread pool (uint32 or string, optional)");
+    }
+
+#ifdef RESOLVER_TABLE_SUPPORTED
+    // ensure thread pool has already been created
+    THREAD_POOL_INSTANCE *poolInstance = GetThreadPoolInstance(info[poolArgument]);
+    if(poolInstance == 0)
+    {
+        return Nan::ThrowError("run() - No thread pool exists to queue work");
+    }
+    if(poolInstance->isDraining)
+    {
+        return Nan::ThrowError("run() - Thread pool is being destroyed");
+    }
+
+    // unit of work of the arguments and the options that apply to a promise
+    static const char* workOptions[] = { "workId", "priority", "timeoutMs", "tenant" };
+    Local<Object> v8Object = Nan::New<Object>();
+    Nan::Set(v8Object, Nan::New<String>("workId").ToLocalChecked(), Nan::New<Uint32>(0));
+    bool hasWorkId = false;
+    if(poolArgument == 4)
+    {
+        for(size_t i = 0; i < sizeof(workOptions) / sizeof(workOptions[0]); i++)
+        {
+            Local<String> optionName = Nan::New<String>(workOptions[i]).ToLocalChecked();
+            Local<Value> v8Option = Nan::Get(info[3]->ToObject(), optionName).ToLocalChecked();
+            if(!v8Option->IsUndefined())
+            {
+                if(!v8Option->IsUint32())
+                {
+                    return Nan::ThrowError("run() - Options are malformed");
+                }
+                Nan::Set(v8Object, optionName, v8Option);
+                if(strcmp(workOptions[i], "workId") == 0)
+                {
+                    hasWorkId = true;
+                }
+            }
+        }
+    }
+    Nan::Set(v8Object, Nan::New<String>("fileKey").ToLocalChecked(), info[0]);
+    Nan::Set(v8Object, Nan::New<String>("workFunction").ToLocalChecked(), info[1]);
+    Nan::Set(v8Object, Nan::New<String>("workParam").ToLocalChecked(), info[2]);
+
+    // only a unit of work given a workId can be cancelled, cancel(0) leaves the others alone
+    Local<Promise::Resolver> resolver;
+    THREAD_WORK_ITEM* workItem = Thread::BuildPromiseWorkItem(v8Object, poolInstance->timeoutMs, poolInstance->workGroup, &resolver, hasWorkId);
+    if(workItem == NULL)
+    {
+        return Nan::ThrowError("run() - Work item is malformed");
+    }
+
+    // queue the work
+    TASK_QUEUE_STATUS addStatus = Thread::QueueWorkItem(poolInstance->threadPool, workItem);
+    if(addStatus == TASK_QUEUE_STATUS_ADD_MALLOC_FAIL)
+    {
+        return Nan::ThrowError("run() - Failed to allocate memory for work item");
+    }
+
+    // the work was rejected because the queue is full
+    if(addStatus != TASK_QUEUE_STATUS_ADD_SUCCESS)
+    {
+        Local<Object> rejectObject = Nan::New<Object>();
+        Nan::Set(rejectObject, Nan::New<String>("message").ToLocalChecked(), Nan::New<String>("Work item was rejected by the task queue").ToLocalChecked());
+        Nan::Set(rejectObject, Nan::New<String>("rejected").ToLocalChecked(), Nan::True());
+        ResolverTable::Settle(resolver, rejectObject, true);
+    }
+
+    info.GetReturnValue().Set(resolver->GetPromise());
+#else
+    return Nan::ThrowError("run() - Promises are not supported by this version of Node.js");
+#endif
+}
+
+NAN_METHOD(QueueWorkBatch)
+{
+    Nan::HandleScope();
+
+    // validate input
+    if((info.Length() < 1) || (info.Length() > 2) || !info[0]->IsArray())
+    {
+        return Nan::ThrowError("queueWorkBatch() - Expects 1-2 arguments: 1) work items (array) 2) thread pool (uint32 or string, optional)");
+    }
+
+    // ensure thread pool has already been created
+    THREAD_POOL_INSTANCE *poolInstance = GetThreadPoolInstance(info[1]);
+    if(poolInstance == 0)
+    {
+        return Nan::ThrowError("queueWorkBatch() - No thread pool exists to queue work");
+    }
+    if(poolInstance->isDraining)
+    {
+        return Nan::ThrowError("queueWorkBatch() - Thread pool is being destroyed");
+    }
+
+    // build every work item before any of them is queued
+    Local<Array> v8WorkItems = info[0].As<Array>();
+    uint32_t numItems = v8WorkItems->Length();
+    std::vector<THREAD_WORK_ITEM*> workItems(numItems);
+    for(uint32_t i = 0; i < numItems; i++)
+    {
+        Local<Value> v8Object = Nan::Get(v8WorkItems, i).ToLocalChecked();
+
+        // continuations are only supported by queueWork
+        bool isChained = v8Object->IsObject() && !Nan::Get(v8Object->ToObject(), Nan::New<String>("then").ToLocalChecked()).ToLocalChecked()->IsUndefined();
+        workItems[i] = (v8Object->IsObject() && !isChained) ? Thread::BuildWorkItem(v8Object->ToObject(), poolInstance->timeoutMs, poolInstance->workGroup) : NULL;
+
+        if(workItems[i] == NULL)
+        {
+            for(uint32_t j = 0; j < i; j++)
+            {
+                Thread::ReleaseWorkItem(workItems[j]);
+            }
+            return Nan::ThrowError("queueWorkBatch() - Work item is malformed");
+        }
+    }
+
+    // queue the work
+    uint32_t numQueued = 0;
+    if(numItems > 0)
+    {
+        TASK_QUEUE_STATUS addStatus = Thread::QueueWorkItems(poolInstance->threadPool, &(workItems[0]), numItems, &numQueued);
+        if(addStatus == TASK_QUEUE_STATUS_ADD_MALLOC_FAIL)
+        {
+            return Nan::ThrowError("queueWorkBatch() - Failed to allocate memory for work items");
+        }
+    }
+
+    // report how many leading work items were queued before the queue was full
+    info.GetReturnValue().Set(Nan::New<Uint32>(numQueued));
+}
+
+NAN_METHOD(SubmitGraph)
+{
+    Nan::HandleScope();
+
+    // validate input
+    if((info.Length() < 1) || (info.Length() > 2) || !info[0]->IsObject())
+    {
+        return Nan::ThrowError("submitGraph() - Expects 1-2 arguments: 1) work graph (object) 2) thread pool (uint32 or string, optional)");
+    }
+
+    // ensure thread pool has already been created
+    THREAD_POOL_INSTANCE *poolInstance = GetThreadPoolInstance(info[1]);
+    if(poolInstance == 0)
+    {
+        return Nan::ThrowError("submitGraph() - No thread pool exists to queue work");
+    }
+    if(poolInstance->isDraining)
+    {
+        return Nan::ThrowError("submitGraph() - Thread pool is being destroyed");
+    }
+
+    // build a work item per node
+    THREAD_WORK_GRAPH* workGraph = Thread::BuildWorkGraph(info[0]->ToObject(), poolInstance->timeoutMs, poolInstance->workGroup, poolInstance->threadPool);
+    if(workGraph == NULL)
+    {
+        return Nan::ThrowError("submitGraph() - Work graph is malformed");
+    }
+
+    // report if the graph was rejected because the queue is full
+    info.GetReturnValue().Set(Nan::New<Boolean>(Thread::QueueWorkGraph(workGraph)));
+}
+
+NAN_METHOD(Cancel)
+{
+    Nan::HandleScope();
+
+    // validate input
+    if((info.Length() != 1) || !info[0]->IsUint32())
+    {
+        return Nan::ThrowError("cancel() - Expects 1 argument: 1) work id (uint32)");
+    }
+
+    // report if any queued or running work item was cancelled
+    uint32_t numCancelled = Thread::CancelWorkItems(info[0]->Uint32Value());
+    info.GetReturnValue().Set(Nan::New<Boolean>(numCancelled > 0));
+}
+
+NAN_METHOD(GetWarmModules)
+{
+    Nan::HandleScope();
+
+    // validate input
+    if(info.Length() > 1)
+    {
+        return Nan::ThrowError("getWarmModules() - Expects 0-1 arguments: 1) thread pool (uint32 or string, optional)");
+    }
+
+    // ensure thread pool has already been created
+    THREAD_POOL_INSTANCE *poolInstance = GetThreadPoolInstance(info[0]);
+    if(poolInstance == 0)
+    {
+        return Nan::ThrowError("getWarmModules() - No thread pool exists");
+    }
+
+    // one array of file keys per thread (empty unless the pool uses the affinity scheduler)
+    unsigned int fileKeys[THREAD_POOL_MAX_WARM_KEYS];
+    uint32_t numThreads = GetThreadPoolSize(poolInstance->threadPool);
+    Local<Array> v8Threads = Nan::New<Array>(numThreads);
+    for(uint32_t i = 0; i < numThreads; i++)
+    {
+        unsigned int numKeys = GetThreadPoolWarmKeys(poolInstance->threadPool, i, fileKeys, THREAD_POOL_MAX_WARM_KEYS);
+        Local<Array> v8FileKeys = Nan::New<Array>(numKeys);
+        for(unsigned int j = 0; j < numKeys; j++)
+        {
+            Nan::Set(v8FileKeys, j, Nan::New<Uint32>(fileKeys[j]));
+        }
+        Nan::Set(v8Threads, i, v8FileKeys);
+    }
+
+    info.GetReturnValue().Set(v8Threads);
+}
+
+NAN_METHOD(GetStats)
+{
+    Nan::HandleScope();
+
+    // validate input
+    if(info.Length() > 1)
+    {
+        return Nan::ThrowError("getStats() - Expects 0-1 arguments: 1) thread pool (uint32 or string, optional)");
+    }
+
+    // ensure thread pool has already been created
+    THREAD_POOL_INSTANCE *poolInstance = GetThreadPoolInstance(info[0]);
+    if(poolInstance == 0)
+    {
+        return Nan::ThrowError("getStats() - No thread pool exists");
+    }
+
+    // how far the delivery of callbacks on this thread is behind the threads
+    THREAD_WORK_GROUP *workGroup = poolInstance->workGroup;
+    Local<Object> v8Stats = Nan::New<Object>();
+    Nan::Set(v8Stats, Nan::New<String>("threads").ToLocalChecked(), Nan::New<Uint32>(GetThreadPoolSize(poolInstance->threadPool)));
+    Nan::Set(v8Stats, Nan::New<String>("pendingCallbacks").ToLocalChecked(), Nan::New<Number>((double)SyncAtomicLoad(&(workGroup->numAwaitingCallback))));
+    Nan::Set(v8Stats, Nan::New<String>("callbacks").ToLocalChecked(), Nan::New<Number>((double)workGroup->numCallbacks));
+    Nan::Set(v8Stats, Nan::New<String>("deferrals").ToLocalChecked(), Nan::New<Number>((double)workGroup->numDeferrals));
+    Nan::Set(v8Stats, Nan::New<String>("callbackLagMs").ToLocalChecked(), Nan::New<Number>(workGroup->lastCallbackLagUs / 1000.0));
+    Nan::Set(v8Stats, Nan::New<String>("maxCallbackLagMs").ToLocalChecked(), Nan::New<Number>(workGroup->maxCallbackLagUs / 1000.0));
+
+    info.GetReturnValue().Set(v8Stats);
+}
+
+NAN_METHOD(SetTenant)
+{
+    Nan::HandleScope();
+
+    // validate input
+    if((info.Length() < 2) || (info.Length() > 3) || !info[0]->IsUint32() || !info[1]->IsObject())
+    {
+        return Nan::ThrowError("setTenant() - Expects 2-3 arguments: 1) tenant (uint32) 2) options (object) 3) thread pool (uint32 or string, optional)");
+    }
+
+    // weight and concurrency limit, a zero weight would starve the tenant
+    uint32_t tenantWeight = TASK_QUEUE_DEFAULT_TENANT_WEIGHT, maxRunning = 0;
+    bool tenantWeightSet = false, maxRunningSet = false;
+    if(!GetUint32Option(info[1]->ToObject(), "weight", &tenantWeight, &tenantWeightSet) ||
+        !GetUint32Option(info[1]->ToObject(), "maxRunning", &maxRunning, &maxRunningSet) ||
+        (tenantWeight == 0))
+    {
+        return Nan::ThrowError("setTenant() - Options are malformed");
+    }
+
+    // ensure thread pool has already been created
+    THREAD_POOL_INSTANCE *poolInstance = GetThreadPoolInstance(info[2]);
+    if(poolInstance == 0)
+    {
+        return Nan::ThrowError("setTenant() - No thread pool exists");
+    }
+
+    if(SetTaskQueueTenant(poolInstance->taskQueue, info[0]->Uint32Value(), tenantWeight, maxRunning) != 0)
     {
-        // queue the work
-        Thread::QueueWorkItem(taskQueue, workItem);
+        return Nan::ThrowError("setTenant() - Thread pool was not created with queueType 'fair'");
     }
 
     info.GetReturnValue().SetUndefined();
@@ -230,10 +1163,18 @@ void Init(Handle<Object> exports)
 
     Nan::Export(exports, "createThreadPool",     CreateThreadPool);
     Nan::Export(exports, "destroyThreadPool",    DestoryThreadPool);
+    Nan::Export(exports, "resize",               Resize);
     Nan::Export(exports, "destroyIsolates",      DestroyIsolates);
     Nan::Export(exports, "loadFile",             LoadFile);
     Nan::Export(exports, "removeFile",           RemoveFile);
     Nan::Export(exports, "queueWork",            QueueWork);
+    Nan::Export(exports, "queueWorkBatch",       QueueWorkBatch);
+    Nan::Export(exports, "run",                  Run);
+    Nan::Export(exports, "submitGraph",          SubmitGraph);
+    Nan::Export(exports, "cancel",               Cancel);
+    Nan::Export(exports, "getWarmModules",       GetWarmModules);
+    Nan::Export(exports, "getStats",             GetStats);
+    Nan::Export(exports, "setTenant",            SetTenant);
 }
 
 NODE_MODULE(npool, Init)
@@ -4,61 +4,105 @@
 //#include <stdio.h>
 #include <stdlib.h>
 
-// public instance "constructor"
-CallbackQueue& CallbackQueue::GetInstance()
-{
-    // lazy instantiation of class instance
-    static CallbackQueue classInstance;
-
-    // return by reference
-    return classInstance;
-}
-
-// protected constructor
+// constructor
 CallbackQueue::CallbackQueue()
 {
-    // create queue
-    callbackQueue = new std::queue<THREAD_WORK_ITEM*>();
+    // create ring
+    ringItems = new THREAD_WORK_ITEM*[CALLBACK_QUEUE_RING_CAPACITY];
+    writePosition = 0;
+    readPosition = 0;
+
+    // create overflow list mutex
+    overflowLength = 0;
+    SyncCreateMutex(&(this->overflowMutex), 0);
 
-    // create file map mutex
-    SyncCreateMutex(&(this->queueMutex), 0);
+    pendingPosition = 0;
 }
 
 // destructor
 CallbackQueue::~CallbackQueue()
 {
-    SyncLockMutex(&(this->queueMutex));
-    delete this->callbackQueue;
-    SyncUnlockMutex(&(this->queueMutex));
-
-    SyncDestroyMutex(&(this->queueMutex));
+    delete[] this->ringItems;
+    SyncDestroyMutex(&(this->overflowMutex));
 }
 
 void CallbackQueue::AddWorkItem(THREAD_WORK_ITEM* workItem)
 {
-    SyncLockMutex(&(this->queueMutex));
+    // only this thread writes the position
+    long currentPosition = this->writePosition;
 
-    this->callbackQueue->push(workItem);
+    // publish the work item within the ring unless it is full or earlier work items overflowed
+    if((SyncAtomicLoad(&(this->overflowLength)) == 0) &&
+        ((unsigned long)(currentPosition - SyncAtomicLoad(&(this->readPosition))) < CALLBACK_QUEUE_RING_CAPACITY))
+    {
+        this->ringItems[(unsigned long)currentPosition & (CALLBACK_QUEUE_RING_CAPACITY - 1)] = workItem;
+        SyncAtomicStore(&(this->writePosition), currentPosition + 1);
+        return;
+    }
 
-    SyncUnlockMutex(&(this->queueMutex));
+    SyncLockMutex(&(this->overflowMutex));
+    this->overflowItems.push_back(workItem);
+    SyncAtomicStore(&(this->overflowLength), (long)this->overflowItems.size());
+    SyncUnlockMutex(&(this->overflowMutex));
 }
 
 THREAD_WORK_ITEM* CallbackQueue::GetWorkItem()
 {
     //fprintf(stdout, "CallbackQueue::GetWorkItem\n");
 
-    THREAD_WORK_ITEM* returnValue = 0;
+    // take the work items added since the previous ones were taken
+    if(this->pendingPosition == this->pendingItems.size())
+    {
+        this->pendingItems.clear();
+        this->pendingPosition = 0;
+        this->TakeWorkItems(this->pendingItems);
+    }
+
+    return (this->pendingPosition < this->pendingItems.size()) ? this->pendingItems[this->pendingPosition] : 0;
+}
 
-    SyncLockMutex(&(this->queueMutex));
+void CallbackQueue::PopWorkItem()
+{
+    this->pendingPosition++;
+}
 
-    if(!(this->callbackQueue->empty()))
-    {
-        returnValue = this->callbackQueue->front();
+void CallbackQueue::TakeWorkItems(std::vector<THREAD_WORK_ITEM*> &workItems)
+{
+    // only this thread writes the position
+    long currentPosition = this->readPosition;
+    long lastPosition = 0;
 
-        this->callbackQueue->pop();
+    for(;;)
+    {
+        // take every work item within the ring and free their slots at once
+        lastPosition = SyncAtomicLoad(&(this->writePosition));
+        while(currentPosition != lastPosition)
+        {
+            workItems.push_back(this->ringItems[(unsigned long)currentPosition & (CALLBACK_QUEUE_RING_CAPACITY - 1)]);
+            currentPosition++;
+        }
+        SyncAtomicStore(&(this->readPosition), currentPosition);
+
+        // the overflowed work items follow those of the ring (the thread does not add to the ring while they remain)
+        if(SyncAtomicLoad(&(this->overflowLength)) == 0)
+        {
+            return;
+        }
+
+        // unless the thread added to the ring after it was read and before it overflowed, those work items
+        // precede the overflowed ones and the ring is taken again (it no longer changes)
+        if(SyncAtomicLoad(&(this->writePosition)) == lastPosition)
+        {
+            break;
+        }
     }
 
-    SyncUnlockMutex(&(this->queueMutex));
+    SyncLockMutex(&(this->overflowMutex));
+
+    // work items the thread adds to the ring once the list is cleared are left for the next call
+    workItems.insert(workItems.end(), this->overflowItems.begin(), this->overflowItems.end());
+    this->overflowItems.clear();
+    SyncAtomicStore(&(this->overflowLength), 0);
 
-    return returnValue;
+    SyncUnlockMutex(&(this->overflowMutex));
 }
@@ -2,41 +2,74 @@
 #define _CALLBACK_QUEUE_H_
 
 // C++
-#include <queue>
+#include <vector>
 
 // custom source
 #include "thread.h"
 #include "synchronize.h"
 
+// number of work items the ring of a callback queue holds (power of 2), further work items
+// overflow to a mutex guarded list until the node thread drains the queue
+#define CALLBACK_QUEUE_RING_CAPACITY    1024
+
+// completed work items of a single thread awaiting their callback on the node thread
+// lock-free single-producer/single-consumer ring, the thread adds and the node thread drains
 class CallbackQueue
 {
     public:
 
-        // singleton instance of class
-        static CallbackQueue&   GetInstance();
+        // constructor
+        CallbackQueue();
 
         // destructor
         virtual                 ~CallbackQueue();
 
-        // load work item into queue
+        // load work item into queue (only called by the thread owning the queue)
         void                    AddWorkItem(THREAD_WORK_ITEM* workItem);
 
-        // get work item from queue and remove it
+        // next work item awaiting its callback, without removing it (0 if there is none)
+        // the work items within the ring are taken at once when the previously taken ones are exhausted
+        // (only called by the node thread, as is PopWorkItem)
         THREAD_WORK_ITEM*       GetWorkItem();
 
-    protected:
+        // removes the work item GetWorkItem returned
+        void                    PopWorkItem();
 
-        // ensure default constructor can't get called
-        CallbackQueue();
+    private:
 
         // declare private copy constructor methods to ensure they can't be called
         CallbackQueue(CallbackQueue const&);
         void operator=(CallbackQueue const&);
 
-    private:
+        // appends every work item within the queue to workItems in the order they were added and removes them
+        void                    TakeWorkItems(std::vector<THREAD_WORK_ITEM*> &workItems);
+
+        char                            queuePadding0[SYNC_CACHE_LINE_SIZE];
+
+        // ring of work items (read-only after creation)
+        THREAD_WORK_ITEM**              ringItems;
+
+        char                            queuePadding1[SYNC_CACHE_LINE_SIZE];
+
+        // position of the next work item to be written, only written by the owning thread
+        THREAD_ATOMIC                   writePosition;
+
+        char                            queuePadding2[SYNC_CACHE_LINE_SIZE];
+
+        // position of the next work item to be read, only written by the node thread
+        THREAD_ATOMIC                   readPosition;
+
+        char                            queuePadding3[SYNC_CACHE_LINE_SIZE];
+
+        // work items added while the ring was full, the owning thread keeps adding to the list
+        // until it is drained so work items are delivered in the order they were added
+        std::vector<THREAD_WORK_ITEM*>  overflowItems;
+        THREAD_ATOMIC                   overflowLength;
+        THREAD_MUTEX                    overflowMutex;
 
-        std::queue<THREAD_WORK_ITEM*>    *callbackQueue;
-        THREAD_MUTEX                queueMutex;
+        // work items taken by the node thread that await their callback, from pendingPosition on
+        std::vector<THREAD_WORK_ITEM*>  pendingItems;
+        size_t                          pendingPosition;
 };
 
 #endif /* _CALLBACK_QUEUE_H_ */
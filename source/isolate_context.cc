@@ -111,6 +111,12 @@ void IsolateContext::CloneGlobalContextObject(Local<Object> sourceObject, Local<
         Nan::Get(
             sourceObject,
             Nan::New<String>("console").ToLocalChecked()).ToLocalChecked());
+    Nan::Set(
+        cloneObject,
+        Nan::New<String>("emit").ToLocalChecked(),
+        Nan::Get(
+            sourceObject,
+            Nan::New<String>("emit").ToLocalChecked()).ToLocalChecked());
 }
 
 void IsolateContext::CreateModuleContext(Local<Object> contextObject, const FILE_INFO* fileInfo)
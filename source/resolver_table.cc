@@ -0,0 +1,90 @@
+#include "resolver_table.h"
+
+#ifdef RESOLVER_TABLE_SUPPORTED
+
+// public instance "constructor"
+ResolverTable& ResolverTable::GetInstance()
+{
+    // lazy instantiation of class instance
+    static ResolverTable classInstance;
+
+    // return by reference
+    return classInstance;
+}
+
+// protected constructor
+ResolverTable::ResolverTable()
+{
+}
+
+// destructor
+ResolverTable::~ResolverTable()
+{
+    for(size_t i = 0; i < this->resolverChunks.size(); i++)
+    {
+        delete[] this->resolverChunks[i];
+    }
+}
+
+uint32_t ResolverTable::CreateResolver(Local<Promise::Resolver> *resolver)
+{
+    // add a chunk of slots once every slot is in use
+    if(this->freeSlots.empty())
+    {
+        uint32_t firstSlot = (uint32_t)(this->resolverChunks.size() * RESOLVER_TABLE_CHUNK_SIZE);
+        this->resolverChunks.push_back(new Nan::Persistent<Promise::Resolver>[RESOLVER_TABLE_CHUNK_SIZE]);
+        for(uint32_t i = RESOLVER_TABLE_CHUNK_SIZE; i > 0; i--)
+        {
+            this->freeSlots.push_back(firstSlot + i - 1);
+        }
+    }
+
+    #if NODE_MAJOR_VERSION >= 8
+        *resolver = Promise::Resolver::New(Nan::GetCurrentContext()).ToLocalChecked();
+    #else
+        *resolver = Promise::Resolver::New(Isolate::GetCurrent());
+    #endif
+
+    // most recently freed slot first
+    uint32_t resolverSlot = this->freeSlots.back();
+    this->freeSlots.pop_back();
+    this->resolverChunks[resolverSlot / RESOLVER_TABLE_CHUNK_SIZE][resolverSlot % RESOLVER_TABLE_CHUNK_SIZE].Reset(*resolver);
+
+    return resolverSlot;
+}
+
+Local<Promise::Resolver> ResolverTable::GetResolver(uint32_t resolverSlot)
+{
+    return Nan::New<Promise::Resolver>(this->resolverChunks[resolverSlot / RESOLVER_TABLE_CHUNK_SIZE][resolverSlot % RESOLVER_TABLE_CHUNK_SIZE]);
+}
+
+void ResolverTable::ReleaseResolver(uint32_t resolverSlot)
+{
+    this->resolverChunks[resolverSlot / RESOLVER_TABLE_CHUNK_SIZE][resolverSlot % RESOLVER_TABLE_CHUNK_SIZE].Reset();
+    this->freeSlots.push_back(resolverSlot);
+}
+
+void ResolverTable::Settle(Local<Promise::Resolver> resolver, Local<Value> settledValue, bool isRejected)
+{
+    #if NODE_MAJOR_VERSION >= 8
+        if(isRejected)
+        {
+            resolver->Reject(Nan::GetCurrentContext(), settledValue).FromJust();
+        }
+        else
+        {
+            resolver->Resolve(Nan::GetCurrentContext(), settledValue).FromJust();
+        }
+    #else
+        if(isRejected)
+        {
+            resolver->Reject(settledValue);
+        }
+        else
+        {
+            resolver->Resolve(settledValue);
+        }
+    #endif
+}
+
+#endif /* RESOLVER_TABLE_SUPPORTED */
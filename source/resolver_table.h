@@ -0,0 +1,65 @@
+#ifndef _RESOLVER_TABLE_H_
+#define _RESOLVER_TABLE_H_
+
+// C++
+#include <vector>
+
+// node
+#include <node.h>
+#include <v8.h>
+using namespace v8;
+
+#include <nan.h>
+
+// promises are created natively from node version 4 on
+#if NODE_MAJOR_VERSION >= 4
+#define RESOLVER_TABLE_SUPPORTED    1
+#endif
+
+// number of resolvers allocated at once, slots are reused once their promise settles
+#define RESOLVER_TABLE_CHUNK_SIZE   256
+
+#ifdef RESOLVER_TABLE_SUPPORTED
+
+// resolvers of the promises returned by run(), indexed by slot (only used by the node thread)
+class ResolverTable
+{
+    public:
+
+        // singleton instance of class
+        static ResolverTable&       GetInstance();
+
+        // destructor
+        virtual                     ~ResolverTable();
+
+        // creates a resolver within a free slot and returns the slot
+        uint32_t                    CreateResolver(Local<Promise::Resolver> *resolver);
+
+        // resolver within the slot
+        Local<Promise::Resolver>    GetResolver(uint32_t resolverSlot);
+
+        // frees the slot, a promise that was not settled stays pending
+        void                        ReleaseResolver(uint32_t resolverSlot);
+
+        // resolves the promise of the resolver, or rejects it
+        static void                 Settle(Local<Promise::Resolver> resolver, Local<Value> settledValue, bool isRejected);
+
+    protected:
+
+        // ensure default constructor can't get called
+        ResolverTable();
+
+        // declare private copy constructor methods to ensure they can't be called
+        ResolverTable(ResolverTable const&);
+        void operator=(ResolverTable const&);
+
+    private:
+
+        // chunks of RESOLVER_TABLE_CHUNK_SIZE slots and the slots that are free
+        std::vector<Nan::Persistent<Promise::Resolver>*>    resolverChunks;
+        std::vector<uint32_t>                               freeSlots;
+};
+
+#endif /* RESOLVER_TABLE_SUPPORTED */
+
+#endif /* _RESOLVER_TABLE_H_ */
@@ -12,17 +12,57 @@
 #include "callback_queue.h"
 #include "isolate_context.h"
 
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
+#include <vector>
 #include "array_buffer_allocator.h"
 
 // file loader and hash (npool.cc)
 static FileManager *fileManager = &(FileManager::GetInstance());
 
-// callback queue
-static CallbackQueue *callbackQueue = &(CallbackQueue::GetInstance());
+#ifdef RESOLVER_TABLE_SUPPORTED
+// resolvers of the work items queued by run() and the function settling them
+static ResolverTable *resolverTable = &(ResolverTable::GetInstance());
+static Nan::Callback *settleCallback = 0;
+#endif
+
 static std::mutex removedIsolatesMutex;
 static std::vector<Isolate*> removedIsolates;
 
+// watchers of retired threads, the node thread delivers their remaining work items before it closes them
+// (a retiring thread signals retireAsync, never its own watcher, once it added its last work item)
+static std::mutex retiredWatchersMutex;
+static std::vector<uv_async_t*> retiredWatchers;
+static uv_async_t* retireAsync = 0;
+
+// iterations of the event loop, counted before its watchers are polled (the handle does not keep the event loop alive)
+static uv_prepare_t* loopPrepare = 0;
+static uint64_t loopIteration = 0;
+
+// work items cancelled before a thread took them are delivered by a watcher of the node thread
+// (it only keeps the event loop alive while it has work items to deliver)
+static CallbackQueue* cancelQueue = 0;
+static uv_async_t* cancelAsync = 0;
+
+// work items are recycled through a pool
+static MEMORY_POOL *workItemPool = GetMemoryPool(sizeof(THREAD_WORK_ITEM));
+
+// work items that can be cancelled, the mutex also orders terminating a running work item
+// against the thread clearing the termination once the work item completes
+static std::mutex workIndexMutex;
+static ThreadWorkIndex workIndex;
+
+// running work items with a timeout, the watchdog thread terminates them once they are overdue
+// (the watchdog takes workIndexMutex while it holds watchdogMutex, never the reverse)
+// they are never destroyed, a watchdog still waiting at exit would block the destructor of the conditional
+static std::mutex *watchdogMutex = new std::mutex();
+static std::condition_variable *watchdogCond = new std::condition_variable();
+static ThreadDeadlineMap *deadlineMap = new ThreadDeadlineMap();
+static bool watchdogStarted = false;
+static bool watchdogTerminate = false;
+static THREAD watchdogThread;
+
 // array buffer allocator
 // node version 4 requires array buffer allocator for isolates
 #if NODE_MAJOR_VERSION == 4
@@ -35,21 +75,45 @@ void* Thread::ThreadInit()
     THREAD_CONTEXT* threadContext = (THREAD_CONTEXT*)malloc(sizeof(THREAD_CONTEXT));
     memset(threadContext, 0, sizeof(THREAD_CONTEXT));
 
+    // create the watcher retiring threads signal (it does not keep the event loop alive)
+    if(retireAsync == 0)
+    {
+        retireAsync = (uv_async_t*)malloc(sizeof(uv_async_t));
+        memset(retireAsync, 0, sizeof(uv_async_t));
+        uv_async_init(uv_default_loop(), retireAsync, Thread::uvRetireCallback);
+        uv_unref((uv_handle_t*)retireAsync);
+    }
+
+    // count the iterations of the event loop the callback budgets are reset by
+    if(loopPrepare == 0)
+    {
+        loopPrepare = (uv_prepare_t*)malloc(sizeof(uv_prepare_t));
+        memset(loopPrepare, 0, sizeof(uv_prepare_t));
+        uv_prepare_init(uv_default_loop(), loopPrepare);
+        uv_prepare_start(loopPrepare, Thread::uvPrepareCallback);
+        uv_unref((uv_handle_t*)loopPrepare);
+    }
+
+    // create the watcher delivering the work items cancelled while queued
+    if(cancelAsync == 0)
+    {
+        cancelQueue = new CallbackQueue();
+        cancelAsync = (uv_async_t*)malloc(sizeof(uv_async_t));
+        memset(cancelAsync, 0, sizeof(uv_async_t));
+        uv_async_init(uv_default_loop(), cancelAsync, Thread::uvCancelCallback);
+        cancelAsync->data = cancelQueue;
+        uv_unref((uv_handle_t*)cancelAsync);
+    }
+
     // create and initialize async watcher
     threadContext->uvAsync = (uv_async_t*)malloc(sizeof(uv_async_t));
     memset(threadContext->uvAsync, 0, sizeof(uv_async_t));
     uv_async_init(uv_default_loop(), threadContext->uvAsync, Thread::uvAsyncCallback);
     threadContext->uvAsync->close_cb = Thread::uvCloseCallback;
 
-    // create thread isolate
-    // node version 4 requires array buffer allocator for isolates
-    #if NODE_MAJOR_VERSION == 4
-        Isolate::CreateParams create_params;
-        create_params.array_buffer_allocator = &arrayBufferAllocator;
-        threadContext->threadIsolate = Isolate::New(create_params);
-    #else
-        threadContext->threadIsolate = Isolate::New();
-    #endif
+    // create the queue of completed work items the watcher drains
+    threadContext->callbackQueue = new CallbackQueue();
+    threadContext->uvAsync->data = threadContext->callbackQueue;
 
     // create module map
     threadContext->moduleMap = new ThreadModuleMap();
@@ -62,6 +126,17 @@ void Thread::ThreadPostInit(void* threadContext)
     // thread context
     THREAD_CONTEXT* thisContext = (THREAD_CONTEXT*)threadContext;
 
+    // create thread isolate on the worker thread, so its heap is first touched by the
+    // processor the thread is bound to (NUMA local)
+    // node version 4 requires array buffer allocator for isolates
+    #if NODE_MAJOR_VERSION == 4
+        Isolate::CreateParams create_params;
+        create_params.array_buffer_allocator = &arrayBufferAllocator;
+        thisContext->threadIsolate = Isolate::New(create_params);
+    #else
+        thisContext->threadIsolate = Isolate::New();
+    #endif
+
     // get reference to thread isolate
     Isolate* isolate = thisContext->threadIsolate;
     {
@@ -71,6 +146,9 @@ void Thread::ThreadPostInit(void* threadContext)
         // enter the isolate
         isolate->Enter();
 
+        // limit the js stack to the thread's stack
+        Thread::SetStackLimit(isolate);
+
         // create a stack-allocated handle-scope
         Nan::HandleScope scope;
 
@@ -88,6 +166,11 @@ void Thread::ThreadPostInit(void* threadContext)
         // create module context
         IsolateContext::CreateModuleContext(globalContext, NULL);
 
+        // emit(partial) adds a partial result of the work item executing on this thread
+        Local<Function> emitFunction = Nan::GetFunction(Nan::New<FunctionTemplate>(Thread::EmitProgress, Nan::New<External>(threadContext))).ToLocalChecked();
+        emitFunction->SetName(Nan::New<String>("emit").ToLocalChecked());
+        Nan::Set(globalContext, Nan::New<String>("emit").ToLocalChecked(), emitFunction);
+
         // exit thread specific context
         isolateContext->Exit();
     }
@@ -96,6 +179,32 @@ void Thread::ThreadPostInit(void* threadContext)
     isolate->Exit();
 }
 
+void Thread::SetStackLimit(Isolate* isolate)
+{
+    // size of the thread's stack (unknown on some platforms)
+    size_t stackSize = SyncGetThreadStackSize();
+    if(stackSize <= 2 * THREAD_STACK_GUARD_SIZE)
+    {
+        return;
+    }
+
+    // the stack grows down from about here, keep a guard for native frames below the limit
+    char stackPosition = 0;
+    uintptr_t stackLimit = (uintptr_t)&stackPosition - (stackSize - THREAD_STACK_GUARD_SIZE);
+
+    #if NODE_MAJOR_VERSION >= 4
+        isolate->SetStackLimit(stackLimit);
+    #elif NODE_VERSION_AT_LEAST(0, 11, 13)
+        ResourceConstraints resourceConstraints;
+        resourceConstraints.set_stack_limit((uint32_t*)stackLimit);
+        SetResourceConstraints(isolate, &resourceConstraints);
+    #else
+        ResourceConstraints resourceConstraints;
+        resourceConstraints.set_stack_limit((uint32_t*)stackLimit);
+        SetResourceConstraints(&resourceConstraints);
+    #endif
+}
+
 void Thread::ThreadDestroy(void* threadContext)
 {
     //fprintf(stdout, "[%u] Thread::ThreadDestroy\n", SyncGetThreadId());
@@ -139,13 +248,54 @@ void Thread::ThreadDestroy(void* threadContext)
     // release the module map
     delete thisContext->moduleMap;
 
-    //uv_unref((uv_handle_t*)thisContext->uvAsync);
-    uv_close((uv_handle_t*)thisContext->uvAsync, ((uv_async_t*)thisContext->uvAsync)->close_cb);
+    // the node thread closes the async watcher and its queue (threads may retire while the event loop runs),
+    // the watcher may be closed as soon as it is listed so it is not signalled after
+    {
+        std::lock_guard<std::mutex> lock(retiredWatchersMutex);
+        retiredWatchers.push_back(thisContext->uvAsync);
+    }
+    uv_async_send(retireAsync);
 
     // release the thread context memory
     free(threadContext);
 }
 
+void Thread::ThreadBatchEnter(void* threadContext)
+{
+    // thread context
+    THREAD_CONTEXT* thisContext = (THREAD_CONTEXT*)threadContext;
+
+    // get reference to thread isolate
+    Isolate* isolate = thisContext->threadIsolate;
+
+    // lock and enter the isolate for the whole batch
+    thisContext->batchLocker = new Locker(isolate);
+    isolate->Enter();
+
+    // enter thread specific context (it stays entered after the handle scope closes)
+    Nan::HandleScope scope;
+    Nan::New<Context>(*(thisContext->threadJSContext))->Enter();
+}
+
+void Thread::ThreadBatchExit(void* threadContext)
+{
+    // thread context
+    THREAD_CONTEXT* thisContext = (THREAD_CONTEXT*)threadContext;
+
+    // get reference to thread isolate
+    Isolate* isolate = thisContext->threadIsolate;
+    {
+        // exit thread specific context
+        Nan::HandleScope scope;
+        Nan::New<Context>(*(thisContext->threadJSContext))->Exit();
+    }
+
+    // leave and unlock the isolate
+    isolate->Exit();
+    delete thisContext->batchLocker;
+    thisContext->batchLocker = 0;
+}
+
 void Thread::DestroyIsolates()
 {
     std::lock_guard<std::mutex> lock(removedIsolatesMutex);
@@ -154,7 +304,24 @@ void Thread::DestroyIsolates()
     removedIsolates.clear();
 }
 
-THREAD_WORK_ITEM* Thread::BuildWorkItem(Local<Object> v8Object)
+THREAD_WORK_ITEM* Thread::BuildWorkItem(Local<Object> v8Object, uint32_t defaultTimeout, THREAD_WORK_GROUP *workGroup)
+{
+    return Thread::CreateWorkItem(v8Object, defaultTimeout, workGroup, true, true);
+}
+
+#ifdef RESOLVER_TABLE_SUPPORTED
+THREAD_WORK_ITEM* Thread::BuildPromiseWorkItem(Local<Object> v8Object, uint32_t defaultTimeout, THREAD_WORK_GROUP *workGroup, Local<Promise::Resolver> *resolver, bool isCancellable)
+{
+    THREAD_WORK_ITEM *workItem = Thread::CreateWorkItem(v8Object, defaultTimeout, workGroup, false, isCancellable);
+    if(workItem != NULL)
+    {
+        workItem->resolverSlot = resolverTable->CreateResolver(resolver);
+    }
+    return workItem;
+}
+#endif
+
+THREAD_WORK_ITEM* Thread::CreateWorkItem(Local<Object> v8Object, uint32_t defaultTimeout, THREAD_WORK_GROUP *workGroup, bool hasCallback, bool isCancellable)
 {
     // work item to be returned
     THREAD_WORK_ITEM *workItem = NULL;
@@ -175,25 +342,88 @@ THREAD_WORK_ITEM* Thread::BuildWorkItem(Local<Object> v8Object)
     propertyName = Nan::New<String>("workParam").ToLocalChecked();
     Nan::MaybeLocal<Object> workParam = Nan::To<Object>(Nan::Get(v8Object, propertyName).ToLocalChecked());
 
-    propertyName = Nan::New<String>("callbackContext").ToLocalChecked();
-    Nan::MaybeLocal<Object> callbackContext = Nan::To<Object>(Nan::Get(v8Object, propertyName).ToLocalChecked());
+    Nan::MaybeLocal<Object> callbackContext;
+    Nan::MaybeLocal<Value> callbackFunction;
+    if(hasCallback)
+    {
+        propertyName = Nan::New<String>("callbackContext").ToLocalChecked();
+        callbackContext = Nan::To<Object>(Nan::Get(v8Object, propertyName).ToLocalChecked());
+
+        propertyName = Nan::New<String>("callbackFunction").ToLocalChecked();
+        callbackFunction = Nan::Get(v8Object, propertyName);
+    }
+
+    // optional properties
+    propertyName = Nan::New<String>("priority").ToLocalChecked();
+    Local<Value> priority = Nan::Get(v8Object, propertyName).ToLocalChecked();
+    if(!priority->IsUndefined() && !priority->IsUint32())
+    {
+        return NULL;
+    }
+
+    propertyName = Nan::New<String>("timeoutMs").ToLocalChecked();
+    Local<Value> timeoutMs = Nan::Get(v8Object, propertyName).ToLocalChecked();
+    if(!timeoutMs->IsUndefined() && !timeoutMs->IsUint32())
+    {
+        return NULL;
+    }
+
+    propertyName = Nan::New<String>("tenant").ToLocalChecked();
+    Local<Value> tenant = Nan::Get(v8Object, propertyName).ToLocalChecked();
+    if(!tenant->IsUndefined() && !tenant->IsUint32())
+    {
+        return NULL;
+    }
+
+    Local<Value> progressFunction = Nan::Undefined();
+    Local<Value> progressBufferSize = Nan::Undefined();
+    if(hasCallback)
+    {
+        propertyName = Nan::New<String>("progressFunction").ToLocalChecked();
+        progressFunction = Nan::Get(v8Object, propertyName).ToLocalChecked();
+        if(!progressFunction->IsUndefined() && !progressFunction->IsFunction())
+        {
+            return NULL;
+        }
+
+        propertyName = Nan::New<String>("progressBufferSize").ToLocalChecked();
+        progressBufferSize = Nan::Get(v8Object, propertyName).ToLocalChecked();
+        if(!progressBufferSize->IsUndefined() && (!progressBufferSize->IsUint32() || (progressBufferSize->Uint32Value() == 0)))
+        {
+            return NULL;
+        }
+    }
+
+    propertyName = Nan::New<String>("delayMs").ToLocalChecked();
+    Local<Value> delayMs = Nan::Get(v8Object, propertyName).ToLocalChecked();
+    if(!delayMs->IsUndefined() && !delayMs->IsUint32())
+    {
+        return NULL;
+    }
 
-    propertyName = Nan::New<String>("callbackFunction").ToLocalChecked();
-    Nan::MaybeLocal<Value> callbackFunction = Nan::Get(v8Object, propertyName);
+    propertyName = Nan::New<String>("intervalMs").ToLocalChecked();
+    Local<Value> intervalMs = Nan::Get(v8Object, propertyName).ToLocalChecked();
+    if(!intervalMs->IsUndefined() && !intervalMs->IsUint32())
+    {
+        return NULL;
+    }
 
     // determine if the object is valid
     bool isInvalidWorkObject = (workId.IsEmpty() ||
                                 fileKey.IsEmpty() ||
                                 workFunction.IsEmpty() ||
                                 workParam.IsEmpty() ||
-                                callbackContext.IsEmpty() ||
-                                callbackFunction.IsEmpty());
+                                (hasCallback && (callbackContext.IsEmpty() || callbackFunction.IsEmpty())));
 
     // ensure there weren't any exceptions and properties were valid
     if((isInvalidWorkObject == false) || !(tryCatch.HasCaught()))
     {
         // return value
-        workItem = (THREAD_WORK_ITEM*)malloc(sizeof(THREAD_WORK_ITEM));
+        workItem = (THREAD_WORK_ITEM*)AllocMemoryPoolBlock(workItemPool);
+        if(workItem == NULL)
+        {
+            return NULL;
+        }
         memset(workItem, 0, sizeof(THREAD_WORK_ITEM));
 
         // workId
@@ -202,40 +432,90 @@ THREAD_WORK_ITEM* Thread::BuildWorkItem(Local<Object> v8Object)
         // fileKey
         workItem->fileKey = fileKey.ToLocalChecked()->Value();
 
-        // workFunction
-        workItem->workFunction = Utilities::CreateCharBuffer(workFunction.ToLocalChecked());
+        // workFunction (short names avoid a heap allocation)
+        Nan::Utf8String workFunctionValue(workFunction.ToLocalChecked());
+        if(workFunctionValue.length() < THREAD_WORK_FUNCTION_BUFFER_SIZE)
+        {
+            memcpy(workItem->workFunctionBuffer, *workFunctionValue, workFunctionValue.length());
+            workItem->workFunctionBuffer[workFunctionValue.length()] = '\0';
+            workItem->workFunction = workItem->workFunctionBuffer;
+        }
+        else
+        {
+            workItem->workFunction = Utilities::CreateCharBuffer(workFunction.ToLocalChecked());
+        }
 
         // generate JSON c str of param object
         workItem->workParam = createDataFromValue(workParam.ToLocalChecked());
 
-        // callback context
-        workItem->callbackContext = new Nan::Persistent<Object>(callbackContext.ToLocalChecked());
+        // priority
+        workItem->priority = priority->IsUndefined() ? TASK_QUEUE_DEFAULT_PRIORITY : priority->Uint32Value();
+
+        // timeout, the pool's default applies when none is given
+        workItem->timeoutMs = timeoutMs->IsUndefined() ? defaultTimeout : timeoutMs->Uint32Value();
+
+        // tenant, work items of the same module share a tenant unless one is given
+        workItem->tenant = tenant->IsUndefined() ? workItem->fileKey : tenant->Uint32Value();
+
+        // periodic work items first run after one interval unless a delay is given
+        workItem->intervalMs = intervalMs->IsUndefined() ? 0 : intervalMs->Uint32Value();
+        workItem->delayMs = delayMs->IsUndefined() ? workItem->intervalMs : delayMs->Uint32Value();
+
+        // callback context and function (the caller creates the resolver of a work item without them)
+        if(hasCallback)
+        {
+            workItem->callbackContext = new Nan::Persistent<Object>(callbackContext.ToLocalChecked());
+            workItem->callbackFunction = new Nan::Callback(callbackFunction.ToLocalChecked().As<Function>());
+        }
+
+        // partial results are delivered to the progress function ahead of the callback
+        if(progressFunction->IsFunction())
+        {
+            workItem->workProgress = new THREAD_WORK_PROGRESS();
+            workItem->workProgress->progressFunction = new Nan::Callback(progressFunction.As<Function>());
+            workItem->workProgress->maxChunks = progressBufferSize->IsUndefined() ? THREAD_PROGRESS_DEFAULT_BUFFER_SIZE : progressBufferSize->Uint32Value();
+            workItem->workProgress->isNotified = false;
+            workItem->workProgress->numNotifications = 0;
+        }
 
-        // callback function
-        workItem->callbackFunction = new Nan::Callback(callbackFunction.ToLocalChecked().As<Function>());
+        // count the work item until it is delivered
+        workItem->workGroup = workGroup;
+        SyncAtomicIncrement(&(workGroup->numWorkItems));
+
+        // index the work item so it can be cancelled
+        if(isCancellable)
+        {
+            std::lock_guard<std::mutex> lock(workIndexMutex);
+            workItem->indexEntry = workIndex.insert(std::make_pair(workItem->workId, workItem));
+            workItem->isIndexed = true;
+        }
 
         // register external memory
-        int bytesAlloc = /*(workItem->workParam->length() + 1)*/ + strlen(workItem->workFunction);
-        Nan::AdjustExternalMemory(bytesAlloc);
+        if(workItem->workFunction != workItem->workFunctionBuffer)
+        {
+            int bytesAlloc = /*(workItem->workParam->length() + 1)*/ + strlen(workItem->workFunction);
+            Nan::AdjustExternalMemory(bytesAlloc);
+        }
     }
 
     return workItem;
 }
 
-void Thread::QueueWorkItem(TASK_QUEUE_DATA *taskQueue, THREAD_WORK_ITEM *workItem)
+TASK_QUEUE_ITEM* Thread::CreateWorkTaskItem(THREAD_WORK_ITEM *workItem)
 {
-    // reference to task queue item to be added
-    TASK_QUEUE_ITEM     *taskQueueItem = 0;
-
     // create task queue item object
-    taskQueueItem = (TASK_QUEUE_ITEM*)malloc(sizeof(TASK_QUEUE_ITEM));
-    memset(taskQueueItem, 0, sizeof(TASK_QUEUE_ITEM));
+    TASK_QUEUE_ITEM *taskQueueItem = CreateTaskQueueItem();
+    if(taskQueueItem == 0)
+    {
+        return 0;
+    }
 
     // set the data size
     taskQueueItem->dataSize = sizeof(THREAD_WORK_ITEM);
 
-    // store reference to work item
+    // store reference to work item and how to release it if the item is never executed
     taskQueueItem->taskItemData = (void*)workItem;
+    taskQueueItem->taskItemRelease = (workItem->workGraph != 0) ? Thread::ReleaseGraphNode : Thread::ReleaseWorkItem;
 
     // set the task item work function
     taskQueueItem->taskItemFunction = Thread::WorkItemFunction;
@@ -243,11 +523,105 @@ void Thread::QueueWorkItem(TASK_QUEUE_DATA *taskQueue, THREAD_WORK_ITEM *workIte
     // set the task item callback function
     taskQueueItem->taskItemCallback = Thread::WorkItemCallback;
 
-    // set the task item id
+    // set the task item id and priority
     taskQueueItem->taskId = workItem->workId;
+    taskQueueItem->taskPriority = workItem->priority;
+
+    // work items using the same module are routed to threads that already compiled it
+    taskQueueItem->taskAffinityKey = workItem->fileKey;
+    taskQueueItem->taskHasAffinity = 1;
+
+    // fair queues share threads between tenants by weight
+    taskQueueItem->taskTenant = workItem->tenant;
+
+    return taskQueueItem;
+}
 
-    // add the task to the queue
-    AddTaskToQueue(taskQueue, taskQueueItem);
+TASK_QUEUE_STATUS Thread::QueueWorkItem(THREAD_POOL_DATA *threadPool, THREAD_WORK_ITEM *workItem)
+{
+    // reference to task queue item to be added
+    TASK_QUEUE_ITEM     *taskQueueItem = 0;
+
+    // status of adding the item to the queue
+    TASK_QUEUE_STATUS   addStatus = TASK_QUEUE_STATUS_ADD_SUCCESS;
+
+    // create task queue item object
+    taskQueueItem = Thread::CreateWorkTaskItem(workItem);
+    if(taskQueueItem == 0)
+    {
+        Thread::DisposeWorkItem(workItem, true);
+        return TASK_QUEUE_STATUS_ADD_MALLOC_FAIL;
+    }
+
+    // delayed and periodic work items are queued by the pool's timer wheel once they are due
+    workItem->threadPool = threadPool;
+    if((workItem->delayMs > 0) || (workItem->intervalMs > 0))
+    {
+        workItem->dueTime = SyncGetTime() + workItem->delayMs;
+        addStatus = AddDelayedTaskToThreadPool(threadPool, taskQueueItem, workItem->delayMs);
+    }
+    // add the task to the thread pool
+    else
+    {
+        addStatus = AddTaskToThreadPool(threadPool, taskQueueItem);
+    }
+
+    // the queue did not take ownership of the item
+    if(addStatus != TASK_QUEUE_STATUS_ADD_SUCCESS)
+    {
+        DestroyTaskQueueItem(taskQueueItem);
+    }
+
+    return addStatus;
+}
+
+TASK_QUEUE_STATUS Thread::QueueWorkItems(THREAD_POOL_DATA *threadPool, THREAD_WORK_ITEM **workItems, uint32_t numItems, uint32_t *numQueued)
+{
+    // status of adding the items to the queue
+    TASK_QUEUE_STATUS   addStatus = TASK_QUEUE_STATUS_ADD_SUCCESS;
+
+    // number of items added
+    unsigned int        numAdded = 0;
+
+    // task queue items to be added
+    std::vector<TASK_QUEUE_ITEM*> taskQueueItems(numItems);
+
+    // create the task queue items, nothing is queued if any of them can't be created
+    for(uint32_t i = 0; i < numItems; i++)
+    {
+        workItems[i]->threadPool = threadPool;
+        taskQueueItems[i] = Thread::CreateWorkTaskItem(workItems[i]);
+        if(taskQueueItems[i] == 0)
+        {
+            addStatus = TASK_QUEUE_STATUS_ADD_MALLOC_FAIL;
+        }
+    }
+
+    // add the tasks to the thread pool with a single lock and wakeup
+    if((addStatus == TASK_QUEUE_STATUS_ADD_SUCCESS) && (numItems > 0))
+    {
+        addStatus = AddTasksToThreadPool(threadPool, &(taskQueueItems[0]), numItems, &numAdded);
+    }
+
+    // the queue did not take ownership of the remaining items
+    for(uint32_t i = numAdded; i < numItems; i++)
+    {
+        if(taskQueueItems[i] != 0)
+        {
+            DestroyTaskQueueItem(taskQueueItems[i]);
+        }
+        else
+        {
+            Thread::DisposeWorkItem(workItems[i], true);
+        }
+    }
+
+    if(numQueued != NULL)
+    {
+        *numQueued = numAdded;
+    }
+
+    return addStatus;
 }
 
 void* Thread::WorkItemFunction(TASK_QUEUE_WORK_DATA *taskData, void *threadContext, void *threadWorkItem)
@@ -260,6 +634,31 @@ void* Thread::WorkItemFunction(TASK_QUEUE_WORK_DATA *taskData, void *threadConte
     // thread work item
     THREAD_WORK_ITEM* workItem = (THREAD_WORK_ITEM*)threadWorkItem;
 
+    // nodes of a graph that already failed are skipped
+    if((workItem->workGraph != 0) && (SyncAtomicLoad(&(workItem->workGraph->graphStatus)) != THREAD_GRAPH_RUNNING))
+    {
+        return workItem;
+    }
+
+    // claim the work item, it is skipped if it was cancelled while queued
+    workItem->workIsolate = thisContext->threadIsolate;
+    if(SyncAtomicCompareExchange(&(workItem->workState), THREAD_WORK_RUNNING, THREAD_WORK_QUEUED) != THREAD_WORK_QUEUED)
+    {
+        return workItem;
+    }
+    if(workItem->timeoutMs > 0)
+    {
+        Thread::StartWorkDeadline(workItem);
+    }
+
+    // the isolate and context were already entered for the batch
+    if(thisContext->batchLocker != 0)
+    {
+        Thread::ExecuteWorkItem(thisContext, workItem);
+        Thread::CompleteWorkItem(workItem);
+        return workItem;
+    }
+
     // get reference to thread isolate
     Isolate* isolate = thisContext->threadIsolate;
     {
@@ -276,41 +675,9 @@ void* Thread::WorkItemFunction(TASK_QUEUE_WORK_DATA *taskData, void *threadConte
         Local<Context> isolateContext = Nan::New<Context>(*(thisContext->threadJSContext));
         isolateContext->Enter();
 
-        // exception catcher
-        TryCatch tryCatch;
-
-        // get worker object
-        Local<Object> workerObject = Thread::GetWorkerObject(thisContext, workItem);
-
-        // no errors getting the worker object
-        if(workItem->isError == false)
-        {
-            // get work param
-            Handle<Value> workParam = workItem->workParam->GetV8Value();
-
-            // get worker function name
-            Local<Value> workerFunction = Nan::Get(workerObject, Nan::New<String>(workItem->workFunction).ToLocalChecked()).ToLocalChecked();
-
-            // execute function and get work result
-            Local<Value> workResult = workerFunction.As<Function>()->Call(workerObject, 1, &workParam);
-
-            // work failed to perform successfully
-            if(workResult.IsEmpty() || tryCatch.HasCaught())
-            {
-                workItem->jsException = Utilities::HandleException(&tryCatch, true);
-                workItem->isError = true;
-            }
-            // work performed successfully
-            else
-            {
-                // strinigfy callback object
-                workItem->callbackObject = createDataFromValue(workResult);
-                workItem->isError = false;
-
-                // register external memory
-                // Nan::AdjustExternalMemory(workItem->callbackObject->length() + 1);
-            }
-        }
+        // perform the work
+        Thread::ExecuteWorkItem(thisContext, workItem);
+        Thread::CompleteWorkItem(workItem);
 
         // exit thread specific context
         isolateContext->Exit();
@@ -323,84 +690,738 @@ void* Thread::WorkItemFunction(TASK_QUEUE_WORK_DATA *taskData, void *threadConte
     return workItem;
 }
 
-void Thread::WorkItemCallback(TASK_QUEUE_WORK_DATA *taskData, void *threadContext, void *threadWorkItem)
-{
-    //fprintf(stdout, "[%u] Thread::WorkItemCallback\n", SyncGetThreadId());
-
-    // thread context
-    THREAD_CONTEXT* thisContext = (THREAD_CONTEXT*)threadContext;
-
-    // add work item to callback queue
-    THREAD_WORK_ITEM* workItem = (THREAD_WORK_ITEM*)malloc(sizeof(THREAD_WORK_ITEM));
-    memcpy(workItem, threadWorkItem, sizeof(THREAD_WORK_ITEM));
-    callbackQueue->AddWorkItem(workItem);
-
-    // async callback
-    uv_async_t *uvAsync = (uv_async_t*)thisContext->uvAsync;
-    uv_async_send(uvAsync);
-}
-
-void Thread::uvCloseCallback(uv_handle_t* handle)
+void Thread::ExecuteWorkItem(THREAD_CONTEXT* thisContext, THREAD_WORK_ITEM* workItem)
 {
-    //fprintf(stdout, "[%u] Thread::uvCloseCallback - Async: %p\n", SyncGetThreadId(), handle);
-    // cleanup the handle
-    free(handle);
-}
+    // handles created by the work item are released once it completes
+    Nan::HandleScope scope;
 
-#if NODE_VERSION_AT_LEAST(0, 11, 13)
-void Thread::uvAsyncCallback(uv_async_t* handle)
-#else
-void Thread::uvAsyncCallback(uv_async_t* handle, int status)
-#endif
-{
-    //fprintf(stdout, "[%u] Thread::uvAsyncCallback - Async: %p\n", SyncGetThreadId(), handle);
+    // exception catcher
+    TryCatch tryCatch;
 
-    Nan::HandleScope scope;
+    // get worker object
+    Local<Object> workerObject = Thread::GetWorkerObject(thisContext, workItem);
 
-    // process all work items awaiting callback
-    THREAD_WORK_ITEM* workItem = 0;
-    while((workItem = callbackQueue->GetWorkItem()) != 0)
+    // no errors getting the worker object
+    if(workItem->isError == false)
     {
-        Local<Value> callbackObject = Nan::Null();
-        Local<Value> exceptionObject = Nan::Null();
+        // get work param
+        Handle<Value> workParam = workItem->workParam->GetV8Value();
 
-        // parse exception if one is present
-        if(workItem->isError == true)
+        // get worker function name
+        Local<Value> workerFunction = Nan::Get(workerObject, Nan::New<String>(workItem->workFunction).ToLocalChecked()).ToLocalChecked();
+
+        // execute function and get work result, graph nodes read the results of their inputs ahead of their param
+        Local<Value> workResult;
+        thisContext->runningWorkItem = workItem;
+        if((workItem->workGraph != 0) && !workItem->workGraph->nodeInputs[workItem->graphNode].empty())
         {
-            exceptionObject = JsonUtility::Parse(**(workItem->jsException));
+            Handle<Value> workArgs[2] = { Thread::GetGraphInputs(workItem), workParam };
+            workResult = workerFunction.As<Function>()->Call(workerObject, 2, workArgs);
         }
         else
         {
-            // parse stringified result
-            callbackObject = workItem->callbackObject->GetV8Value();
+            workResult = workerFunction.As<Function>()->Call(workerObject, 1, &workParam);
         }
+        thisContext->runningWorkItem = 0;
 
-        //create arguments array
-        const unsigned argc = 3;
-        Local<Value> argv[argc] = {
-            callbackObject,
-            Nan::New<Number>(workItem->workId),
-            exceptionObject
-        };
-
-        // make callback on node thread
-        Nan::MakeCallback(
-            Nan::New<Object>(*(workItem->callbackContext)),
-            workItem->callbackFunction->GetFunction(),
-            argc,
-            argv);
+        // work failed to perform successfully
+        if(workResult.IsEmpty() || tryCatch.HasCaught())
+        {
+            Thread::SetWorkItemException(workItem, &tryCatch);
+        }
+        // work performed successfully
+        else
+        {
+            // strinigfy callback object
+            workItem->callbackObject = createDataFromValue(workResult);
+            workItem->isError = false;
 
-        // clean up memory and dispose of persistent references
-        Thread::DisposeWorkItem(workItem, true);
+            // register external memory
+            // Nan::AdjustExternalMemory(workItem->callbackObject->length() + 1);
+        }
     }
 }
 
-Local<Object> Thread::GetWorkerObject(THREAD_CONTEXT* thisContext, THREAD_WORK_ITEM* workItem)
+void Thread::SetWorkItemException(THREAD_WORK_ITEM* workItem, TryCatch* tryCatch)
 {
-    Nan::EscapableHandleScope scope;
+    // a terminated work item reports its cancellation or timeout, the termination can't be serialized
+    workItem->isError = true;
+    if(SyncAtomicLoad(&(workItem->workState)) >= THREAD_WORK_CANCELLED)
+    {
+        workItem->jsException = NULL;
+        return;
+    }
 
-    // return variable and exception
-    Local<Object> workerObject;
+    workItem->jsException = Utilities::HandleException(tryCatch, true);
+}
+
+void Thread::CompleteWorkItem(THREAD_WORK_ITEM* workItem)
+{
+    if(workItem->timeoutMs > 0)
+    {
+        Thread::StopWorkDeadline(workItem);
+    }
+
+    if(SyncAtomicCompareExchange(&(workItem->workState), THREAD_WORK_DONE, THREAD_WORK_RUNNING) == THREAD_WORK_RUNNING)
+    {
+        return;
+    }
+
+    // the work item was cancelled or timed out while it ran, wait for the termination to be requested
+    // before clearing it so it can't leak into the next work item
+    std::lock_guard<std::mutex> lock(workIndexMutex);
+    #if NODE_VERSION_AT_LEAST(0, 11, 13)
+        workItem->workIsolate->CancelTerminateExecution();
+    #else
+        V8::CancelTerminateExecution(workItem->workIsolate);
+    #endif
+}
+
+bool Thread::RequeueWorkItem(THREAD_WORK_ITEM* workItem)
+{
+    // periodic work items stop once they are cancelled or their pool is destroyed
+    THREAD_WORK_GROUP *workGroup = workItem->workGroup;
+    if((workItem->intervalMs == 0) ||
+        (SyncAtomicLoad(&(workItem->workState)) == THREAD_WORK_CANCELLED) ||
+        workGroup->isReleased ||
+        (workGroup->groupDrained != 0))
+    {
+        return false;
+    }
+
+    TASK_QUEUE_ITEM *taskQueueItem = Thread::CreateWorkTaskItem(workItem);
+    if(taskQueueItem == 0)
+    {
+        return false;
+    }
+
+    // discard the result of the previous run
+    if(workItem->callbackObject != NULL)
+    {
+        delete workItem->callbackObject;
+        workItem->callbackObject = NULL;
+    }
+    if(workItem->isError == true)
+    {
+        delete workItem->jsException;
+        workItem->jsException = NULL;
+        workItem->isError = false;
+    }
+
+    // runs are due at a fixed rate, a run that is already overdue is queued immediately
+    // rather than once per missed interval
+    unsigned long long currentTime = SyncGetTime();
+    workItem->dueTime += workItem->intervalMs;
+    if(workItem->dueTime < currentTime)
+    {
+        workItem->dueTime = currentTime;
+    }
+
+    SyncAtomicStore(&(workItem->workState), THREAD_WORK_QUEUED);
+    if(AddDelayedTaskToThreadPool(workItem->threadPool, taskQueueItem, (unsigned int)(workItem->dueTime - currentTime)) != TASK_QUEUE_STATUS_ADD_SUCCESS)
+    {
+        // the caller disposes of the work item
+        taskQueueItem->taskItemData = 0;
+        DestroyTaskQueueItem(taskQueueItem);
+        return false;
+    }
+
+    return true;
+}
+
+void Thread::StartWorkDeadline(THREAD_WORK_ITEM* workItem)
+{
+    std::lock_guard<std::mutex> lock(*watchdogMutex);
+
+    // the watchdog is started by the first work item with a timeout and runs until the last pool is destroyed
+    if(!watchdogStarted)
+    {
+        watchdogStarted = (SyncCreateThread(&watchdogThread, NULL, Thread::WatchdogFunction, NULL) == 0);
+    }
+
+    workItem->deadlineEntry = deadlineMap->insert(std::make_pair(SyncGetTime() + workItem->timeoutMs, workItem));
+    workItem->hasDeadline = true;
+
+    // the watchdog only needs to wake early for a new earliest deadline
+    if(workItem->deadlineEntry == deadlineMap->begin())
+    {
+        watchdogCond->notify_one();
+    }
+}
+
+void Thread::StopWorkDeadline(THREAD_WORK_ITEM* workItem)
+{
+    std::lock_guard<std::mutex> lock(*watchdogMutex);
+    if(workItem->hasDeadline)
+    {
+        deadlineMap->erase(workItem->deadlineEntry);
+        workItem->hasDeadline = false;
+    }
+}
+
+void Thread::StopWatchdog()
+{
+    {
+        std::lock_guard<std::mutex> lock(*watchdogMutex);
+        if(!watchdogStarted)
+        {
+            return;
+        }
+        watchdogTerminate = true;
+        watchdogCond->notify_one();
+    }
+
+    // the next work item with a timeout starts it again
+    SyncJoinThread(watchdogThread, NULL);
+    std::lock_guard<std::mutex> lock(*watchdogMutex);
+    watchdogStarted = false;
+    watchdogTerminate = false;
+}
+
+THREAD_FUNC WINAPI Thread::WatchdogFunction(void* watchdogContext)
+{
+    std::unique_lock<std::mutex> lock(*watchdogMutex);
+    while(!watchdogTerminate)
+    {
+        // sleep until the earliest deadline
+        if(deadlineMap->empty())
+        {
+            watchdogCond->wait(lock);
+            continue;
+        }
+        unsigned long long currentTime = SyncGetTime();
+        if(deadlineMap->begin()->first > currentTime)
+        {
+            watchdogCond->wait_for(lock, std::chrono::milliseconds(deadlineMap->begin()->first - currentTime));
+            continue;
+        }
+
+        // terminate the overdue work item unless it was cancelled first
+        THREAD_WORK_ITEM* workItem = deadlineMap->begin()->second;
+        deadlineMap->erase(deadlineMap->begin());
+        workItem->hasDeadline = false;
+        {
+            std::lock_guard<std::mutex> indexLock(workIndexMutex);
+            if(SyncAtomicCompareExchange(&(workItem->workState), THREAD_WORK_TIMED_OUT, THREAD_WORK_RUNNING) == THREAD_WORK_RUNNING)
+            {
+                #if NODE_VERSION_AT_LEAST(0, 11, 13)
+                    workItem->workIsolate->TerminateExecution();
+                #else
+                    V8::TerminateExecution(workItem->workIsolate);
+                #endif
+            }
+        }
+    }
+
+    return THREAD_FUNC_RETURN;
+}
+
+uint32_t Thread::CancelWorkItems(uint32_t workId)
+{
+    // number of work items cancelled
+    uint32_t numCancelled = 0;
+
+    std::lock_guard<std::mutex> lock(workIndexMutex);
+    std::pair<ThreadWorkIndex::iterator, ThreadWorkIndex::iterator> workItems = workIndex.equal_range(workId);
+    for(ThreadWorkIndex::iterator it = workItems.first; it != workItems.second; ++it)
+    {
+        THREAD_WORK_ITEM* workItem = it->second;
+
+        // a periodic work item is not queued again
+        bool isPeriodic = (workItem->intervalMs > 0);
+        workItem->intervalMs = 0;
+
+        // a delayed work item is queued immediately, a queued one gives up its slot if its queue can unlink it
+        // (it is skipped once a thread takes it from a ring queue, a per-thread deque or an inbox)
+        if(SyncAtomicCompareExchange(&(workItem->workState), THREAD_WORK_CANCELLED, THREAD_WORK_QUEUED) == THREAD_WORK_QUEUED)
+        {
+            if(workItem->threadPool != 0)
+            {
+                ExpireDelayedTasks(workItem->threadPool, workItem->workId);
+                TASK_QUEUE_ITEM *taskQueueItem = RemoveTaskFromThreadPool(workItem->threadPool, workItem->workId, (void*)workItem);
+                if(taskQueueItem != 0)
+                {
+                    // the work item is delivered without the task item (its callback owns the work item)
+                    taskQueueItem->taskItemData = 0;
+                    DestroyTaskQueueItem(taskQueueItem);
+
+                    workItem->completeTime = uv_hrtime();
+                    SyncAtomicIncrement(&(workItem->workGroup->numAwaitingCallback));
+                    cancelQueue->AddWorkItem(workItem);
+                    uv_ref((uv_handle_t*)cancelAsync);
+                    uv_async_send(cancelAsync);
+                }
+            }
+            numCancelled++;
+        }
+        // a running work item is terminated
+        else if(SyncAtomicCompareExchange(&(workItem->workState), THREAD_WORK_CANCELLED, THREAD_WORK_RUNNING) == THREAD_WORK_RUNNING)
+        {
+            #if NODE_VERSION_AT_LEAST(0, 11, 13)
+                workItem->workIsolate->TerminateExecution();
+            #else
+                V8::TerminateExecution(workItem->workIsolate);
+            #endif
+            numCancelled++;
+        }
+        // a periodic work item awaiting its callback delivers its result and stops
+        else if(isPeriodic)
+        {
+            numCancelled++;
+        }
+    }
+
+    return numCancelled;
+}
+
+void Thread::WorkItemCallback(TASK_QUEUE_WORK_DATA *taskData, void *threadContext, void *threadWorkItem)
+{
+    //fprintf(stdout, "[%u] Thread::WorkItemCallback\n", SyncGetThreadId());
+
+    // thread context
+    THREAD_CONTEXT* thisContext = (THREAD_CONTEXT*)threadContext;
+
+    // thread work item
+    THREAD_WORK_ITEM* workItem = (THREAD_WORK_ITEM*)threadWorkItem;
+
+    // graph nodes feed their outputs on this thread, the graph is delivered once its last node completes
+    if(workItem->workGraph != 0)
+    {
+        bool isFailed = workItem->isError || (SyncAtomicLoad(&(workItem->workState)) >= THREAD_WORK_CANCELLED);
+        Thread::FinishGraphNode(workItem, isFailed ? THREAD_GRAPH_FAILED : THREAD_GRAPH_RUNNING);
+        return;
+    }
+
+    // add work item to the callback queue of this thread (the callback owns the work item)
+    workItem->completeTime = uv_hrtime();
+    SyncAtomicIncrement(&(workItem->workGroup->numAwaitingCallback));
+    thisContext->callbackQueue->AddWorkItem(workItem);
+
+    // async callback
+    uv_async_t *uvAsync = (uv_async_t*)thisContext->uvAsync;
+    uv_async_send(uvAsync);
+}
+
+void Thread::TakeCallbackItem(THREAD_WORK_ITEM* workItem)
+{
+    THREAD_WORK_GROUP *workGroup = workItem->workGroup;
+
+    // time the work item waited for its callback
+    uint64_t callbackLagUs = (uv_hrtime() - workItem->completeTime) / 1000;
+    workGroup->lastCallbackLagUs = callbackLagUs;
+    if(callbackLagUs > workGroup->maxCallbackLagUs)
+    {
+        workGroup->maxCallbackLagUs = callbackLagUs;
+    }
+    workGroup->numCallbacks++;
+    SyncAtomicDecrement(&(workGroup->numAwaitingCallback));
+}
+
+void Thread::FinishCallbackItem(THREAD_WORK_ITEM* workItem)
+{
+    // periodic work items are queued for their next run, the others are done
+    if(Thread::RequeueWorkItem(workItem))
+    {
+        return;
+    }
+
+    // clean up memory and dispose of persistent references
+    Thread::DisposeWorkItem(workItem, true);
+}
+
+bool Thread::DeliverProgress(THREAD_WORK_ITEM* workItem)
+{
+    // take the partial results, unless the work item was signalled for its completion
+    THREAD_WORK_PROGRESS *workProgress = workItem->workProgress;
+    std::deque<IData*> progressChunks;
+    {
+        std::lock_guard<std::mutex> lock(workProgress->progressMutex);
+        if(workProgress->numNotifications == 0)
+        {
+            return false;
+        }
+        workProgress->numNotifications--;
+        workProgress->isNotified = false;
+        progressChunks.swap(workProgress->progressChunks);
+    }
+    workProgress->progressCond.notify_one();
+
+    // make progress callback on node thread, in the order the partial results were emitted
+    Local<Object> callbackContext = Nan::New<Object>(*(workItem->callbackContext));
+    Local<Function> progressFunction = workProgress->progressFunction->GetFunction();
+    for(size_t i = 0; i < progressChunks.size(); i++)
+    {
+        Nan::HandleScope scope;
+
+        const unsigned argc = 2;
+        Local<Value> argv[argc] = {
+            progressChunks[i]->GetV8Value(),
+            Nan::New<Number>(workItem->workId)
+        };
+        Nan::MakeCallback(callbackContext, progressFunction, argc, argv);
+        delete progressChunks[i];
+    }
+
+    return true;
+}
+
+NAN_METHOD(Thread::EmitProgress)
+{
+    Nan::HandleScope scope;
+
+    // validate input
+    if(info.Length() != 1)
+    {
+        return Nan::ThrowTypeError("emit - Expects only 1 argument.");
+    }
+
+    // partial results of work items without a progress function are discarded
+    THREAD_CONTEXT* thisContext = (THREAD_CONTEXT*)info.Data().As<External>()->Value();
+    THREAD_WORK_ITEM* workItem = thisContext->runningWorkItem;
+    if((workItem == 0) || (workItem->workProgress == 0))
+    {
+        info.GetReturnValue().Set(Nan::False());
+        return;
+    }
+
+    THREAD_WORK_PROGRESS *workProgress = workItem->workProgress;
+    IData *progressChunk = createDataFromValue(info[0]);
+    bool isNotified = false;
+    {
+        std::unique_lock<std::mutex> lock(workProgress->progressMutex);
+
+        // wait for the node thread to take partial results while the buffer is full
+        // (a cancelled or timed out work item terminates once it returns to javascript)
+        while(workProgress->progressChunks.size() >= workProgress->maxChunks)
+        {
+            if((SyncAtomicLoad(&(workItem->workState)) >= THREAD_WORK_CANCELLED) ||
+                SyncAtomicLoad(&(workItem->workGroup->isDestroying)))
+            {
+                delete progressChunk;
+                info.GetReturnValue().Set(Nan::False());
+                return;
+            }
+            workProgress->progressCond.wait_for(lock, std::chrono::milliseconds(THREAD_PROGRESS_WAIT_TIME));
+        }
+        workProgress->progressChunks.push_back(progressChunk);
+
+        // the watcher is signalled once until it takes the partial results
+        if(!workProgress->isNotified)
+        {
+            workProgress->isNotified = true;
+            workProgress->numNotifications++;
+            isNotified = true;
+        }
+    }
+
+    if(isNotified)
+    {
+        thisContext->callbackQueue->AddWorkItem(workItem);
+        uv_async_send(thisContext->uvAsync);
+    }
+
+    info.GetReturnValue().Set(Nan::True());
+}
+
+#ifdef RESOLVER_TABLE_SUPPORTED
+NAN_METHOD(Thread::SettleWorkItems)
+{
+    // work items whose promise is settled, by their result or their exception object
+    std::vector<THREAD_WORK_ITEM*> *workItems = (std::vector<THREAD_WORK_ITEM*>*)info[0].As<External>()->Value();
+    for(size_t i = 0; i < workItems->size(); i++)
+    {
+        Nan::HandleScope scope;
+
+        THREAD_WORK_ITEM *workItem = (*workItems)[i];
+        Local<Value> exceptionObject = Thread::GetExceptionObject(workItem);
+        bool isRejected = !exceptionObject->IsNull();
+        ResolverTable::Settle(
+            resolverTable->GetResolver(workItem->resolverSlot),
+            isRejected ? exceptionObject : workItem->callbackObject->GetV8Value(),
+            isRejected);
+    }
+}
+#endif
+
+void Thread::uvCloseCallback(uv_handle_t* handle)
+{
+    //fprintf(stdout, "[%u] Thread::uvCloseCallback - Async: %p\n", SyncGetThreadId(), handle);
+    // cleanup the handle
+    free(handle);
+}
+
+#if NODE_VERSION_AT_LEAST(0, 11, 13)
+void Thread::uvAsyncCallback(uv_async_t* handle)
+#else
+void Thread::uvAsyncCallback(uv_async_t* handle, int status)
+#endif
+{
+    //fprintf(stdout, "[%u] Thread::uvAsyncCallback - Async: %p\n", SyncGetThreadId(), handle);
+
+    // the watcher is signalled again to deliver the rest on a later iteration
+    if(!Thread::DeliverWorkItems((CallbackQueue*)handle->data))
+    {
+        uv_async_send(handle);
+    }
+}
+
+#if NODE_VERSION_AT_LEAST(0, 11, 13)
+void Thread::uvRetireCallback(uv_async_t* handle)
+#else
+void Thread::uvRetireCallback(uv_async_t* handle, int status)
+#endif
+{
+    // watchers of the threads that retired since
+    std::vector<uv_async_t*> retiringWatchers;
+    {
+        std::lock_guard<std::mutex> lock(retiredWatchersMutex);
+        retiringWatchers.swap(retiredWatchers);
+    }
+
+    // their threads add no more work items, release the queue and watcher of each once it is drained
+    bool hasDeferrals = false;
+    for(size_t i = 0; i < retiringWatchers.size(); i++)
+    {
+        uv_async_t* threadAsync = retiringWatchers[i];
+        CallbackQueue* threadQueue = (CallbackQueue*)threadAsync->data;
+        if(!Thread::DeliverWorkItems(threadQueue))
+        {
+            std::lock_guard<std::mutex> lock(retiredWatchersMutex);
+            retiredWatchers.push_back(threadAsync);
+            hasDeferrals = true;
+            continue;
+        }
+
+        delete threadQueue;
+        uv_close((uv_handle_t*)threadAsync, threadAsync->close_cb);
+    }
+
+    if(hasDeferrals)
+    {
+        uv_async_send(handle);
+    }
+    Thread::DestroyIsolates();
+}
+
+#if NODE_VERSION_AT_LEAST(0, 11, 13)
+void Thread::uvCancelCallback(uv_async_t* handle)
+#else
+void Thread::uvCancelCallback(uv_async_t* handle, int status)
+#endif
+{
+    // the watcher no longer keeps the event loop alive once the cancelled work items are delivered
+    if(!Thread::DeliverWorkItems((CallbackQueue*)handle->data))
+    {
+        uv_async_send(handle);
+        return;
+    }
+    uv_unref((uv_handle_t*)handle);
+}
+
+#if NODE_VERSION_AT_LEAST(0, 11, 13)
+void Thread::uvPrepareCallback(uv_prepare_t* handle)
+#else
+void Thread::uvPrepareCallback(uv_prepare_t* handle, int status)
+#endif
+{
+    // the watchers signalled during this iteration start a new callback budget
+    loopIteration++;
+}
+
+bool Thread::IsCallbackBudgetSpent(THREAD_WORK_GROUP *workGroup)
+{
+    // the watchers of a pool share one budget per iteration of the event loop
+    if(workGroup->budgetIteration != loopIteration)
+    {
+        workGroup->budgetIteration = loopIteration;
+        workGroup->budgetCallbacks = 0;
+        workGroup->budgetStartTime = uv_hrtime();
+    }
+
+    // at least one callback is made per iteration
+    return (workGroup->budgetCallbacks > 0) &&
+        (((workGroup->maxCallbacks > 0) && (workGroup->budgetCallbacks >= workGroup->maxCallbacks)) ||
+         ((workGroup->maxCallbackTimeUs > 0) && ((uv_hrtime() - workGroup->budgetStartTime) >= (uint64_t)workGroup->maxCallbackTimeUs * 1000)));
+}
+
+bool Thread::DeliverWorkItems(CallbackQueue* threadQueue)
+{
+    Nan::HandleScope scope;
+
+    // process the work items in the order they completed, until the budget of their pool is spent
+    std::vector<THREAD_WORK_ITEM*> batchItems;
+    THREAD_WORK_ITEM* workItem = 0;
+    while((workItem = threadQueue->GetWorkItem()) != 0)
+    {
+        THREAD_WORK_GROUP *workGroup = workItem->workGroup;
+        if(Thread::IsCallbackBudgetSpent(workGroup))
+        {
+            // yield to the event loop
+            workGroup->numDeferrals++;
+            return false;
+        }
+        threadQueue->PopWorkItem();
+        workGroup->budgetCallbacks++;
+
+        // the handles of each callback are released once it returns
+        Nan::HandleScope callbackScope;
+
+        // partial results of a running work item are signalled ahead of its completion
+        if((workItem->workProgress != 0) && Thread::DeliverProgress(workItem))
+        {
+            continue;
+        }
+        Thread::TakeCallbackItem(workItem);
+
+        #ifdef RESOLVER_TABLE_SUPPORTED
+        // the promises of the following work items queued by run() are settled by the same call
+        if(workItem->callbackFunction == 0)
+        {
+            batchItems.clear();
+            batchItems.push_back(workItem);
+            THREAD_WORK_ITEM* nextItem = 0;
+            while(!Thread::IsCallbackBudgetSpent(workGroup) &&
+                ((nextItem = threadQueue->GetWorkItem()) != 0) &&
+                (nextItem->workGroup == workGroup) &&
+                (nextItem->callbackFunction == 0))
+            {
+                threadQueue->PopWorkItem();
+                workGroup->budgetCallbacks++;
+                Thread::TakeCallbackItem(nextItem);
+                batchItems.push_back(nextItem);
+            }
+
+            // settled within a callback so the reactions of the promises run once it returns
+            if(settleCallback == 0)
+            {
+                settleCallback = new Nan::Callback(Nan::GetFunction(Nan::New<FunctionTemplate>(Thread::SettleWorkItems)).ToLocalChecked());
+            }
+            Local<Value> argv[1] = { Nan::New<External>((void*)&batchItems) };
+            Nan::MakeCallback(Nan::GetCurrentContext()->Global(), settleCallback->GetFunction(), 1, argv);
+
+            for(size_t i = 0; i < batchItems.size(); i++)
+            {
+                Thread::FinishCallbackItem(batchItems[i]);
+            }
+            continue;
+        }
+        #endif
+
+        Local<Object> callbackContext = Nan::New<Object>(*(workItem->callbackContext));
+        Local<Function> callbackFunction = workItem->callbackFunction->GetFunction();
+
+        // make callback on node thread
+        if(!workGroup->batchCallbacks)
+        {
+            Local<Value> callbackObject = Nan::Null();
+            Local<Value> exceptionObject = Thread::GetExceptionObject(workItem);
+
+            // parse stringified result
+            if(exceptionObject->IsNull())
+            {
+                callbackObject = workItem->callbackObject->GetV8Value();
+            }
+
+            //create arguments array
+            const unsigned argc = 3;
+            Local<Value> argv[argc] = {
+                callbackObject,
+                Nan::New<Number>(workItem->workId),
+                exceptionObject
+            };
+
+            Nan::MakeCallback(callbackContext, callbackFunction, argc, argv);
+            Thread::FinishCallbackItem(workItem);
+            continue;
+        }
+
+        // the following work items sharing the callback function and context are delivered by the same call
+        // (they count against the callback budget individually)
+        batchItems.clear();
+        batchItems.push_back(workItem);
+        THREAD_WORK_ITEM* nextItem = 0;
+        while(!Thread::IsCallbackBudgetSpent(workGroup) &&
+            ((nextItem = threadQueue->GetWorkItem()) != 0) &&
+            (nextItem->workGroup == workGroup) &&
+            (nextItem->callbackFunction != 0) &&
+            (nextItem->workProgress == 0) &&
+            nextItem->callbackFunction->GetFunction()->StrictEquals(callbackFunction) &&
+            Nan::New<Object>(*(nextItem->callbackContext))->StrictEquals(callbackContext))
+        {
+            threadQueue->PopWorkItem();
+            workGroup->budgetCallbacks++;
+            Thread::TakeCallbackItem(nextItem);
+            batchItems.push_back(nextItem);
+        }
+
+        // results, work ids and exceptions of the work items at the same index
+        uint32_t numItems = (uint32_t)batchItems.size();
+        Local<Array> callbackObjects = Nan::New<Array>(numItems);
+        Local<Array> workIds = Nan::New<Array>(numItems);
+        Local<Array> exceptionObjects = Nan::New<Array>(numItems);
+        for(uint32_t i = 0; i < numItems; i++)
+        {
+            Local<Value> exceptionObject = Thread::GetExceptionObject(batchItems[i]);
+            Nan::Set(callbackObjects, i, exceptionObject->IsNull() ? batchItems[i]->callbackObject->GetV8Value() : Nan::Null());
+            Nan::Set(workIds, i, Nan::New<Number>(batchItems[i]->workId));
+            Nan::Set(exceptionObjects, i, exceptionObject);
+        }
+
+        const unsigned argc = 3;
+        Local<Value> argv[argc] = {
+            callbackObjects,
+            workIds,
+            exceptionObjects
+        };
+
+        Nan::MakeCallback(callbackContext, callbackFunction, argc, argv);
+        for(uint32_t i = 0; i < numItems; i++)
+        {
+            Thread::FinishCallbackItem(batchItems[i]);
+        }
+    }
+
+    return true;
+}
+
+Local<Value> Thread::GetExceptionObject(THREAD_WORK_ITEM* workItem)
+{
+    Nan::EscapableHandleScope scope;
+
+    // null unless the work item failed
+    Local<Value> exceptionObject = Nan::Null();
+
+    // cancelled work items report a cancellation error in place of their result
+    if(SyncAtomicLoad(&(workItem->workState)) == THREAD_WORK_CANCELLED)
+    {
+        Local<Object> cancelObject = Nan::New<Object>();
+        Nan::Set(cancelObject, Nan::New<String>("message").ToLocalChecked(), Nan::New<String>("Work item was cancelled").ToLocalChecked());
+        Nan::Set(cancelObject, Nan::New<String>("cancelled").ToLocalChecked(), Nan::True());
+        exceptionObject = cancelObject;
+    }
+    // timed out work items report a timeout error in place of their result
+    else if(SyncAtomicLoad(&(workItem->workState)) == THREAD_WORK_TIMED_OUT)
+    {
+        Local<Object> timeoutObject = Nan::New<Object>();
+        Nan::Set(timeoutObject, Nan::New<String>("message").ToLocalChecked(), Nan::New<String>("Work item timed out").ToLocalChecked());
+        Nan::Set(timeoutObject, Nan::New<String>("timedOut").ToLocalChecked(), Nan::True());
+        exceptionObject = timeoutObject;
+    }
+    // parse exception if one is present
+    else if(workItem->isError == true)
+    {
+        exceptionObject = JsonUtility::Parse(**(workItem->jsException));
+    }
+
+    return scope.Escape(exceptionObject);
+}
+
+Local<Object> Thread::GetWorkerObject(THREAD_CONTEXT* thisContext, THREAD_WORK_ITEM* workItem)
+{
+    Nan::EscapableHandleScope scope;
+
+    // return variable and exception
+    Local<Object> workerObject;
     TryCatch tryCatch;
 
     // check module cache
@@ -427,8 +1448,7 @@ Local<Object> Thread::GetWorkerObject(THREAD_CONTEXT* thisContext, THREAD_WORK_I
         // check for exception on compile
         if(fileScript.IsEmpty() || tryCatch.HasCaught())
         {
-            workItem->jsException = Utilities::HandleException(&tryCatch, true);
-            workItem->isError = true;
+            Thread::SetWorkItemException(workItem, &tryCatch);
         }
         // no exception
         else
@@ -439,8 +1459,7 @@ Local<Object> Thread::GetWorkerObject(THREAD_CONTEXT* thisContext, THREAD_WORK_I
             // throw exception if script failed to run properly
             if(scriptResult.IsEmpty() || tryCatch.HasCaught())
             {
-                workItem->jsException = Utilities::HandleException(&tryCatch, true);
-                workItem->isError = true;
+                Thread::SetWorkItemException(workItem, &tryCatch);
             }
             else
             {
@@ -479,10 +1498,36 @@ Local<Object> Thread::GetWorkerObject(THREAD_CONTEXT* thisContext, THREAD_WORK_I
 
 void Thread::DisposeWorkItem(THREAD_WORK_ITEM* workItem, bool freeWorkItem)
 {
+    // the work item can no longer be cancelled
+    if(workItem->isIndexed)
+    {
+        std::lock_guard<std::mutex> lock(workIndexMutex);
+        workIndex.erase(workItem->indexEntry);
+        workItem->isIndexed = false;
+    }
+
     // cleanup the work item data
-    workItem->callbackContext->Reset();
-    delete workItem->callbackContext;
-    delete workItem->callbackFunction;
+    if(workItem->callbackFunction != 0)
+    {
+        workItem->callbackContext->Reset();
+        delete workItem->callbackContext;
+        delete workItem->callbackFunction;
+    }
+    #ifdef RESOLVER_TABLE_SUPPORTED
+    else
+    {
+        resolverTable->ReleaseResolver(workItem->resolverSlot);
+    }
+    #endif
+    if(workItem->workProgress != 0)
+    {
+        for(size_t i = 0; i < workItem->workProgress->progressChunks.size(); i++)
+        {
+            delete workItem->workProgress->progressChunks[i];
+        }
+        delete workItem->workProgress->progressFunction;
+        delete workItem->workProgress;
+    }
 
     // de-register memory
 #if 0
@@ -492,12 +1537,18 @@ void Thread::DisposeWorkItem(THREAD_WORK_ITEM* workItem, bool freeWorkItem)
         bytesToFree += (workItem->callbackObject->length() + 1);
     }
 #else
-    int bytesToFree = strlen(workItem->workFunction);
-    Nan::AdjustExternalMemory(-bytesToFree);
+    if(workItem->workFunction != workItem->workFunctionBuffer)
+    {
+        int bytesToFree = strlen(workItem->workFunction);
+        Nan::AdjustExternalMemory(-bytesToFree);
+    }
 #endif
 
     // un-alloc the memory
-    free(workItem->workFunction);
+    if(workItem->workFunction != workItem->workFunctionBuffer)
+    {
+        free(workItem->workFunction);
+    }
     delete workItem->workParam;
     if(workItem->callbackObject != NULL)
     {
@@ -507,8 +1558,451 @@ void Thread::DisposeWorkItem(THREAD_WORK_ITEM* workItem, bool freeWorkItem)
     {
         delete workItem->jsException;
     }
+
+    // the last work item of a group notifies its owner, or releases the group once the owner is done with it
+    THREAD_WORK_GROUP *workGroup = workItem->workGroup;
+    if(SyncAtomicDecrement(&(workGroup->numWorkItems)) == 0)
+    {
+        if(workGroup->isReleased)
+        {
+            delete workGroup;
+        }
+        else if(workGroup->groupDrained != 0)
+        {
+            workGroup->groupDrained(workGroup->groupContext);
+        }
+    }
+
     if(freeWorkItem == true)
     {
-        free(workItem);
+        FreeMemoryPoolBlock(workItemPool, workItem);
+    }
+}
+
+THREAD_WORK_GROUP* Thread::CreateWorkGroup()
+{
+    THREAD_WORK_GROUP *workGroup = new THREAD_WORK_GROUP();
+    memset(workGroup, 0, sizeof(THREAD_WORK_GROUP));
+    return workGroup;
+}
+
+void Thread::ReleaseWorkGroup(THREAD_WORK_GROUP *workGroup)
+{
+    // work items still awaiting their callback release the group once they are delivered
+    workGroup->groupDrained = 0;
+    workGroup->isReleased = true;
+    if(SyncAtomicLoad(&(workGroup->numWorkItems)) == 0)
+    {
+        delete workGroup;
+    }
+}
+
+void Thread::ReleaseWorkItem(void *threadWorkItem)
+{
+    Thread::DisposeWorkItem((THREAD_WORK_ITEM*)threadWorkItem, true);
+}
+
+THREAD_WORK_GRAPH* Thread::BuildWorkGraph(Local<Object> v8Graph, uint32_t defaultTimeout, THREAD_WORK_GROUP *workGroup, THREAD_POOL_DATA *threadPool)
+{
+    Nan::HandleScope scope;
+
+    // nodes and edges
+    Local<Value> v8Nodes = Nan::Get(v8Graph, Nan::New<String>("nodes").ToLocalChecked()).ToLocalChecked();
+    Local<Value> v8Edges = Nan::Get(v8Graph, Nan::New<String>("edges").ToLocalChecked()).ToLocalChecked();
+
+    return Thread::BuildGraph(v8Graph, v8Nodes, v8Edges, defaultTimeout, workGroup, threadPool);
+}
+
+THREAD_WORK_GRAPH* Thread::BuildWorkChain(Local<Object> v8Object, uint32_t defaultTimeout, THREAD_WORK_GROUP *workGroup, THREAD_POOL_DATA *threadPool)
+{
+    Nan::HandleScope scope;
+
+    // the unit of work and each of its continuations are the nodes of a chain
+    Local<Array> v8Nodes = Nan::New<Array>();
+    Local<Array> v8Edges = Nan::New<Array>();
+    Local<String> thenName = Nan::New<String>("then").ToLocalChecked();
+    Local<Value> v8Node = v8Object;
+
+    // a chain runs once, as soon as it is queued, and only its last node is delivered
+    if(!Nan::Get(v8Object, Nan::New<String>("delayMs").ToLocalChecked()).ToLocalChecked()->IsUndefined() ||
+        !Nan::Get(v8Object, Nan::New<String>("intervalMs").ToLocalChecked()).ToLocalChecked()->IsUndefined() ||
+        !Nan::Get(v8Object, Nan::New<String>("progressFunction").ToLocalChecked()).ToLocalChecked()->IsUndefined())
+    {
+        return NULL;
+    }
+
+    for(uint32_t i = 0; !v8Node->IsUndefined(); i++)
+    {
+        // a continuation referencing an earlier one would chain forever
+        if(!v8Node->IsObject() || (i > THREAD_MAX_CONTINUATIONS))
+        {
+            return NULL;
+        }
+        Nan::Set(v8Nodes, i, v8Node);
+
+        // each continuation reads the result of the node before it
+        if(i > 0)
+        {
+            Local<Array> v8Edge = Nan::New<Array>(2);
+            Nan::Set(v8Edge, 0, Nan::New<Uint32>(i - 1));
+            Nan::Set(v8Edge, 1, Nan::New<Uint32>(i));
+            Nan::Set(v8Edges, i - 1, v8Edge);
+        }
+
+        v8Node = Nan::Get(v8Node->ToObject(), thenName).ToLocalChecked();
+    }
+
+    THREAD_WORK_GRAPH* workGraph = Thread::BuildGraph(v8Object, v8Nodes, v8Edges, defaultTimeout, workGroup, threadPool);
+    if(workGraph != NULL)
+    {
+        workGraph->isChain = true;
+    }
+
+    return workGraph;
+}
+
+THREAD_WORK_GRAPH* Thread::BuildGraph(Local<Object> v8Properties, Local<Value> v8Nodes, Local<Value> v8Edges, uint32_t defaultTimeout, THREAD_WORK_GROUP *workGroup, THREAD_POOL_DATA *threadPool)
+{
+    Nan::HandleScope scope;
+
+    // properties every node's work item takes from the graph
+    static const char* graphProperties[] = { "workId", "callbackFunction", "callbackContext", "priority", "timeoutMs", "tenant" };
+
+    // the callback receiving the results of the sinks
+    Local<Value> v8Callback = Nan::Get(v8Properties, Nan::New<String>("callbackFunction").ToLocalChecked()).ToLocalChecked();
+    if(!v8Nodes->IsArray() || (v8Nodes.As<Array>()->Length() == 0) || (!v8Edges->IsUndefined() && !v8Edges->IsArray()) || !v8Callback->IsFunction())
+    {
+        return NULL;
+    }
+    uint32_t numNodes = v8Nodes.As<Array>()->Length();
+    uint32_t numEdges = v8Edges->IsArray() ? v8Edges.As<Array>()->Length() : 0;
+
+    // each edge is a [from, to] pair of node indices
+    std::vector<std::vector<uint32_t> > nodeInputs(numNodes);
+    std::vector<std::vector<uint32_t> > nodeOutputs(numNodes);
+    for(uint32_t i = 0; i < numEdges; i++)
+    {
+        Local<Value> v8Edge = Nan::Get(v8Edges.As<Array>(), i).ToLocalChecked();
+        if(!v8Edge->IsArray() || (v8Edge.As<Array>()->Length() != 2))
+        {
+            return NULL;
+        }
+
+        Local<Value> v8From = Nan::Get(v8Edge.As<Array>(), 0).ToLocalChecked();
+        Local<Value> v8To = Nan::Get(v8Edge.As<Array>(), 1).ToLocalChecked();
+        if(!v8From->IsUint32() || !v8To->IsUint32() || (v8From->Uint32Value() >= numNodes) || (v8To->Uint32Value() >= numNodes))
+        {
+            return NULL;
+        }
+
+        nodeOutputs[v8From->Uint32Value()].push_back(v8To->Uint32Value());
+        nodeInputs[v8To->Uint32Value()].push_back(v8From->Uint32Value());
+    }
+
+    // the nodes of a cycle would never be queued, order the nodes by their inputs to find one
+    std::vector<size_t> pendingInputs(numNodes);
+    std::vector<uint32_t> readyNodes;
+    uint32_t numOrdered = 0;
+    for(uint32_t i = 0; i < numNodes; i++)
+    {
+        pendingInputs[i] = nodeInputs[i].size();
+        if(pendingInputs[i] == 0)
+        {
+            readyNodes.push_back(i);
+        }
+    }
+    while(!readyNodes.empty())
+    {
+        uint32_t readyNode = readyNodes.back();
+        readyNodes.pop_back();
+        numOrdered++;
+
+        for(size_t i = 0; i < nodeOutputs[readyNode].size(); i++)
+        {
+            if(--pendingInputs[nodeOutputs[readyNode][i]] == 0)
+            {
+                readyNodes.push_back(nodeOutputs[readyNode][i]);
+            }
+        }
+    }
+    if(numOrdered != numNodes)
+    {
+        return NULL;
+    }
+
+    // build the work item of each node from the node's file and function and the graph's properties
+    std::vector<THREAD_WORK_ITEM*> workItems;
+    for(uint32_t i = 0; i < numNodes; i++)
+    {
+        THREAD_WORK_ITEM* workItem = NULL;
+        Local<Value> v8Node = Nan::Get(v8Nodes.As<Array>(), i).ToLocalChecked();
+        if(v8Node->IsObject())
+        {
+            Local<Object> v8WorkObject = Nan::New<Object>();
+            Local<String> propertyName = Nan::New<String>("fileKey").ToLocalChecked();
+            Nan::Set(v8WorkObject, propertyName, Nan::Get(v8Node->ToObject(), propertyName).ToLocalChecked());
+            propertyName = Nan::New<String>("workFunction").ToLocalChecked();
+            Nan::Set(v8WorkObject, propertyName, Nan::Get(v8Node->ToObject(), propertyName).ToLocalChecked());
+
+            // the param is optional for graph nodes
+            propertyName = Nan::New<String>("workParam").ToLocalChecked();
+            Local<Value> v8WorkParam = Nan::Get(v8Node->ToObject(), propertyName).ToLocalChecked();
+            Nan::Set(v8WorkObject, propertyName, v8WorkParam->IsUndefined() ? Nan::New<Object>().As<Value>() : v8WorkParam);
+
+            for(size_t j = 0; j < sizeof(graphProperties) / sizeof(graphProperties[0]); j++)
+            {
+                propertyName = Nan::New<String>(graphProperties[j]).ToLocalChecked();
+                Nan::Set(v8WorkObject, propertyName, Nan::Get(v8Properties, propertyName).ToLocalChecked());
+            }
+
+            workItem = Thread::BuildWorkItem(v8WorkObject, defaultTimeout, workGroup);
+        }
+
+        // release the nodes built so far
+        if(workItem == NULL)
+        {
+            for(size_t j = 0; j < workItems.size(); j++)
+            {
+                Thread::DisposeWorkItem(workItems[j], true);
+            }
+            return NULL;
+        }
+        workItems.push_back(workItem);
+    }
+
+    // create the graph
+    THREAD_WORK_GRAPH* workGraph = new THREAD_WORK_GRAPH();
+    workGraph->workItems.swap(workItems);
+    workGraph->nodeInputs.swap(nodeInputs);
+    workGraph->nodeOutputs.swap(nodeOutputs);
+    workGraph->pendingInputs = new THREAD_ATOMIC[numNodes];
+    workGraph->pendingOutputs = new THREAD_ATOMIC[numNodes];
+    for(uint32_t i = 0; i < numNodes; i++)
+    {
+        workGraph->pendingInputs[i] = (long)workGraph->nodeInputs[i].size();
+        workGraph->pendingOutputs[i] = (long)workGraph->nodeOutputs[i].size();
+        workGraph->workItems[i]->workGraph = workGraph;
+        workGraph->workItems[i]->graphNode = i;
+    }
+    workGraph->numPendingNodes = numNodes;
+    workGraph->graphStatus = THREAD_GRAPH_RUNNING;
+    workGraph->threadPool = threadPool;
+
+    // the graph is delivered on the node thread by its own watcher
+    workGraph->uvAsync = (uv_async_t*)malloc(sizeof(uv_async_t));
+    memset(workGraph->uvAsync, 0, sizeof(uv_async_t));
+    uv_async_init(uv_default_loop(), workGraph->uvAsync, Thread::uvGraphCallback);
+    workGraph->uvAsync->data = workGraph;
+
+    return workGraph;
+}
+
+bool Thread::QueueWorkGraph(THREAD_WORK_GRAPH *workGraph)
+{
+    // set if every source was queued
+    bool isQueued = true;
+
+    // queue the nodes without inputs, a graph that can't be started is discarded without a callback
+    // (the graph is delivered on this thread, so it outlives the loop)
+    for(uint32_t i = 0; i < workGraph->workItems.size(); i++)
+    {
+        if(workGraph->nodeInputs[i].empty() && !Thread::QueueGraphNode(workGraph->workItems[i]))
+        {
+            Thread::FinishGraphNode(workGraph->workItems[i], THREAD_GRAPH_DISCARDED);
+            isQueued = false;
+        }
+    }
+
+    return isQueued;
+}
+
+bool Thread::QueueGraphNode(THREAD_WORK_ITEM* workItem)
+{
+    // create task queue item object
+    TASK_QUEUE_ITEM *taskQueueItem = Thread::CreateWorkTaskItem(workItem);
+    if(taskQueueItem == 0)
+    {
+        return false;
+    }
+
+    // the work item stays with the graph if the queue did not take it
+    if(AddTaskToThreadPool(workItem->workGraph->threadPool, taskQueueItem) != TASK_QUEUE_STATUS_ADD_SUCCESS)
+    {
+        taskQueueItem->taskItemData = 0;
+        DestroyTaskQueueItem(taskQueueItem);
+        return false;
+    }
+
+    return true;
+}
+
+void Thread::FinishGraphNode(THREAD_WORK_ITEM* workItem, long nodeStatus)
+{
+    // graph of the node
+    THREAD_WORK_GRAPH* workGraph = workItem->workGraph;
+
+    // nodes completed by this call, the outputs of a failed graph complete without executing
+    std::vector<std::pair<THREAD_WORK_ITEM*, long> > finishedNodes(1, std::make_pair(workItem, nodeStatus));
+    while(!finishedNodes.empty())
+    {
+        uint32_t graphNode = finishedNodes.back().first->graphNode;
+        nodeStatus = finishedNodes.back().second;
+        finishedNodes.pop_back();
+
+        // only the first failure is delivered
+        if((nodeStatus != THREAD_GRAPH_RUNNING) &&
+            (SyncAtomicCompareExchange(&(workGraph->graphStatus), nodeStatus, THREAD_GRAPH_RUNNING) == THREAD_GRAPH_RUNNING))
+        {
+            workGraph->failedNode = graphNode;
+        }
+
+        // release the results of inputs every output has read (the results of sinks are kept for delivery)
+        const std::vector<uint32_t>& nodeInputs = workGraph->nodeInputs[graphNode];
+        for(size_t i = 0; i < nodeInputs.size(); i++)
+        {
+            if(SyncAtomicDecrement(&(workGraph->pendingOutputs[nodeInputs[i]])) == 0)
+            {
+                THREAD_WORK_ITEM* inputItem = workGraph->workItems[nodeInputs[i]];
+                delete inputItem->callbackObject;
+                inputItem->callbackObject = NULL;
+            }
+        }
+
+        // queue the outputs whose inputs have all completed
+        const std::vector<uint32_t>& nodeOutputs = workGraph->nodeOutputs[graphNode];
+        for(size_t i = 0; i < nodeOutputs.size(); i++)
+        {
+            THREAD_WORK_ITEM* outputItem = workGraph->workItems[nodeOutputs[i]];
+            if(SyncAtomicDecrement(&(workGraph->pendingInputs[nodeOutputs[i]])) != 0)
+            {
+                continue;
+            }
+
+            if(SyncAtomicLoad(&(workGraph->graphStatus)) != THREAD_GRAPH_RUNNING)
+            {
+                finishedNodes.push_back(std::make_pair(outputItem, (long)THREAD_GRAPH_RUNNING));
+            }
+            else if(!Thread::QueueGraphNode(outputItem))
+            {
+                finishedNodes.push_back(std::make_pair(outputItem, (long)THREAD_GRAPH_REJECTED));
+            }
+        }
+
+        // the last node delivers the graph, which must not be touched afterwards
+        // (the node is counted until here, so its outputs can't complete the graph first)
+        if(SyncAtomicDecrement(&(workGraph->numPendingNodes)) == 0)
+        {
+            uv_async_send(workGraph->uvAsync);
+        }
+    }
+}
+
+void Thread::ReleaseGraphNode(void *threadWorkItem)
+{
+    // a node released without executing (its pool was destroyed) discards the graph
+    Thread::FinishGraphNode((THREAD_WORK_ITEM*)threadWorkItem, THREAD_GRAPH_DISCARDED);
+}
+
+Local<Value> Thread::GetGraphInputs(THREAD_WORK_ITEM* workItem)
+{
+    Nan::EscapableHandleScope scope;
+
+    // results of the nodes the work item reads from, in the order of the edges
+    THREAD_WORK_GRAPH* workGraph = workItem->workGraph;
+    const std::vector<uint32_t>& nodeInputs = workGraph->nodeInputs[workItem->graphNode];
+
+    // a continuation reads the result of the previous node as is
+    if(workGraph->isChain)
+    {
+        IData* inputData = workGraph->workItems[nodeInputs[0]]->callbackObject;
+        return scope.Escape((inputData != NULL) ? Local<Value>(inputData->GetV8Value()) : Nan::Undefined().As<Value>());
+    }
+    Local<Array> graphInputs = Nan::New<Array>((int)nodeInputs.size());
+    for(size_t i = 0; i < nodeInputs.size(); i++)
+    {
+        IData* inputData = workGraph->workItems[nodeInputs[i]]->callbackObject;
+        Nan::Set(graphInputs, (uint32_t)i, (inputData != NULL) ? Local<Value>(inputData->GetV8Value()) : Nan::Undefined().As<Value>());
+    }
+
+    return scope.Escape(graphInputs);
+}
+
+#if NODE_VERSION_AT_LEAST(0, 11, 13)
+void Thread::uvGraphCallback(uv_async_t* handle)
+#else
+void Thread::uvGraphCallback(uv_async_t* handle, int status)
+#endif
+{
+    Nan::HandleScope scope;
+
+    // every node of the graph completed
+    THREAD_WORK_GRAPH* workGraph = (THREAD_WORK_GRAPH*)handle->data;
+    long graphStatus = SyncAtomicLoad(&(workGraph->graphStatus));
+
+    // a discarded graph is released without a callback, like a unit of work discarded by its pool
+    if(graphStatus != THREAD_GRAPH_DISCARDED)
+    {
+        Local<Value> callbackObject = Nan::Null();
+        Local<Value> exceptionObject = Nan::Null();
+
+        // the first failed node reports its exception for the graph
+        if(graphStatus == THREAD_GRAPH_FAILED)
+        {
+            exceptionObject = Thread::GetExceptionObject(workGraph->workItems[workGraph->failedNode]);
+        }
+        // a node rejected by a full task queue
+        else if(graphStatus == THREAD_GRAPH_REJECTED)
+        {
+            Local<Object> rejectObject = Nan::New<Object>();
+            Nan::Set(rejectObject, Nan::New<String>("message").ToLocalChecked(), Nan::New<String>("Work graph node was rejected by the task queue").ToLocalChecked());
+            Nan::Set(rejectObject, Nan::New<String>("rejected").ToLocalChecked(), Nan::True());
+            exceptionObject = rejectObject;
+        }
+        // the result of the last continuation
+        else if(workGraph->isChain)
+        {
+            IData* sinkData = workGraph->workItems.back()->callbackObject;
+            callbackObject = (sinkData != NULL) ? Local<Value>(sinkData->GetV8Value()) : Nan::Undefined().As<Value>();
+        }
+        // the results of the sinks in node order
+        else
+        {
+            Local<Array> sinkResults = Nan::New<Array>();
+            for(uint32_t i = 0, j = 0; i < workGraph->workItems.size(); i++)
+            {
+                if(workGraph->nodeOutputs[i].empty())
+                {
+                    IData* sinkData = workGraph->workItems[i]->callbackObject;
+                    Nan::Set(sinkResults, j++, (sinkData != NULL) ? Local<Value>(sinkData->GetV8Value()) : Nan::Undefined().As<Value>());
+                }
+            }
+            callbackObject = sinkResults;
+        }
+
+        //create arguments array
+        THREAD_WORK_ITEM* workItem = workGraph->workItems[0];
+        const unsigned argc = 3;
+        Local<Value> argv[argc] = {
+            callbackObject,
+            Nan::New<Number>(workItem->workId),
+            exceptionObject
+        };
+
+        // make callback on node thread
+        Nan::MakeCallback(
+            Nan::New<Object>(*(workItem->callbackContext)),
+            workItem->callbackFunction->GetFunction(),
+            argc,
+            argv);
+    }
+
+    // clean up the nodes, the graph and its watcher
+    for(size_t i = 0; i < workGraph->workItems.size(); i++)
+    {
+        Thread::DisposeWorkItem(workGraph->workItems[i], true);
     }
+    delete[] workGraph->pendingInputs;
+    delete[] workGraph->pendingOutputs;
+    delete workGraph;
+    uv_close((uv_handle_t*)handle, Thread::uvCloseCallback);
 }
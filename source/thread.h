@@ -2,6 +2,11 @@
 #define _THREAD_H_
 
 // C++
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
 #ifdef __APPLE__
 #include <tr1/unordered_map>
 #else
@@ -16,6 +21,8 @@ using namespace v8;
 
 #include <nan.h>
 
+#include "resolver_table.h"
+
 // threadpool
 #include "synchronize.h"
 #include "task_queue.h"
@@ -23,6 +30,33 @@ using namespace v8;
 
 #include "structure.h"
 
+// work function names shorter than this are stored within the work item
+#define THREAD_WORK_FUNCTION_BUFFER_SIZE    48
+
+// bytes of a thread's stack kept below the js stack limit for native frames
+#define THREAD_STACK_GUARD_SIZE             (64 * 1024)
+
+// state of a work item, a work item is only cancelled while it is queued or running
+#define THREAD_WORK_QUEUED                  0
+#define THREAD_WORK_RUNNING                 1
+#define THREAD_WORK_DONE                    2
+#define THREAD_WORK_CANCELLED               3
+#define THREAD_WORK_TIMED_OUT               4
+
+// status of a work graph, only the first failure is kept
+#define THREAD_GRAPH_RUNNING                0
+#define THREAD_GRAPH_FAILED                 1
+#define THREAD_GRAPH_REJECTED               2
+#define THREAD_GRAPH_DISCARDED              3
+
+// most continuations a unit of work may chain
+#define THREAD_MAX_CONTINUATIONS            64
+
+// partial results a unit of work may emit ahead of their delivery before emit() waits, and how often (ms)
+// a waiting emit() checks whether the unit of work was cancelled or its pool is being destroyed
+#define THREAD_PROGRESS_DEFAULT_BUFFER_SIZE 16
+#define THREAD_PROGRESS_WAIT_TIME           10
+
 // thread module map
 #ifdef __APPLE__
 typedef std::tr1::unordered_map<uint32_t, Nan::Persistent<Object>*> ThreadModuleMap;
@@ -30,10 +64,14 @@ typedef std::tr1::unordered_map<uint32_t, Nan::Persistent<Object>*> ThreadModule
 typedef std::unordered_map<uint32_t, Nan::Persistent<Object>*> ThreadModuleMap;
 #endif
 
+// completed work items of a thread awaiting their callback (callback_queue.h)
+class CallbackQueue;
+
 typedef struct THREAD_CONTEXT_STRUCT
 {
-    // libuv
+    // libuv, the watcher's data is the callback queue it drains
     uv_async_t*                 uvAsync;
+    CallbackQueue*              callbackQueue;
 
     // v8
     Isolate*                    threadIsolate;
@@ -42,27 +80,177 @@ typedef struct THREAD_CONTEXT_STRUCT
     // thread module cache
     ThreadModuleMap*            moduleMap;
 
+    // isolate lock held while a batch of work items executes
+    Locker*                     batchLocker;
+
+    // work item executing on the thread, emit() adds its partial results
+    struct THREAD_WORK_ITEM_STRUCT* runningWorkItem;
+
 } THREAD_CONTEXT;
 
+// work items of a thread pool that have not been delivered, the group is owned by the node thread
+// (threads only release work items while the node thread waits for them to terminate)
+typedef struct THREAD_WORK_GROUP_STRUCT
+{
+    // number of work items built and not yet delivered or released
+    THREAD_ATOMIC               numWorkItems;
+
+    // called once the last work item is delivered, while set
+    void                        (*groupDrained)(void* groupContext);
+    void*                       groupContext;
+
+    // set once the owner no longer needs the group, the last work item releases it
+    bool                        isReleased;
+
+    // set before the threads of the pool are destroyed, a waiting emit() gives up
+    THREAD_ATOMIC               isDestroying;
+
+    // callbacks the watchers of the pool make per iteration of the event loop before they yield to it,
+    // by count and by time (us), 0 is unlimited
+    uint32_t                    maxCallbacks;
+    uint32_t                    maxCallbackTimeUs;
+
+    // iteration of the event loop the budget was last started in, the callbacks made and the time (ns) it started
+    uint64_t                    budgetIteration;
+    uint32_t                    budgetCallbacks;
+    uint64_t                    budgetStartTime;
+
+    // completed work items sharing a callback function and context are delivered by one call of arrays
+    bool                        batchCallbacks;
+
+    // completed work items awaiting their callback
+    THREAD_ATOMIC               numAwaitingCallback;
+
+    // delivery statistics (node thread only), the callbacks made, the times a watcher yielded with
+    // callbacks left, and the time (us) between the last and the slowest work item completing and its callback
+    uint64_t                    numCallbacks;
+    uint64_t                    numDeferrals;
+    uint64_t                    lastCallbackLagUs;
+    uint64_t                    maxCallbackLagUs;
+
+} THREAD_WORK_GROUP;
+
+// partial results of a work item on their way to the node thread
+typedef struct THREAD_WORK_PROGRESS_STRUCT
+{
+    // called with each partial result on the node thread
+    Nan::Callback*              progressFunction;
+
+    // partial results emitted and not yet taken by the node thread, emit() waits while there are maxChunks
+    std::deque<IData*>          progressChunks;
+    uint32_t                    maxChunks;
+
+    // set while the watcher is signalled for the partial results, and the work item's entries within the
+    // callback queue that signal partial results (they precede its completion)
+    bool                        isNotified;
+    uint32_t                    numNotifications;
+
+    std::mutex                  progressMutex;
+    std::condition_variable     progressCond;
+
+} THREAD_WORK_PROGRESS;
+
+// running work items with a timeout, ordered by deadline (ms)
+typedef std::multimap<unsigned long long, struct THREAD_WORK_ITEM_STRUCT*> ThreadDeadlineMap;
+
+// work items that have not been delivered, indexed by work id
+#ifdef __APPLE__
+typedef std::tr1::unordered_multimap<uint32_t, struct THREAD_WORK_ITEM_STRUCT*> ThreadWorkIndex;
+#else
+typedef std::unordered_multimap<uint32_t, struct THREAD_WORK_ITEM_STRUCT*> ThreadWorkIndex;
+#endif
+
 typedef struct THREAD_WORK_ITEM_STRUCT
 {
     // work info and input object/function
     uint32_t                    workId;
     uint32_t                    fileKey;
     char*                       workFunction;
+    char                        workFunctionBuffer[THREAD_WORK_FUNCTION_BUFFER_SIZE];
     IData*                      workParam;
+    uint32_t                    priority;
+    uint32_t                    tenant;
+
+    // work items of the same thread pool
+    THREAD_WORK_GROUP*          workGroup;
 
     // callback and output object/function
     Nan::Persistent<Object>*     callbackContext;
     Nan::Callback*               callbackFunction;
     IData*                       callbackObject;
 
+    // slot of the resolver whose promise is settled in place of a callback (callbackFunction is 0)
+    uint32_t                    resolverSlot;
+
+    // partial results delivered ahead of the callback (0 unless the work item has a progress function)
+    THREAD_WORK_PROGRESS*       workProgress;
+
     // indicates error
     bool                        isError;
     Nan::Utf8String*            jsException;
 
+    // state of the work item and the isolate executing it (set before it runs)
+    THREAD_ATOMIC               workState;
+    Isolate*                    workIsolate;
+
+    // time (ms) the work item may run before it is terminated (0 runs without a limit)
+    uint32_t                    timeoutMs;
+
+    // entry of the running work item within the watchdog's deadlines
+    bool                        hasDeadline;
+    ThreadDeadlineMap::iterator deadlineEntry;
+
+    // entry of the work item within the index of the work items that can be cancelled
+    bool                        isIndexed;
+    ThreadWorkIndex::iterator   indexEntry;
+
+    // graph the work item is a node of (0 for work items queued on their own)
+    struct THREAD_WORK_GRAPH_STRUCT* workGraph;
+    uint32_t                    graphNode;
+
+    // time (ms) before the work item is first queued and between the runs of a periodic work item (0 for neither)
+    uint32_t                    delayMs;
+    uint32_t                    intervalMs;
+
+    // pool the work item is queued to and the time (ms) the last run of a delayed work item was due
+    THREAD_POOL_DATA*           threadPool;
+    unsigned long long          dueTime;
+
+    // time (ns) the work item was added to the callback queue
+    uint64_t                    completeTime;
+
 } THREAD_WORK_ITEM;
 
+// work items executed in dependency order within the pool, a node is queued once every node it reads from completed
+// (only the results of the sinks, the nodes nothing reads from, are delivered to the node thread)
+typedef struct THREAD_WORK_GRAPH_STRUCT
+{
+    // work item of each node, and the nodes each node reads from and feeds in the order of the edges
+    std::vector<THREAD_WORK_ITEM*>          workItems;
+    std::vector<std::vector<uint32_t> >     nodeInputs;
+    std::vector<std::vector<uint32_t> >     nodeOutputs;
+
+    // per node, the inputs not yet completed and the outputs not yet completed (a result is released once every output read it)
+    THREAD_ATOMIC*              pendingInputs;
+    THREAD_ATOMIC*              pendingOutputs;
+
+    // nodes not yet completed, the last one delivers the graph
+    THREAD_ATOMIC               numPendingNodes;
+
+    // status of the graph and the node whose failure is delivered
+    THREAD_ATOMIC               graphStatus;
+    uint32_t                    failedNode;
+
+    // pool the nodes are queued to and the watcher delivering the graph
+    THREAD_POOL_DATA*           threadPool;
+    uv_async_t*                 uvAsync;
+
+    // set for the continuations of a unit of work, each node reads the previous node's result rather than an array
+    // and the result of the last node is delivered on its own
+    bool                        isChain;
+
+} THREAD_WORK_GRAPH;
+
 class Thread
 {
     public:
@@ -70,16 +258,71 @@ class Thread
         static void*                ThreadInit();
         static void                 ThreadPostInit(void* threadContext);
         static void                 ThreadDestroy(void* threadContext);
+        static void                 ThreadBatchEnter(void* threadContext);
+        static void                 ThreadBatchExit(void* threadContext);
         static void                 DestroyIsolates();
 
-        static THREAD_WORK_ITEM*    BuildWorkItem(Local<Object> v8Object);
-        static void                 QueueWorkItem(TASK_QUEUE_DATA *taskQueue, THREAD_WORK_ITEM *workItem);
+        // emit(partial) of the worker functions
+        static NAN_METHOD(EmitProgress);
+
+        static THREAD_WORK_ITEM*    BuildWorkItem(Local<Object> v8Object, uint32_t defaultTimeout, THREAD_WORK_GROUP *workGroup);
+        #ifdef RESOLVER_TABLE_SUPPORTED
+        static THREAD_WORK_ITEM*    BuildPromiseWorkItem(Local<Object> v8Object, uint32_t defaultTimeout, THREAD_WORK_GROUP *workGroup, Local<Promise::Resolver> *resolver, bool isCancellable);
+        #endif
+        static TASK_QUEUE_STATUS    QueueWorkItem(THREAD_POOL_DATA *threadPool, THREAD_WORK_ITEM *workItem);
+        static TASK_QUEUE_STATUS    QueueWorkItems(THREAD_POOL_DATA *threadPool, THREAD_WORK_ITEM **workItems, uint32_t numItems, uint32_t *numQueued);
+        static void                 ReleaseWorkItem(void *threadWorkItem);
+        static uint32_t             CancelWorkItems(uint32_t workId);
+
+        // terminates the watchdog once no thread pool is left to run work items with a timeout
+        static void                 StopWatchdog();
+
+        // work groups
+        static THREAD_WORK_GROUP*   CreateWorkGroup();
+        static void                 ReleaseWorkGroup(THREAD_WORK_GROUP *workGroup);
+
+        // work graphs
+        static THREAD_WORK_GRAPH*   BuildWorkGraph(Local<Object> v8Graph, uint32_t defaultTimeout, THREAD_WORK_GROUP *workGroup, THREAD_POOL_DATA *threadPool);
+        static THREAD_WORK_GRAPH*   BuildWorkChain(Local<Object> v8Object, uint32_t defaultTimeout, THREAD_WORK_GROUP *workGroup, THREAD_POOL_DATA *threadPool);
+        static bool                 QueueWorkGraph(THREAD_WORK_GRAPH *workGraph);
 
     private:
 
+        // work items settling a promise are built without a callback
+        static THREAD_WORK_ITEM* CreateWorkItem(Local<Object> v8Object, uint32_t defaultTimeout, THREAD_WORK_GROUP *workGroup, bool hasCallback, bool isCancellable);
+
         // work function and callback
         static void*            WorkItemFunction(TASK_QUEUE_WORK_DATA *taskData, void *threadContext, void *threadWorkItem);
         static void             WorkItemCallback(TASK_QUEUE_WORK_DATA *taskData, void *threadContext, void *threadWorkItem);
+        static void             ExecuteWorkItem(THREAD_CONTEXT* thisContext, THREAD_WORK_ITEM* workItem);
+        static void             CompleteWorkItem(THREAD_WORK_ITEM* workItem);
+        static bool             RequeueWorkItem(THREAD_WORK_ITEM* workItem);
+        static void             TakeCallbackItem(THREAD_WORK_ITEM* workItem);
+        static void             FinishCallbackItem(THREAD_WORK_ITEM* workItem);
+        static bool             DeliverProgress(THREAD_WORK_ITEM* workItem);
+        #ifdef RESOLVER_TABLE_SUPPORTED
+        static NAN_METHOD(SettleWorkItems);
+        #endif
+        static void             SetWorkItemException(THREAD_WORK_ITEM* workItem, TryCatch* tryCatch);
+        static Local<Value>     GetExceptionObject(THREAD_WORK_ITEM* workItem);
+
+        // work graph nodes
+        static THREAD_WORK_GRAPH* BuildGraph(Local<Object> v8Properties, Local<Value> v8Nodes, Local<Value> v8Edges, uint32_t defaultTimeout, THREAD_WORK_GROUP *workGroup, THREAD_POOL_DATA *threadPool);
+        static bool             QueueGraphNode(THREAD_WORK_ITEM* workItem);
+        static void             FinishGraphNode(THREAD_WORK_ITEM* workItem, long nodeStatus);
+        static void             ReleaseGraphNode(void *threadWorkItem);
+        static Local<Value>     GetGraphInputs(THREAD_WORK_ITEM* workItem);
+
+        // execution deadlines
+        static void             StartWorkDeadline(THREAD_WORK_ITEM* workItem);
+        static void             StopWorkDeadline(THREAD_WORK_ITEM* workItem);
+        static THREAD_FUNC WINAPI WatchdogFunction(void* watchdogContext);
+
+        // js stack limit of the calling thread's isolate
+        static void             SetStackLimit(Isolate* isolate);
+
+        // task queue item
+        static TASK_QUEUE_ITEM* CreateWorkTaskItem(THREAD_WORK_ITEM *workItem);
 
         // worker object
         static Local<Object>   GetWorkerObject(THREAD_CONTEXT* thisContext, THREAD_WORK_ITEM* workItem);
@@ -89,10 +332,25 @@ class Thread
 
         #if NODE_VERSION_AT_LEAST(0, 11, 13)
         static void             uvAsyncCallback(uv_async_t* handle);
+        static void             uvRetireCallback(uv_async_t* handle);
+        static void             uvCancelCallback(uv_async_t* handle);
+        static void             uvPrepareCallback(uv_prepare_t* handle);
+        static void             uvGraphCallback(uv_async_t* handle);
         #else
         static void             uvAsyncCallback(uv_async_t* handle, int status);
+        static void             uvRetireCallback(uv_async_t* handle, int status);
+        static void             uvCancelCallback(uv_async_t* handle, int status);
+        static void             uvPrepareCallback(uv_prepare_t* handle, int status);
+        static void             uvGraphCallback(uv_async_t* handle, int status);
         #endif
 
+        // true once the watchers of a pool spent its callback budget of this iteration of the event loop
+        static bool             IsCallbackBudgetSpent(THREAD_WORK_GROUP *workGroup);
+
+        // makes the callbacks of the work items within a thread's callback queue in the order they completed,
+        // false if the budget of their pool was spent before the queue was drained
+        static bool             DeliverWorkItems(CallbackQueue* threadQueue);
+
         // memory disposal
         static void             DisposeWorkItem(THREAD_WORK_ITEM* workItem, bool freeWorkItem);
 };
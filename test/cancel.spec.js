@@ -0,0 +1,141 @@
+var assert = require("assert");
+
+// load appropriate npool module
+var nPool = null;
+try {
+    nPool = require(__dirname + '/../build/Release/npool');
+}
+catch (e) {
+    nPool = require(__dirname + '/../build/Debug/npool');
+}
+
+describe("[ cancel() - Tests ]", function() {
+    it("OK", function() {
+        assert.notEqual(nPool, undefined);
+    });
+});
+
+describe("cancel() shall report a cancellation error through the callback of cancelled units of work.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+        nPool.createThreadPool(1);
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    var createUnitOfWork = function(workId, fibNumber, callbackFunction) {
+        return {
+            workId: workId,
+            fileKey: 1,
+            workFunction: "calcFibonacciNumber",
+            workParam: {
+                fibNumber: fibNumber
+            },
+            callbackFunction: callbackFunction,
+            callbackContext: this
+        };
+    };
+
+    it("Terminated a running unit of work and cancelled a queued unit of work.", function(done) {
+        this.timeout(10000);
+
+        var numCallbacks = 0;
+        var callbackFunction = function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(callbackObject, null);
+                assert.equal(exceptionObject.cancelled, true);
+                if(++numCallbacks == 2) {
+                    done();
+                }
+            }
+            catch(exception) {
+                done(exception);
+            }
+        };
+
+        // the first unit of work runs for far longer than the test timeout
+        nPool.queueWork(createUnitOfWork(1, 60, callbackFunction));
+        nPool.queueWork(createUnitOfWork(2, 10, callbackFunction));
+
+        assert.equal(nPool.cancel(2), true);
+        setTimeout(function() {
+            assert.equal(nPool.cancel(1), true);
+        }, 100);
+    });
+
+    it("Executed a unit of work on the thread of a terminated unit of work.", function(done) {
+        nPool.queueWork(createUnitOfWork(3, 10, function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(callbackObject.fibCalcResult, 55);
+                assert.equal(exceptionObject, null);
+                done();
+            }
+            catch(exception) {
+                done(exception);
+            }
+        }));
+    });
+
+    it("Delivered the cancellation of a queued unit of work while the unit of work ahead of it was executing.", function(done) {
+        this.timeout(10000);
+
+        var isDelivered = false;
+        nPool.queueWork(createUnitOfWork(4, 60, function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(isDelivered, true);
+                assert.equal(exceptionObject.cancelled, true);
+                done();
+            }
+            catch(exception) {
+                done(exception);
+            }
+        }));
+        nPool.queueWork(createUnitOfWork(5, 10, function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(exceptionObject.cancelled, true);
+                isDelivered = true;
+
+                // the unit of work ahead of it is still executing
+                assert.equal(nPool.cancel(4), true);
+            }
+            catch(exception) {
+                done(exception);
+            }
+        }));
+
+        assert.equal(nPool.cancel(5), true);
+    });
+
+    it("Returned false for a work id that is not queued or executing.", function() {
+        assert.equal(nPool.cancel(100), false);
+    });
+});
+
+describe("cancel() shall throw an exception when passed an invalid argument.", function() {
+
+    it("Exception thrown when there are no parameters.", function() {
+        var thrownException = null;
+        try {
+            nPool.cancel();
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a string parameter.", function() {
+        var thrownException = null;
+        try {
+            nPool.cancel("1");
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+});
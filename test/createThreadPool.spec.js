@@ -71,6 +71,37 @@ describe("createThreadPool() shall throw an exception when called more than once
     });
 });
 
+describe("createThreadPool() shall create named thread pools next to the default thread pool.", function() {
+    var poolHandles = [];
+
+    after(function() {
+        for(var i = 0; i < poolHandles.length; i++) {
+            nPool.destroyThreadPool(poolHandles[i]);
+        }
+    });
+
+    it("Returned a distinct handle for each thread pool.", function() {
+        poolHandles.push(nPool.createThreadPool(2));
+        poolHandles.push(nPool.createThreadPool(1, { name: "latency" }));
+        poolHandles.push(nPool.createThreadPool(4, { name: "batch" }));
+
+        assert.equal(typeof poolHandles[0], "number");
+        assert.notEqual(poolHandles[0], poolHandles[1]);
+        assert.notEqual(poolHandles[1], poolHandles[2]);
+    });
+
+    it("Exception thrown when a thread pool name is reused.", function() {
+        var thrownException = null;
+        try {
+            nPool.createThreadPool(2, { name: "batch" });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+});
+
 describe("createThreadPool() shall throw an exception when passed zero arguments.", function() {
     var thrownException = null;
 
@@ -149,3 +180,361 @@ describe("createThreadPool() shall throw an exception when passed a non-integer
         assert.notEqual(thrownException, null);
     });
 });
+
+describe("createThreadPool() shall execute without throwing an exception when passed valid options.", function() {
+    var thrownException = null;
+
+    beforeEach(function() {
+        thrownException = null;
+    });
+
+    afterEach(function() {
+        if(thrownException == null) {
+            nPool.destroyThreadPool();
+        }
+    });
+
+    it("Executed without an exception for a list queue.", function() {
+        try {
+            nPool.createThreadPool(2, { queueType: "list" });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.equal(thrownException, null);
+    });
+
+    it("Executed without an exception for a ring queue.", function() {
+        try {
+            nPool.createThreadPool(2, { queueType: "ring", queueCapacity: 64 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.equal(thrownException, null);
+    });
+
+    it("Executed without an exception for a fair queue.", function() {
+        try {
+            nPool.createThreadPool(2, { queueType: "fair" });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.equal(thrownException, null);
+    });
+
+    it("Executed without an exception for a work stealing scheduler.", function() {
+        try {
+            nPool.createThreadPool(4, { scheduler: "workStealing" });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.equal(thrownException, null);
+    });
+
+    it("Executed without an exception for an affinity scheduler.", function() {
+        try {
+            nPool.createThreadPool(4, { scheduler: "affinity", affinityWaitMs: 10 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.equal(thrownException, null);
+    });
+
+    it("Executed without an exception for a maximum batch size.", function() {
+        try {
+            nPool.createThreadPool(2, { maxBatchSize: 1 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.equal(thrownException, null);
+    });
+
+    it("Executed without an exception for a wait policy.", function() {
+        try {
+            nPool.createThreadPool(2, { spinCount: 0, yieldCount: 100 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.equal(thrownException, null);
+    });
+
+    it("Executed without an exception for an elastic pool.", function() {
+        try {
+            nPool.createThreadPool(2, { minThreads: 1, maxThreads: 8, idleTimeoutMs: 100, spawnWaitMs: 5 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.equal(thrownException, null);
+    });
+
+    it("Executed without an exception for pinned threads.", function() {
+        try {
+            nPool.createThreadPool(2, { affinity: "scatter", cpus: [0] });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.equal(thrownException, null);
+    });
+
+    it("Executed without an exception for a stack size and thread name.", function() {
+        try {
+            nPool.createThreadPool(2, { stackSize: 4 * 1024 * 1024, threadName: "test-w" });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.equal(thrownException, null);
+    });
+
+    it("Executed without an exception for batched and limited callbacks.", function() {
+        try {
+            nPool.createThreadPool(2, { batchCallbacks: true, maxCallbacksPerTick: 100, maxCallbackTimeUs: 1000 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.equal(thrownException, null);
+    });
+});
+
+describe("createThreadPool() shall throw an exception when passed malformed options.", function() {
+    var thrownException = null;
+
+    beforeEach(function() {
+        thrownException = null;
+    });
+
+    afterEach(function() {
+        if(thrownException == null) {
+            nPool.destroyThreadPool();
+        }
+    });
+
+    it("Exception thrown for unknown queue type.", function() {
+        try {
+            nPool.createThreadPool(2, { queueType: "stack" });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for unknown scheduler.", function() {
+        try {
+            nPool.createThreadPool(2, { scheduler: "random" });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for non-integer queue capacity.", function() {
+        try {
+            nPool.createThreadPool(2, { queueType: "ring", queueCapacity: "large" });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for zero maximum batch size.", function() {
+        try {
+            nPool.createThreadPool(2, { maxBatchSize: 0 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a negative spin count.", function() {
+        try {
+            nPool.createThreadPool(2, { spinCount: -1 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a maximum number of threads below the number of threads.", function() {
+        try {
+            nPool.createThreadPool(4, { maxThreads: 2 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a minimum number of threads above the number of threads.", function() {
+        try {
+            nPool.createThreadPool(2, { minThreads: 4 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for an elastic work stealing pool.", function() {
+        try {
+            nPool.createThreadPool(2, { scheduler: "workStealing", maxThreads: 8 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for an elastic affinity pool.", function() {
+        try {
+            nPool.createThreadPool(2, { scheduler: "affinity", minThreads: 1 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a fair queue with the work stealing scheduler.", function() {
+        try {
+            nPool.createThreadPool(2, { queueType: "fair", scheduler: "workStealing" });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a bounded task queue with the work stealing scheduler.", function() {
+        try {
+            nPool.createThreadPool(2, { scheduler: "workStealing", queueCapacity: 100 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a drain callback with the work stealing scheduler.", function() {
+        try {
+            nPool.createThreadPool(2, { scheduler: "workStealing", drainCallback: function() {} });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a bounded task queue with the affinity scheduler.", function() {
+        try {
+            nPool.createThreadPool(2, { scheduler: "affinity", queueCapacity: 100 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for an affinity wait time without the affinity scheduler.", function() {
+        try {
+            nPool.createThreadPool(2, { affinityWaitMs: 10 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a zero affinity wait time.", function() {
+        try {
+            nPool.createThreadPool(2, { scheduler: "affinity", affinityWaitMs: 0 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for an empty thread pool name.", function() {
+        try {
+            nPool.createThreadPool(2, { name: "" });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for unknown affinity.", function() {
+        try {
+            nPool.createThreadPool(2, { affinity: "random" });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for an empty processor set.", function() {
+        try {
+            nPool.createThreadPool(2, { cpus: [] });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a stack size below the minimum.", function() {
+        try {
+            nPool.createThreadPool(2, { stackSize: 1024 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a thread name longer than 15 characters.", function() {
+        try {
+            nPool.createThreadPool(2, { threadName: "a-very-long-thread-name" });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a non-boolean batch callbacks option.", function() {
+        try {
+            nPool.createThreadPool(2, { batchCallbacks: "yes" });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for non-object options.", function() {
+        try {
+            nPool.createThreadPool(2, "ring");
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+});
@@ -33,6 +33,150 @@ describe("destroyThreadPool() shall execute without throwing an exception when c
     });
 });
 
+describe("destroyThreadPool() shall destroy only the thread pool it is given.", function() {
+
+    it("Destroyed a named thread pool by handle and by name.", function() {
+        var latencyPool = nPool.createThreadPool(1, { name: "latency" });
+        nPool.createThreadPool(2, { name: "batch" });
+
+        nPool.destroyThreadPool(latencyPool);
+        nPool.destroyThreadPool("batch");
+
+        // the handles are no longer valid
+        var thrownException = null;
+        try {
+            nPool.destroyThreadPool(latencyPool);
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+});
+
+describe("destroyThreadPool() shall deliver every queued unit of work before a draining pool is destroyed.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+    });
+
+    after(function() {
+        nPool.removeFile(1);
+    });
+
+    var createUnitOfWork = function(workId, fibNumber, callbackFunction) {
+        return {
+            workId: workId,
+            fileKey: 1,
+            workFunction: "calcFibonacciNumber",
+            workParam: {
+                fibNumber: fibNumber
+            },
+            callbackFunction: callbackFunction,
+            callbackContext: this
+        };
+    };
+
+    it("Called every work callback and then the destroy callback.", function(done) {
+        this.timeout(10000);
+
+        var numCallbacks = 0;
+        var workCallback = function(callbackObject, workId, exceptionObject) {
+            numCallbacks++;
+        };
+
+        nPool.createThreadPool(1, { name: "drain" });
+        for(var i = 0; i < 20; i++) {
+            nPool.queueWork(createUnitOfWork(i, 25, workCallback), "drain");
+        }
+
+        nPool.destroyThreadPool({ drain: true, callback: function(drained) {
+            try {
+                assert.equal(drained, true);
+                assert.equal(numCallbacks, 20);
+
+                // the pool no longer exists
+                var thrownException = null;
+                try {
+                    nPool.destroyThreadPool("drain");
+                }
+                catch(exception) {
+                    thrownException = exception;
+                }
+                assert.notEqual(thrownException, null);
+                done();
+            }
+            catch(exception) {
+                done(exception);
+            }
+        }}, "drain");
+
+        // the pool rejects work while it drains
+        var thrownException = null;
+        try {
+            nPool.queueWork(createUnitOfWork(20, 1, workCallback), "drain");
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Called the destroy callback of an idle pool.", function(done) {
+        nPool.createThreadPool(1, { name: "idle" });
+        nPool.destroyThreadPool({ drain: true, callback: function(drained) {
+            assert.equal(drained, true);
+            done();
+        }}, "idle");
+    });
+
+    it("Reported a drain that timed out.", function(done) {
+        this.timeout(10000);
+
+        nPool.createThreadPool(1, { name: "timeout", timeoutMs: 1000 });
+        nPool.queueWork(createUnitOfWork(1, 40, function() {}), "timeout");
+        nPool.queueWork(createUnitOfWork(2, 40, function() {}), "timeout");
+
+        nPool.destroyThreadPool({ drain: true, timeoutMs: 100, callback: function(drained) {
+            assert.equal(drained, false);
+            done();
+        }}, "timeout");
+    });
+});
+
+describe("destroyThreadPool() shall throw an exception when passed invalid options.", function() {
+
+    before(function() {
+        nPool.createThreadPool(1, { name: "options" });
+    });
+
+    after(function() {
+        nPool.destroyThreadPool("options");
+    });
+
+    it("Exception thrown for a timeout without drain.", function() {
+        var thrownException = null;
+        try {
+            nPool.destroyThreadPool({ timeoutMs: 100 }, "options");
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a callback that is not a function.", function() {
+        var thrownException = null;
+        try {
+            nPool.destroyThreadPool({ drain: true, callback: 1 }, "options");
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+});
+
 describe("destroyThreadPool() shall throw an exception when called and a thread pool does not exist.", function() {
 
     it("Exception thrown when called and a thread pool doesn't exist.", function() {
@@ -0,0 +1,176 @@
+var assert = require("assert");
+
+// load appropriate npool module
+var nPool = null;
+try {
+    nPool = require(__dirname + '/../build/Release/npool');
+}
+catch (e) {
+    nPool = require(__dirname + '/../build/Debug/npool');
+}
+
+describe("[ getStats() - Tests ]", function() {
+    it("OK", function() {
+        assert.notEqual(nPool, undefined);
+    });
+});
+
+function createUnitOfWork(workId, callbackFunction, callbackContext) {
+    return {
+        workId: workId,
+        fileKey: 1,
+        workFunction: "calcFibonacciNumber",
+        workParam: {
+            fibNumber: 10
+        },
+
+        callbackFunction: callbackFunction,
+        callbackContext: callbackContext
+    };
+}
+
+describe("getStats() shall report the delivery of callbacks of a thread pool.", function() {
+
+    beforeEach(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+        nPool.createThreadPool(1, { maxCallbacksPerTick: 1 });
+        nPool.createThreadPool(2, { name: "timed", maxCallbackTimeUs: 100 });
+        nPool.createThreadPool(4, { name: "limited", maxCallbacksPerTick: 1 });
+    });
+
+    afterEach(function() {
+        nPool.destroyThreadPool();
+        nPool.destroyThreadPool("timed");
+        nPool.destroyThreadPool("limited");
+        nPool.removeFile(1);
+    });
+
+    it("Reported no callbacks before any unit of work completed.", function() {
+        var stats = nPool.getStats();
+        assert.equal(stats.threads, 1);
+        assert.equal(stats.pendingCallbacks, 0);
+        assert.equal(stats.callbacks, 0);
+        assert.equal(stats.deferrals, 0);
+        assert.equal(stats.callbackLagMs, 0);
+        assert.equal(stats.maxCallbackLagMs, 0);
+    });
+
+    it("Delivered every unit of work in order one callback per tick.", function(done) {
+        var numUnits = 100;
+        var lastWorkId = 0;
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        var callbackFunction = function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(exceptionObject, null);
+                assert.equal(callbackObject.fibCalcResult, 55);
+                assert.equal(workId, lastWorkId + 1);
+                lastWorkId = workId;
+                if(workId == numUnits) {
+                    var stats = nPool.getStats();
+                    assert.equal(stats.pendingCallbacks, 0);
+                    assert.equal(stats.callbacks, numUnits);
+                    assert.ok(stats.maxCallbackLagMs >= stats.callbackLagMs);
+                    done();
+                }
+            }
+            catch(exception) {
+                done(exception);
+            }
+        };
+
+        for(var i = 1; i <= numUnits; i++) {
+            nPool.queueWork(createUnitOfWork(i, callbackFunction, this));
+        }
+    });
+
+    it("Delivered every unit of work of a pool limited by time.", function(done) {
+        var numUnits = 100;
+        var numCompleted = 0;
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        var callbackFunction = function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(exceptionObject, null);
+                if(++numCompleted == numUnits) {
+                    var stats = nPool.getStats("timed");
+                    assert.equal(stats.threads, 2);
+                    assert.equal(stats.pendingCallbacks, 0);
+                    assert.equal(stats.callbacks, numUnits);
+                    done();
+                }
+            }
+            catch(exception) {
+                done(exception);
+            }
+        };
+
+        for(var i = 1; i <= numUnits; i++) {
+            nPool.queueWork(createUnitOfWork(i, callbackFunction, this), "timed");
+        }
+    });
+
+    it("Delivered one callback per tick of a pool whichever thread completed the unit of work.", function(done) {
+        var numUnits = 100;
+        var numCompleted = 0;
+        var tickCallbacks = 0;
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        var callbackFunction = function(callbackObject, workId, exceptionObject) {
+            try {
+                // the count is reset once the callbacks of this iteration of the event loop were made
+                if(tickCallbacks++ == 0) {
+                    setImmediate(function() {
+                        tickCallbacks = 0;
+                    });
+                }
+                assert.equal(tickCallbacks, 1);
+                assert.equal(exceptionObject, null);
+                if(++numCompleted == numUnits) {
+                    var stats = nPool.getStats("limited");
+                    assert.equal(stats.threads, 4);
+                    assert.equal(stats.callbacks, numUnits);
+                    done();
+                }
+            }
+            catch(exception) {
+                done(exception);
+            }
+        };
+
+        for(var i = 1; i <= numUnits; i++) {
+            nPool.queueWork(createUnitOfWork(i, callbackFunction, this), "limited");
+        }
+    });
+});
+
+describe("getStats() shall throw an exception when passed an invalid argument.", function() {
+
+    it("Exception thrown for a pool that does not exist.", function() {
+        var thrownException = null;
+        try {
+            nPool.getStats("missing");
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a non-integer callback limit.", function() {
+        var thrownException = null;
+        try {
+            nPool.createThreadPool(1, { maxCallbacksPerTick: "one" });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+});
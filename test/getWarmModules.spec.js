@@ -0,0 +1,90 @@
+var assert = require("assert");
+
+// load appropriate npool module
+var nPool = null;
+try {
+    nPool = require(__dirname + '/../build/Release/npool');
+}
+catch (e) {
+    nPool = require(__dirname + '/../build/Debug/npool');
+}
+
+describe("[ getWarmModules() - Tests ]", function() {
+    it("OK", function() {
+        assert.notEqual(nPool, undefined);
+    });
+});
+
+describe("getWarmModules() shall report the loaded files executed by each thread.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+        nPool.createThreadPool(2, { scheduler: "affinity" });
+        nPool.createThreadPool(2, { name: "shared" });
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.destroyThreadPool("shared");
+        nPool.removeFile(1);
+    });
+
+    var createUnitOfWork = function(workId, callbackFunction) {
+        return {
+            workId: workId,
+            fileKey: 1,
+            workFunction: "calcFibonacciNumber",
+            workParam: {
+                fibNumber: 10
+            },
+            callbackFunction: callbackFunction,
+            callbackContext: this
+        };
+    };
+
+    it("Reported one entry per thread before any unit of work executed.", function() {
+        assert.deepEqual(nPool.getWarmModules(), [[], []]);
+    });
+
+    it("Reported the file key on the thread that executed units of work one at a time.", function(done) {
+        var numCallbacks = 0;
+        var callbackFunction = function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(exceptionObject, null);
+                if(++numCallbacks < 10) {
+                    nPool.queueWork(createUnitOfWork(numCallbacks + 1, callbackFunction));
+                    return;
+                }
+
+                // every unit of work after the first was routed to the thread it warmed
+                var warmModules = nPool.getWarmModules();
+                assert.equal(warmModules.length, 2);
+                assert.deepEqual(warmModules[0].concat(warmModules[1]), [1]);
+                done();
+            }
+            catch(exception) {
+                done(exception);
+            }
+        };
+
+        nPool.queueWork(createUnitOfWork(1, callbackFunction));
+    });
+
+    it("Reported empty entries for a pool using the shared scheduler.", function() {
+        assert.deepEqual(nPool.getWarmModules("shared"), [[], []]);
+    });
+});
+
+describe("getWarmModules() shall throw an exception when passed an invalid argument.", function() {
+
+    it("Exception thrown for a pool that does not exist.", function() {
+        var thrownException = null;
+        try {
+            nPool.getWarmModules("missing");
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+});
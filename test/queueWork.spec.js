@@ -230,3 +230,823 @@ describe("queueWork() shall execute without throwing an exception when a using s
         }
     });
 });
+
+describe("queueWork() shall execute without throwing an exception when multiple valid units of work are queued to a ring queue.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+        nPool.createThreadPool(4, { queueType: "ring", queueCapacity: 128 });
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Executed all units of work without throwing an exception and returned valid results.", function(done) {
+        var totalExecutions = 0;
+        var thrownException = null;
+        var assertionException = null;
+
+        // test for total execution count
+        var executionIterations = 100;
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        // execute the tests
+        for(var i = 0; i < executionIterations; i++) {
+
+            var unitOfWork = {
+                workId: i,
+                fileKey: 1,
+                workFunction: "calcFibonacciNumber",
+                workParam: {
+                    fibNumber: 10
+                },
+
+                callbackFunction: function(callbackObject, workId, exceptionObject) {
+                    try {
+                        assert.equal(thrownException, null);
+                        assert.equal(callbackObject.fibCalcResult, 55);
+                        assert.equal(exceptionObject, null);
+                    }
+                    catch(exception) {
+                        assertionException = exception;
+                    }
+
+                    // wait until all executions occur
+                    if(++totalExecutions == executionIterations) {
+                        done(assertionException);
+                    }
+                },
+                callbackContext: this
+            };
+
+            try
+            {
+                nPool.queueWork(unitOfWork);
+            }
+            catch (exception) {
+                thrownException = exception;
+            }
+        }
+    });
+});
+
+describe("queueWork() shall execute without throwing an exception when multiple valid units of work are queued to a work stealing thread pool.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+        nPool.createThreadPool(4, { scheduler: "workStealing" });
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Executed all units of work without throwing an exception and returned valid results.", function(done) {
+        var totalExecutions = 0;
+        var thrownException = null;
+        var assertionException = null;
+
+        // test for total execution count
+        var executionIterations = 1000;
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        // execute the tests
+        for(var i = 0; i < executionIterations; i++) {
+
+            var unitOfWork = {
+                workId: i,
+                fileKey: 1,
+                workFunction: "calcFibonacciNumber",
+                workParam: {
+                    fibNumber: 10
+                },
+
+                callbackFunction: function(callbackObject, workId, exceptionObject) {
+                    try {
+                        assert.equal(thrownException, null);
+                        assert.equal(callbackObject.fibCalcResult, 55);
+                        assert.equal(exceptionObject, null);
+                    }
+                    catch(exception) {
+                        assertionException = exception;
+                    }
+
+                    // wait until all executions occur
+                    if(++totalExecutions == executionIterations) {
+                        done(assertionException);
+                    }
+                },
+                callbackContext: this
+            };
+
+            try
+            {
+                nPool.queueWork(unitOfWork);
+            }
+            catch (exception) {
+                thrownException = exception;
+            }
+        }
+    });
+});
+
+describe("queueWork() shall return false when a ring queue is full.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/helloWorld.js');
+
+        // no threads so the queue is never consumed
+        nPool.createThreadPool(0, { queueType: "ring", queueCapacity: 2 });
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Returned false when the queue capacity is exceeded.", function() {
+        var unitOfWork = {
+            workId: 1,
+            fileKey: 1,
+            workFunction: "sayHelloWorld",
+            workParam: {
+                testString: '- queueWork() - Test In Progress'
+            },
+
+            callbackFunction: function(callbackObject, workId, exceptionObject) { },
+            callbackContext: this
+        };
+
+        assert.strictEqual(nPool.queueWork(unitOfWork), true);
+        assert.strictEqual(nPool.queueWork(unitOfWork), true);
+        assert.strictEqual(nPool.queueWork(unitOfWork), false);
+    });
+});
+
+describe("queueWork() shall return false when a bounded list queue is full.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/helloWorld.js');
+
+        // no threads so the queue is never consumed
+        nPool.createThreadPool(0, { queueType: "list", queueCapacity: 3 });
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Returned false when the queue capacity is exceeded.", function() {
+        var unitOfWork = {
+            workId: 1,
+            fileKey: 1,
+            workFunction: "sayHelloWorld",
+            workParam: {
+                testString: '- queueWork() - Test In Progress'
+            },
+
+            callbackFunction: function(callbackObject, workId, exceptionObject) { },
+            callbackContext: this
+        };
+
+        for(var i = 0; i < 3; i++) {
+            assert.strictEqual(nPool.queueWork(unitOfWork), true);
+        }
+        assert.strictEqual(nPool.queueWork(unitOfWork), false);
+    });
+});
+
+describe("queueWork() shall call the drain callback after a full task queue drains.", function() {
+    var drainHandler = null;
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+        nPool.createThreadPool(1, {
+            queueCapacity: 2,
+            queueLowWaterMark: 0,
+            drainCallback: function() {
+                drainHandler();
+            }
+        });
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Drain callback called once the rejected queue emptied.", function(done) {
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        drainHandler = function() {
+            done();
+        };
+
+        var unitOfWork = {
+            workId: 1,
+            fileKey: 1,
+            workFunction: "calcFibonacciNumber",
+            workParam: {
+                fibNumber: 25
+            },
+
+            callbackFunction: function(callbackObject, workId, exceptionObject) { },
+            callbackContext: this
+        };
+
+        // fill the queue until work is rejected
+        var queued = 0;
+        while(nPool.queueWork(unitOfWork)) {
+            queued++;
+            assert.ok(queued < 100);
+        }
+    });
+});
+
+describe("queueWork() shall execute units of work in priority order.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+        nPool.createThreadPool(1);
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Executed the high priority unit of work before the low priority unit of work.", function(done) {
+        var completedIds = [];
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        var callbackFunction = function(callbackObject, workId, exceptionObject) {
+            completedIds.push(workId);
+            if(completedIds.length == 3) {
+                try {
+                    assert.ok(completedIds.indexOf(3) < completedIds.indexOf(2));
+                    done();
+                }
+                catch(exception) {
+                    done(exception);
+                }
+            }
+        };
+
+        // occupy the only thread, then queue low and high priority work behind it
+        var priorities = [ 4, 7, 0 ];
+        for(var i = 0; i < priorities.length; i++) {
+            nPool.queueWork({
+                workId: i + 1,
+                fileKey: 1,
+                workFunction: "calcFibonacciNumber",
+                workParam: {
+                    fibNumber: 25
+                },
+                priority: priorities[i],
+
+                callbackFunction: callbackFunction,
+                callbackContext: this
+            });
+        }
+    });
+
+    it("Exception thrown for a non-integer priority.", function() {
+        var thrownException = null;
+        try {
+            nPool.queueWork({
+                workId: 1,
+                fileKey: 1,
+                workFunction: "calcFibonacciNumber",
+                workParam: {
+                    fibNumber: 1
+                },
+                priority: "high",
+
+                callbackFunction: function() { },
+                callbackContext: this
+            });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+});
+
+describe("queueWork() shall execute units of work on the thread pool they are queued to.", function() {
+    var fastPool = null;
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+
+        // a pool without threads never executes its units of work
+        nPool.createThreadPool(0, { name: "stalled" });
+        fastPool = nPool.createThreadPool(2, { name: "fast" });
+    });
+
+    after(function() {
+        nPool.destroyThreadPool("stalled");
+        nPool.destroyThreadPool(fastPool);
+        nPool.removeFile(1);
+    });
+
+    it("Executed the unit of work of one pool while the other pool is stalled.", function(done) {
+        var createUnitOfWork = function(workId) {
+            return {
+                workId: workId,
+                fileKey: 1,
+                workFunction: "calcFibonacciNumber",
+                workParam: {
+                    fibNumber: 10
+                },
+
+                callbackFunction: function(callbackObject, workId, exceptionObject) {
+                    try {
+                        assert.equal(workId, 2);
+                        assert.equal(callbackObject.fibCalcResult, 55);
+                        assert.equal(exceptionObject, null);
+                        done();
+                    }
+                    catch(exception) {
+                        done(exception);
+                    }
+                },
+                callbackContext: this
+            };
+        };
+
+        assert.equal(nPool.queueWork(createUnitOfWork(1), "stalled"), true);
+        assert.equal(nPool.queueWork(createUnitOfWork(2), fastPool), true);
+    });
+});
+
+describe("queueWork() shall throw an exception when the thread pool does not exist.", function() {
+
+    it("Exception thrown for an unknown pool name.", function() {
+        var thrownException = null;
+        nPool.createThreadPool(1);
+        try {
+            nPool.queueWork({
+                workId: 1,
+                fileKey: 1,
+                workFunction: "calcFibonacciNumber",
+                workParam: { fibNumber: 10 },
+                callbackFunction: function(callbackObject, workId, exceptionObject) { },
+                callbackContext: this
+            }, "unknown");
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        nPool.destroyThreadPool();
+        assert.notEqual(thrownException, null);
+    });
+});
+
+describe("queueWork() shall execute the continuations of a unit of work on its result.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/graphModule.js');
+        nPool.createThreadPool(2);
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Delivered the result of the last continuation.", function(done) {
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        var isQueued = nPool.queueWork({
+            workId: 1,
+            fileKey: 1,
+            workFunction: "value",
+            workParam: { value: 3 },
+            then: {
+                fileKey: 1,
+                workFunction: "add",
+                workParam: { offset: 4 },
+                then: { fileKey: 1, workFunction: "add", workParam: { offset: 5 } }
+            },
+
+            callbackFunction: function(callbackObject, workId, exceptionObject) {
+                try {
+                    assert.equal(exceptionObject, null);
+                    assert.equal(workId, 1);
+                    assert.deepEqual(callbackObject, { value: 12 });
+                    done();
+                }
+                catch(exception) {
+                    done(exception);
+                }
+            },
+            callbackContext: this
+        });
+        assert.equal(isQueued, true);
+    });
+
+    it("Delivered the exception of a failed continuation.", function(done) {
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        nPool.queueWork({
+            workId: 2,
+            fileKey: 1,
+            workFunction: "value",
+            workParam: { value: 3 },
+            then: {
+                fileKey: 1,
+                workFunction: "fail",
+                then: { fileKey: 1, workFunction: "add" }
+            },
+
+            callbackFunction: function(callbackObject, workId, exceptionObject) {
+                try {
+                    assert.equal(callbackObject, null);
+                    assert.notEqual(exceptionObject.message.indexOf("Graph node failed"), -1);
+                    done();
+                }
+                catch(exception) {
+                    done(exception);
+                }
+            },
+            callbackContext: this
+        });
+    });
+
+    it("Exception thrown for a continuation that is not an object.", function() {
+        var thrownException = null;
+        try {
+            nPool.queueWork({
+                workId: 3,
+                fileKey: 1,
+                workFunction: "value",
+                workParam: { value: 3 },
+                then: "add",
+                callbackFunction: function() {},
+                callbackContext: this
+            });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+});
+
+describe("queueWork() shall execute delayed and periodic units of work once they are due.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/graphModule.js');
+        nPool.createThreadPool(2);
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Executed the units of work in the order of their delays.", function(done) {
+        var delays = [300, 100, 200];
+        var results = [];
+        var startTime = Date.now();
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        var callbackFunction = function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(exceptionObject, null);
+                assert.ok(Date.now() - startTime >= delays[workId - 1] - 1);
+                results.push(callbackObject.value);
+                if(results.length == delays.length) {
+                    assert.deepEqual(results, [100, 200, 300]);
+                    done();
+                }
+            }
+            catch(exception) {
+                done(exception);
+            }
+        };
+
+        for(var i = 0; i < delays.length; i++) {
+            var isQueued = nPool.queueWork({
+                workId: i + 1,
+                fileKey: 1,
+                workFunction: "value",
+                workParam: { value: delays[i] },
+                delayMs: delays[i],
+                callbackFunction: callbackFunction,
+                callbackContext: this
+            });
+            assert.equal(isQueued, true);
+        }
+    });
+
+    it("Executed a periodic unit of work until it was cancelled.", function(done) {
+        var numRuns = 0;
+        var startTime = Date.now();
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        nPool.queueWork({
+            workId: 10,
+            fileKey: 1,
+            workFunction: "value",
+            workParam: { value: 10 },
+            intervalMs: 50,
+
+            callbackFunction: function(callbackObject, workId, exceptionObject) {
+                try {
+                    numRuns++;
+                    if(numRuns <= 3) {
+                        assert.equal(exceptionObject, null);
+                        assert.equal(callbackObject.value, 10);
+
+                        // runs are due at a fixed rate, the first one after an interval
+                        assert.ok(Date.now() - startTime >= (numRuns * 50) - 1);
+                        if(numRuns == 3) {
+                            assert.equal(nPool.cancel(10), true);
+                            setTimeout(function() {
+                                assert.equal(numRuns, 3);
+                                done();
+                            }, 200);
+                        }
+                    }
+                }
+                catch(exception) {
+                    done(exception);
+                }
+            },
+            callbackContext: this
+        });
+    });
+
+    it("Delivered the cancellation of a delayed unit of work without waiting for its delay.", function(done) {
+        var startTime = Date.now();
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        nPool.queueWork({
+            workId: 20,
+            fileKey: 1,
+            workFunction: "value",
+            workParam: { value: 20 },
+            delayMs: 60000,
+
+            callbackFunction: function(callbackObject, workId, exceptionObject) {
+                try {
+                    assert.equal(callbackObject, null);
+                    assert.equal(exceptionObject.cancelled, true);
+                    assert.ok(Date.now() - startTime < 1000);
+                    done();
+                }
+                catch(exception) {
+                    done(exception);
+                }
+            },
+            callbackContext: this
+        });
+        assert.equal(nPool.cancel(20), true);
+    });
+
+    it("Exception thrown for a non-integer delay.", function() {
+        var thrownException = null;
+        try {
+            nPool.queueWork({
+                workId: 30,
+                fileKey: 1,
+                workFunction: "value",
+                workParam: { value: 30 },
+                delayMs: "soon",
+                callbackFunction: function() {},
+                callbackContext: this
+            });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a periodic unit of work with a continuation.", function() {
+        var thrownException = null;
+        try {
+            nPool.queueWork({
+                workId: 31,
+                fileKey: 1,
+                workFunction: "value",
+                workParam: { value: 31 },
+                intervalMs: 100,
+                then: { fileKey: 1, workFunction: "add" },
+                callbackFunction: function() {},
+                callbackContext: this
+            });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+});
+
+describe("queueWork() shall deliver the units of work sharing a callback function in arrays when callbacks are batched.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/graphModule.js');
+        nPool.createThreadPool(1, { batchCallbacks: true, maxCallbacksPerTick: 10 });
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    var createUnitOfWork = function(workId, callbackFunction, callbackContext) {
+        return {
+            workId: workId,
+            fileKey: 1,
+            workFunction: "value",
+            workParam: { value: workId * 10 },
+            callbackFunction: callbackFunction,
+            callbackContext: callbackContext
+        };
+    };
+
+    it("Delivered every unit of work in order with its result, work id and exception at the same index.", function(done) {
+        var numUnits = 100;
+        var lastWorkId = 0;
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        var callbackFunction = function(callbackObjects, workIds, exceptionObjects) {
+            try {
+                assert.ok(Array.isArray(workIds));
+                assert.equal(callbackObjects.length, workIds.length);
+                assert.equal(exceptionObjects.length, workIds.length);
+
+                // each unit of work counts against the callback budget
+                assert.ok(workIds.length >= 1 && workIds.length <= 10);
+                for(var i = 0; i < workIds.length; i++) {
+                    assert.equal(workIds[i], lastWorkId + 1);
+                    assert.equal(exceptionObjects[i], null);
+                    assert.equal(callbackObjects[i].value, workIds[i] * 10);
+                    lastWorkId = workIds[i];
+                }
+                if(lastWorkId == numUnits) {
+                    assert.equal(nPool.getStats().callbacks, numUnits);
+                    done();
+                }
+            }
+            catch(exception) {
+                done(exception);
+            }
+        };
+
+        for(var i = 1; i <= numUnits; i++) {
+            nPool.queueWork(createUnitOfWork(i, callbackFunction, this));
+        }
+    });
+
+    it("Delivered units of work with different callback functions by separate calls.", function(done) {
+        var numUnits = 20;
+        var numDelivered = [0, 0];
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        var createCallbackFunction = function(functionIndex) {
+            return function(callbackObjects, workIds, exceptionObjects) {
+                try {
+                    for(var i = 0; i < workIds.length; i++) {
+                        assert.equal(workIds[i] % 2, functionIndex);
+                        assert.equal(exceptionObjects[i], null);
+                    }
+                    numDelivered[functionIndex] += workIds.length;
+                    if(numDelivered[0] + numDelivered[1] == numUnits) {
+                        assert.deepEqual(numDelivered, [numUnits / 2, numUnits / 2]);
+                        done();
+                    }
+                }
+                catch(exception) {
+                    done(exception);
+                }
+            };
+        };
+        var callbackFunctions = [createCallbackFunction(0), createCallbackFunction(1)];
+
+        for(var i = 1; i <= numUnits; i++) {
+            nPool.queueWork(createUnitOfWork(i, callbackFunctions[i % 2], this));
+        }
+    });
+});
+
+describe("queueWork() shall deliver the partial results a unit of work emits ahead of its callback.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/progressModule.js');
+        nPool.createThreadPool(2);
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Delivered every partial result in order before the callback.", function(done) {
+        var numChunks = 500;
+        var partials = [];
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        nPool.queueWork({
+            workId: 1,
+            fileKey: 1,
+            workFunction: "stream",
+            workParam: { numChunks: numChunks },
+            progressBufferSize: 4,
+
+            progressFunction: function(partial, workId) {
+                partials.push(partial.index);
+            },
+            callbackFunction: function(callbackObject, workId, exceptionObject) {
+                try {
+                    assert.equal(exceptionObject, null);
+                    assert.equal(callbackObject.numEmitted, numChunks);
+                    assert.equal(partials.length, numChunks);
+                    for(var i = 0; i < numChunks; i++) {
+                        assert.equal(partials[i], i);
+                    }
+                    done();
+                }
+                catch(exception) {
+                    done(exception);
+                }
+            },
+            callbackContext: this
+        });
+    });
+
+    it("Discarded the partial results of a unit of work without a progress function.", function(done) {
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        nPool.queueWork({
+            workId: 2,
+            fileKey: 1,
+            workFunction: "stream",
+            workParam: { numChunks: 10 },
+
+            callbackFunction: function(callbackObject, workId, exceptionObject) {
+                try {
+                    assert.equal(exceptionObject, null);
+                    assert.equal(callbackObject.numEmitted, 0);
+                    done();
+                }
+                catch(exception) {
+                    done(exception);
+                }
+            },
+            callbackContext: this
+        });
+    });
+
+    it("Exception thrown for a zero progress buffer size.", function() {
+        var thrownException = null;
+        try {
+            nPool.queueWork({
+                workId: 3,
+                fileKey: 1,
+                workFunction: "stream",
+                workParam: { numChunks: 1 },
+                progressFunction: function() {},
+                progressBufferSize: 0,
+                callbackFunction: function() {},
+                callbackContext: this
+            });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+});
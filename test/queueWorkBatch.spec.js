@@ -0,0 +1,188 @@
+var assert = require("assert");
+
+// load appropriate npool module
+var nPool = null;
+try {
+    nPool = require(__dirname + '/../build/Release/npool');
+}
+catch (e) {
+    nPool = require(__dirname + '/../build/Debug/npool');
+}
+
+describe("[ queueWorkBatch() - Tests ]", function() {
+    it("OK", function() {
+        assert.notEqual(nPool, undefined);
+    });
+});
+
+function createUnitsOfWork(numUnits, callbackFunction, callbackContext) {
+    var unitsOfWork = [];
+    for(var i = 0; i < numUnits; i++) {
+        unitsOfWork.push({
+            workId: i + 1,
+            fileKey: 1,
+            workFunction: "calcFibonacciNumber",
+            workParam: {
+                fibNumber: 10
+            },
+
+            callbackFunction: callbackFunction,
+            callbackContext: callbackContext
+        });
+    }
+    return unitsOfWork;
+}
+
+describe("queueWorkBatch() shall execute every unit of work of a valid batch.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+        nPool.createThreadPool(4);
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Executed every unit of work and returned valid results.", function(done) {
+        var numUnits = 500;
+        var completedIds = {};
+        var numCompleted = 0;
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        var callbackFunction = function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(exceptionObject, null);
+                assert.equal(callbackObject.fibCalcResult, 55);
+                assert.equal(completedIds[workId], undefined);
+            }
+            catch(exception) {
+                return done(exception);
+            }
+
+            completedIds[workId] = true;
+            if(++numCompleted == numUnits) {
+                done();
+            }
+        };
+
+        assert.equal(nPool.queueWorkBatch(createUnitsOfWork(numUnits, callbackFunction, this)), numUnits);
+    });
+});
+
+describe("queueWorkBatch() shall execute every unit of work of a valid batch with the work stealing scheduler.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+        nPool.createThreadPool(4, { scheduler: "workStealing" });
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Executed every unit of work.", function(done) {
+        var numUnits = 2000;
+        var numCompleted = 0;
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        var callbackFunction = function(callbackObject, workId, exceptionObject) {
+            if(++numCompleted == numUnits) {
+                done();
+            }
+        };
+
+        assert.equal(nPool.queueWorkBatch(createUnitsOfWork(numUnits, callbackFunction, this)), numUnits);
+    });
+});
+
+describe("queueWorkBatch() shall execute every unit of work when threads take one unit of work at a time.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+        nPool.createThreadPool(2, { maxBatchSize: 1 });
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Executed every unit of work.", function(done) {
+        var numUnits = 200;
+        var numCompleted = 0;
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        var callbackFunction = function(callbackObject, workId, exceptionObject) {
+            if(++numCompleted == numUnits) {
+                done();
+            }
+        };
+
+        assert.equal(nPool.queueWorkBatch(createUnitsOfWork(numUnits, callbackFunction, this)), numUnits);
+    });
+});
+
+describe("queueWorkBatch() shall only queue the units of work that fit within a bounded task queue.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+
+        // no threads so the queue is never consumed
+        nPool.createThreadPool(0, { queueCapacity: 8 });
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Returned the number of units of work queued.", function() {
+        assert.equal(nPool.queueWorkBatch(createUnitsOfWork(5, function() { }, this)), 5);
+        assert.equal(nPool.queueWorkBatch(createUnitsOfWork(5, function() { }, this)), 3);
+        assert.equal(nPool.queueWorkBatch(createUnitsOfWork(5, function() { }, this)), 0);
+    });
+});
+
+describe("queueWorkBatch() shall throw an exception when given invalid parameters.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+        nPool.createThreadPool(1);
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Exception thrown when the parameter is not an array.", function() {
+        assert.throws(function() {
+            nPool.queueWorkBatch({});
+        });
+    });
+
+    it("Exception thrown when a unit of work is malformed.", function() {
+        var unitsOfWork = createUnitsOfWork(3, function() { }, this);
+        unitsOfWork[1] = 5;
+        assert.throws(function() {
+            nPool.queueWorkBatch(unitsOfWork);
+        });
+    });
+
+    it("Exception thrown when a unit of work is delayed.", function() {
+        var unitsOfWork = createUnitsOfWork(3, function() { }, this);
+        unitsOfWork[2].delayMs = 100;
+        assert.throws(function() {
+            nPool.queueWorkBatch(unitsOfWork);
+        });
+    });
+});
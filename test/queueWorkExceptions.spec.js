@@ -352,3 +352,82 @@ describe("queueWork() shall complete the callback with an exception object when
         }
     });
 });
+
+describe("queueWork() shall report a timeout error when a unit of work executes longer than its timeout.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+        nPool.createThreadPool(1, { timeoutMs: 200 });
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    var createUnitOfWork = function(workId, fibNumber, timeoutMs, callbackFunction) {
+        return {
+            workId: workId,
+            fileKey: 1,
+            workFunction: "calcFibonacciNumber",
+            workParam: {
+                fibNumber: fibNumber
+            },
+            timeoutMs: timeoutMs,
+            callbackFunction: callbackFunction,
+            callbackContext: this
+        };
+    };
+
+    it("Terminated a unit of work that exceeded the pool's default timeout.", function(done) {
+        this.timeout(10000);
+        nPool.queueWork(createUnitOfWork(1, 60, undefined, function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(callbackObject, null);
+                assert.equal(workId, 1);
+                assert.equal(exceptionObject.timedOut, true);
+                done();
+            }
+            catch(exception) {
+                done(exception);
+            }
+        }));
+    });
+
+    it("Terminated a unit of work that exceeded its own timeout.", function(done) {
+        this.timeout(10000);
+        nPool.queueWork(createUnitOfWork(2, 60, 50, function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(exceptionObject.timedOut, true);
+                done();
+            }
+            catch(exception) {
+                done(exception);
+            }
+        }));
+    });
+
+    it("Executed a unit of work on the thread of a terminated unit of work.", function(done) {
+        nPool.queueWork(createUnitOfWork(3, 10, undefined, function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(callbackObject.fibCalcResult, 55);
+                assert.equal(exceptionObject, null);
+                done();
+            }
+            catch(exception) {
+                done(exception);
+            }
+        }));
+    });
+
+    it("Exception thrown for a malformed timeout.", function() {
+        var thrownException = null;
+        try {
+            nPool.queueWork(createUnitOfWork(4, 10, -1, function() { }));
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+});
@@ -0,0 +1,181 @@
+var assert = require("assert");
+
+// load appropriate npool module
+var nPool = null;
+try {
+    nPool = require(__dirname + '/../build/Release/npool');
+}
+catch (e) {
+    nPool = require(__dirname + '/../build/Debug/npool');
+}
+
+describe("[ resize() - Tests ]", function() {
+    it("OK", function() {
+        assert.notEqual(nPool, undefined);
+    });
+});
+
+function queueUnitsOfWork(numUnits, callbackFunction, callbackContext) {
+    for(var i = 0; i < numUnits; i++) {
+        nPool.queueWork({
+            workId: i + 1,
+            fileKey: 1,
+            workFunction: "calcFibonacciNumber",
+            workParam: {
+                fibNumber: 10
+            },
+
+            callbackFunction: callbackFunction,
+            callbackContext: callbackContext
+        });
+    }
+}
+
+describe("resize() shall keep executing units of work after the thread pool grows and shrinks.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+        nPool.createThreadPool(2, { maxThreads: 8 });
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Executed every unit of work while resizing.", function(done) {
+        var numUnits = 300;
+        var numCompleted = 0;
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        var callbackFunction = function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(exceptionObject, null);
+                assert.equal(callbackObject.fibCalcResult, 55);
+            }
+            catch(exception) {
+                return done(exception);
+            }
+
+            // shrink the pool while work is in progress
+            if(++numCompleted == numUnits / 2) {
+                nPool.resize(1);
+            }
+            else if(numCompleted == numUnits) {
+                done();
+            }
+        };
+
+        nPool.resize(8);
+        queueUnitsOfWork(numUnits, callbackFunction, this);
+    });
+});
+
+describe("resize() shall retire idle threads of an elastic thread pool and spawn threads for new work.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+        nPool.createThreadPool(2, { minThreads: 0, maxThreads: 4, idleTimeoutMs: 50, spawnWaitMs: 1 });
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Executed units of work queued after every thread retired.", function(done) {
+        var numUnits = 20;
+        var numCompleted = 0;
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        var callbackFunction = function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(exceptionObject, null);
+                assert.equal(callbackObject.fibCalcResult, 55);
+            }
+            catch(exception) {
+                return done(exception);
+            }
+
+            if(++numCompleted == numUnits) {
+                done();
+            }
+        };
+
+        // wait for the idle threads to retire
+        var callbackContext = this;
+        setTimeout(function() {
+            queueUnitsOfWork(numUnits, callbackFunction, callbackContext);
+        }, 250);
+    });
+});
+
+describe("resize() shall throw an exception when passed invalid arguments.", function() {
+    var thrownException = null;
+
+    beforeEach(function() {
+        thrownException = null;
+    });
+
+    it("Exception thrown when no thread pool exists.", function() {
+        try {
+            nPool.resize(2);
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for zero threads.", function() {
+        nPool.createThreadPool(2);
+        try {
+            nPool.resize(0);
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        nPool.destroyThreadPool();
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for more threads than the maximum.", function() {
+        nPool.createThreadPool(2, { maxThreads: 4 });
+        try {
+            nPool.resize(5);
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        nPool.destroyThreadPool();
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a work stealing thread pool.", function() {
+        nPool.createThreadPool(2, { scheduler: "workStealing" });
+        try {
+            nPool.resize(1);
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        nPool.destroyThreadPool();
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a non-integer argument.", function() {
+        nPool.createThreadPool(2);
+        try {
+            nPool.resize("two");
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        nPool.destroyThreadPool();
+        assert.notEqual(thrownException, null);
+    });
+});
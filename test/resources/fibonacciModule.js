@@ -13,6 +13,16 @@ var FibModule = function () {
             fibCalcResult: calcFib(workParam.fibNumber)
         };
     };
+
+    // busy for workParam.durationMs, reporting when it ran
+    this.span = function (workParam) {
+        var startTime = Date.now();
+        while(Date.now() - startTime < workParam.durationMs) {}
+        return {
+            startTime: startTime,
+            endTime: Date.now()
+        };
+    };
 };
 
 // replicate node.js module loading system
@@ -0,0 +1,36 @@
+// object type function prototype
+var GraphModule = function () {
+
+    // node without inputs
+    this.value = function (workParam) {
+        return {
+            value: workParam.value
+        };
+    };
+
+    // node reading the results of its inputs
+    this.sum = function (inputs, workParam) {
+        var total = workParam.offset || 0;
+        for(var i = 0; i < inputs.length; i++) {
+            total += inputs[i].value;
+        }
+        return {
+            value: total
+        };
+    };
+
+    // continuation reading the result of the previous unit of work
+    this.add = function (result, workParam) {
+        return {
+            value: result.value + (workParam.offset || 0)
+        };
+    };
+
+    // node that fails
+    this.fail = function (inputs) {
+        throw new Error("Graph node failed");
+    };
+};
+
+// replicate node.js module loading system
+module.exports = GraphModule;
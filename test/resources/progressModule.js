@@ -0,0 +1,19 @@
+// object type function prototype
+var ProgressModule = function () {
+
+    // emits each chunk of the work param as a partial result, and returns the number emitted
+    this.stream = function (workParam) {
+        var numEmitted = 0;
+        for(var i = 0; i < workParam.numChunks; i++) {
+            if(emit({ index: i, text: "chunk " + i })) {
+                numEmitted++;
+            }
+        }
+        return {
+            numEmitted: numEmitted
+        };
+    };
+};
+
+// replicate node.js module loading system
+module.exports = ProgressModule;
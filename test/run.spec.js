@@ -0,0 +1,138 @@
+var assert = require("assert");
+
+// load appropriate npool module
+var nPool = null;
+try {
+    nPool = require(__dirname + '/../build/Release/npool');
+}
+catch (e) {
+    nPool = require(__dirname + '/../build/Debug/npool');
+}
+
+describe("[ run() - Tests ]", function() {
+    it("OK", function() {
+        assert.notEqual(nPool, undefined);
+    });
+});
+
+describe("run() shall settle the promise of a unit of work once it completes.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+        nPool.loadFile(2, __dirname + '/resources/graphModule.js');
+        nPool.createThreadPool(2);
+        nPool.createThreadPool(1, { name: "bounded", queueCapacity: 1 });
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.destroyThreadPool("bounded");
+        nPool.removeFile(1);
+        nPool.removeFile(2);
+    });
+
+    it("Resolved the promise with the result of the unit of work.", function() {
+        var promise = nPool.run(1, "calcFibonacciNumber", { fibNumber: 10 });
+        assert.ok(promise instanceof Promise);
+        return promise.then(function(result) {
+            assert.equal(result.fibCalcResult, 55);
+        });
+    });
+
+    it("Resolved the promises of many units of work with their own results.", function() {
+        var promises = [];
+        for(var i = 1; i <= 200; i++) {
+            promises.push(nPool.run(2, "value", { value: i }));
+        }
+        return Promise.all(promises).then(function(results) {
+            for(var i = 0; i < results.length; i++) {
+                assert.equal(results[i].value, i + 1);
+            }
+        });
+    });
+
+    it("Rejected the promise with the exception object of a failed unit of work.", function() {
+        return nPool.run(2, "fail", {}).then(function() {
+            assert.fail("promise was resolved");
+        }, function(exceptionObject) {
+            assert.equal(typeof exceptionObject.message, "string");
+        });
+    });
+
+    it("Rejected the promise of a unit of work that was cancelled.", function() {
+        var promise = nPool.run(1, "calcFibonacciNumber", { fibNumber: 40 }, { workId: 77 });
+        assert.equal(nPool.cancel(77), true);
+        return promise.then(function() {
+            assert.fail("promise was resolved");
+        }, function(exceptionObject) {
+            assert.notEqual(exceptionObject, null);
+        });
+    });
+
+    it("Resolved the promise of a unit of work without a workId despite cancel(0).", function() {
+        var promise = nPool.run(1, "calcFibonacciNumber", { fibNumber: 25 });
+        assert.equal(nPool.cancel(0), false);
+        return promise.then(function(result) {
+            assert.equal(result.fibCalcResult, 75025);
+        });
+    });
+
+    it("Rejected the promise of a unit of work that did not fit the task queue.", function() {
+        var promises = [];
+        for(var i = 0; i < 20; i++) {
+            promises.push(nPool.run(1, "calcFibonacciNumber", { fibNumber: 25 }, "bounded").then(function() {
+                return false;
+            }, function(exceptionObject) {
+                assert.equal(exceptionObject.rejected, true);
+                return true;
+            }));
+        }
+        return Promise.all(promises).then(function(isRejected) {
+            assert.notEqual(isRejected.indexOf(true), -1);
+        });
+    });
+});
+
+describe("run() shall throw an exception when passed invalid arguments.", function() {
+
+    before(function() {
+        nPool.createThreadPool(1);
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+    });
+
+    it("Exception thrown for a non-integer file key.", function() {
+        var thrownException = null;
+        try {
+            nPool.run("one", "calcFibonacciNumber", {});
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a non-integer priority.", function() {
+        var thrownException = null;
+        try {
+            nPool.run(1, "calcFibonacciNumber", {}, { priority: "high" });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a pool that does not exist.", function() {
+        var thrownException = null;
+        try {
+            nPool.run(1, "calcFibonacciNumber", {}, "missing");
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+});
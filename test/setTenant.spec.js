@@ -0,0 +1,235 @@
+var assert = require("assert");
+
+// load appropriate npool module
+var nPool = null;
+try {
+    nPool = require(__dirname + '/../build/Release/npool');
+}
+catch (e) {
+    nPool = require(__dirname + '/../build/Debug/npool');
+}
+
+describe("[ setTenant() - Tests ]", function() {
+    it("OK", function() {
+        assert.notEqual(nPool, undefined);
+    });
+});
+
+function createUnitOfWork(workId, tenant, callbackFunction, callbackContext) {
+    return {
+        workId: workId,
+        fileKey: 1,
+        workFunction: "calcFibonacciNumber",
+        workParam: {
+            fibNumber: 10
+        },
+        tenant: tenant,
+
+        callbackFunction: callbackFunction,
+        callbackContext: callbackContext
+    };
+}
+
+function createSpanOfWork(workId, tenant, durationMs, callbackFunction, callbackContext) {
+    return {
+        workId: workId,
+        fileKey: 1,
+        workFunction: "span",
+        workParam: {
+            durationMs: durationMs
+        },
+        tenant: tenant,
+
+        callbackFunction: callbackFunction,
+        callbackContext: callbackContext
+    };
+}
+
+describe("setTenant() shall share the threads of a fair thread pool between tenants.", function() {
+
+    beforeEach(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+        nPool.createThreadPool(1, { queueType: "fair", maxBatchSize: 1 });
+    });
+
+    afterEach(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Executed a unit of work of a small tenant ahead of a flooding tenant.", function(done) {
+        var numUnits = 200;
+        var numCompleted = 0;
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        var callbackFunction = function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(exceptionObject, null);
+                numCompleted++;
+                if(workId == numUnits + 1) {
+                    // the small tenant waits for at most a turn of each tenant, not the whole flood
+                    assert.ok(numCompleted < 10);
+                    done();
+                }
+            }
+            catch(exception) {
+                done(exception);
+            }
+        };
+
+        for(var i = 1; i <= numUnits; i++) {
+            nPool.queueWork(createUnitOfWork(i, 7, callbackFunction, this));
+        }
+        nPool.queueWork(createUnitOfWork(numUnits + 1, 8, callbackFunction, this));
+    });
+
+    it("Executed every unit of work of tenants with a weight and concurrency limit.", function(done) {
+        var numUnits = 100;
+        var numCompleted = 0;
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        nPool.setTenant(1, { weight: 3 });
+        nPool.setTenant(2, { maxRunning: 1 });
+
+        var callbackFunction = function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(exceptionObject, null);
+                assert.equal(callbackObject.fibCalcResult, 55);
+            }
+            catch(exception) {
+                return done(exception);
+            }
+
+            if(++numCompleted == numUnits) {
+                done();
+            }
+        };
+
+        for(var i = 1; i <= numUnits; i++) {
+            nPool.queueWork(createUnitOfWork(i, (i % 2) + 1, callbackFunction, this));
+        }
+    });
+});
+
+describe("setTenant() shall run as many units of work of a tenant as its concurrency limit.", function() {
+
+    beforeEach(function() {
+        nPool.loadFile(1, __dirname + '/resources/fibonacciModule.js');
+        nPool.createThreadPool(2, { queueType: "fair", maxBatchSize: 1 });
+    });
+
+    afterEach(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Overlapped two units of work of a tenant limited to two after its earlier units completed.", function(done) {
+        var numUnits = 5;
+        var numCompleted = 0;
+        var spans = [];
+
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        nPool.setTenant(3, { maxRunning: 2 });
+
+        var spanFunction = function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(exceptionObject, null);
+                spans.push(callbackObject);
+                if(spans.length == 2) {
+                    // each started before the other ended
+                    assert.ok(spans[0].startTime < spans[1].endTime);
+                    assert.ok(spans[1].startTime < spans[0].endTime);
+                    done();
+                }
+            }
+            catch(exception) {
+                done(exception);
+            }
+        };
+
+        var callbackFunction = function(callbackObject, workId, exceptionObject) {
+            try {
+                assert.equal(exceptionObject, null);
+            }
+            catch(exception) {
+                return done(exception);
+            }
+
+            // units of work of the tenant completed while it ran below its limit, both threads are idle now
+            if(++numCompleted == numUnits) {
+                for(var i = 1; i <= 2; i++) {
+                    nPool.queueWork(createSpanOfWork(numUnits + i, 3, 200, spanFunction, this));
+                }
+            }
+        };
+
+        // another tenant occupies a thread while the tenant's units of work run one at a time on the other
+        nPool.queueWork(createSpanOfWork(1, 4, 200, callbackFunction, this));
+        for(var i = 2; i <= numUnits; i++) {
+            nPool.queueWork(createUnitOfWork(i, 3, callbackFunction, this));
+        }
+    });
+});
+
+describe("setTenant() shall throw an exception when passed invalid arguments.", function() {
+
+    before(function() {
+        nPool.createThreadPool(1, { queueType: "fair" });
+        nPool.createThreadPool(1, { name: "list" });
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.destroyThreadPool("list");
+    });
+
+    it("Exception thrown for a pool that does not use the fair queue.", function() {
+        var thrownException = null;
+        try {
+            nPool.setTenant(1, { weight: 2 }, "list");
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a zero weight.", function() {
+        var thrownException = null;
+        try {
+            nPool.setTenant(1, { weight: 0 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a non-integer tenant.", function() {
+        var thrownException = null;
+        try {
+            nPool.setTenant("tenant", { weight: 2 });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a pool that does not exist.", function() {
+        var thrownException = null;
+        try {
+            nPool.setTenant(1, { maxRunning: 2 }, "missing");
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+});
@@ -0,0 +1,189 @@
+var assert = require("assert");
+
+// load appropriate npool module
+var nPool = null;
+try {
+    nPool = require(__dirname + '/../build/Release/npool');
+}
+catch (e) {
+    nPool = require(__dirname + '/../build/Debug/npool');
+}
+
+describe("[ submitGraph() - Tests ]", function() {
+    it("OK", function() {
+        assert.notEqual(nPool, undefined);
+    });
+});
+
+describe("submitGraph() shall execute a graph of units of work within the thread pool.", function() {
+
+    before(function() {
+        nPool.loadFile(1, __dirname + '/resources/graphModule.js');
+        nPool.createThreadPool(2);
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+        nPool.removeFile(1);
+    });
+
+    it("Delivered the results of the sinks of a diamond graph.", function(done) {
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        var callbackFunction = function(sinkResults, workId, exceptionObject) {
+            try {
+                assert.equal(exceptionObject, null);
+                assert.equal(workId, 1);
+                assert.deepEqual(sinkResults, [{ value: 17 }]);
+                done();
+            }
+            catch(exception) {
+                done(exception);
+            }
+        };
+
+        // 3 + (3 + 1) + (3 + 2) + 4
+        var isQueued = nPool.submitGraph({
+            workId: 1,
+            nodes: [
+                { fileKey: 1, workFunction: "value", workParam: { value: 3 } },
+                { fileKey: 1, workFunction: "sum", workParam: { offset: 1 } },
+                { fileKey: 1, workFunction: "sum", workParam: { offset: 2 } },
+                { fileKey: 1, workFunction: "sum", workParam: { offset: 4 } }
+            ],
+            edges: [[0, 1], [0, 2], [1, 3], [2, 3], [0, 3]],
+            callbackFunction: callbackFunction,
+            callbackContext: this
+        });
+        assert.equal(isQueued, true);
+    });
+
+    it("Delivered the results of every sink in node order.", function(done) {
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        var callbackFunction = function(sinkResults, workId, exceptionObject) {
+            try {
+                assert.equal(exceptionObject, null);
+                assert.deepEqual(sinkResults, [{ value: 6 }, { value: 5 }, { value: 7 }]);
+                done();
+            }
+            catch(exception) {
+                done(exception);
+            }
+        };
+
+        nPool.submitGraph({
+            workId: 2,
+            nodes: [
+                { fileKey: 1, workFunction: "value", workParam: { value: 5 } },
+                { fileKey: 1, workFunction: "sum", workParam: { offset: 1 } },
+                { fileKey: 1, workFunction: "value", workParam: { value: 5 } },
+                { fileKey: 1, workFunction: "sum", workParam: { offset: 2 } }
+            ],
+            edges: [[0, 1], [0, 3]],
+            callbackFunction: callbackFunction,
+            callbackContext: this
+        });
+    });
+
+    it("Delivered the exception of a failed node without executing its outputs.", function(done) {
+        // make sure test ends within 5 sec
+        this.timeout(5000);
+
+        var callbackFunction = function(sinkResults, workId, exceptionObject) {
+            try {
+                assert.equal(sinkResults, null);
+                assert.notEqual(exceptionObject, null);
+                assert.notEqual(exceptionObject.message.indexOf("Graph node failed"), -1);
+                done();
+            }
+            catch(exception) {
+                done(exception);
+            }
+        };
+
+        nPool.submitGraph({
+            workId: 3,
+            nodes: [
+                { fileKey: 1, workFunction: "value", workParam: { value: 1 } },
+                { fileKey: 1, workFunction: "fail" },
+                { fileKey: 1, workFunction: "sum" }
+            ],
+            edges: [[0, 1], [1, 2]],
+            callbackFunction: callbackFunction,
+            callbackContext: this
+        });
+    });
+});
+
+describe("submitGraph() shall throw an exception when passed an invalid graph.", function() {
+
+    before(function() {
+        nPool.createThreadPool(1);
+    });
+
+    after(function() {
+        nPool.destroyThreadPool();
+    });
+
+    var createGraph = function(edges) {
+        return {
+            workId: 1,
+            nodes: [
+                { fileKey: 1, workFunction: "value", workParam: { value: 1 } },
+                { fileKey: 1, workFunction: "sum" }
+            ],
+            edges: edges,
+            callbackFunction: function() {},
+            callbackContext: this
+        };
+    };
+
+    it("Exception thrown for a graph with a cycle.", function() {
+        var thrownException = null;
+        try {
+            nPool.submitGraph(createGraph([[0, 1], [1, 0]]));
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for an edge to a node that does not exist.", function() {
+        var thrownException = null;
+        try {
+            nPool.submitGraph(createGraph([[0, 2]]));
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a graph without nodes.", function() {
+        var thrownException = null;
+        try {
+            nPool.submitGraph({ workId: 1, nodes: [], edges: [], callbackFunction: function() {}, callbackContext: this });
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+
+    it("Exception thrown for a graph without a callback.", function() {
+        var graph = createGraph([[0, 1]]);
+        var thrownException = null;
+        delete graph.callbackFunction;
+        try {
+            nPool.submitGraph(graph);
+        }
+        catch(exception) {
+            thrownException = exception;
+        }
+        assert.notEqual(thrownException, null);
+    });
+});
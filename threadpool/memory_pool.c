@@ -0,0 +1,253 @@
+#define _MEMORY_POOL_C_
+
+/*---------------------------------------------------------------------------*/
+/* FILE INCLUSION */
+/*---------------------------------------------------------------------------*/
+
+#include "memory_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*---------------------------------------------------------------------------*/
+/* MACRO DEFINITIONS */
+/*---------------------------------------------------------------------------*/
+
+// one pool per multiple of the block alignment
+#define MEMORY_POOL_NUM_POOLS           (MEMORY_POOL_MAX_BLOCK_SIZE / MEMORY_POOL_BLOCK_ALIGNMENT)
+
+// number of blocks a thread cache holds before a batch is returned to the pool
+#define MEMORY_POOL_MAX_CACHED_BLOCKS   (2 * MEMORY_POOL_BATCH_SIZE)
+
+/*---------------------------------------------------------------------------*/
+/* TYPE DECLARATIONS */
+/*---------------------------------------------------------------------------*/
+
+// free block (the link is stored within the block itself)
+typedef struct MEMORY_POOL_BLOCK_STRUCT
+{
+    struct MEMORY_POOL_BLOCK_STRUCT *nextBlock;
+
+} MEMORY_POOL_BLOCK;
+
+// free blocks of a pool cached by a single thread
+typedef struct MEMORY_POOL_CACHE_STRUCT
+{
+    MEMORY_POOL_BLOCK   *freeBlocks;
+    unsigned int        numBlocks;
+
+} MEMORY_POOL_CACHE;
+
+// pool of fixed size blocks
+struct MEMORY_POOL_STRUCT
+{
+    // size (bytes) of each block
+    size_t              blockSize;
+
+    // index of the pool (and of its thread caches)
+    unsigned int        poolIndex;
+
+    // blocks returned by the thread caches
+    MEMORY_POOL_BLOCK   *freeBlocks;
+
+    // number of slabs allocated by the pool (slabs are never released)
+    unsigned int        numSlabs;
+
+    // synchronization mechanism
+    THREAD_MUTEX        poolMutex;
+
+}; /* MEMORY_POOL */
+
+/*---------------------------------------------------------------------------*/
+/* OBJECT DECLARATIONS */
+/*---------------------------------------------------------------------------*/
+
+// process wide pools, created on first use
+static MEMORY_POOL* volatile                memoryPools[MEMORY_POOL_NUM_POOLS];
+
+// caches of the calling thread, one per pool
+static SYNC_THREAD_LOCAL MEMORY_POOL_CACHE  memoryPoolCaches[MEMORY_POOL_NUM_POOLS];
+
+/*---------------------------------------------------------------------------*/
+/* STATIC FUNCTION DEFINITIONS */
+/*---------------------------------------------------------------------------*/
+
+// moves up to a batch of blocks from the pool to a cache, allocating a slab if the pool is empty
+static void RefillMemoryPoolCache(MEMORY_POOL *memoryPool, MEMORY_POOL_CACHE *poolCache)
+{
+    // loop variable
+    unsigned int i = 0;
+
+    // block being moved
+    MEMORY_POOL_BLOCK *memoryBlock = 0;
+
+    // newly allocated slab
+    char *poolSlab = 0;
+
+    SyncLockMutex(&(memoryPool->poolMutex));
+
+    // carve a new slab into the pool
+    if(memoryPool->freeBlocks == 0)
+    {
+        poolSlab = (char*)malloc(MEMORY_POOL_SLAB_SIZE * memoryPool->blockSize);
+        if(poolSlab != 0)
+        {
+            for(i = 0; i < MEMORY_POOL_SLAB_SIZE; i++)
+            {
+                memoryBlock = (MEMORY_POOL_BLOCK*)(poolSlab + (i * memoryPool->blockSize));
+                memoryBlock->nextBlock = memoryPool->freeBlocks;
+                memoryPool->freeBlocks = memoryBlock;
+            }
+            memoryPool->numSlabs++;
+        }
+    }
+
+    // move a batch to the cache
+    for(i = 0; (i < MEMORY_POOL_BATCH_SIZE) && (memoryPool->freeBlocks != 0); i++)
+    {
+        memoryBlock = memoryPool->freeBlocks;
+        memoryPool->freeBlocks = memoryBlock->nextBlock;
+
+        memoryBlock->nextBlock = poolCache->freeBlocks;
+        poolCache->freeBlocks = memoryBlock;
+        poolCache->numBlocks++;
+    }
+
+    SyncUnlockMutex(&(memoryPool->poolMutex));
+}
+
+// returns the first numBlocks blocks of a cache to the pool
+static void ReturnMemoryPoolBlocks(MEMORY_POOL *memoryPool, MEMORY_POOL_CACHE *poolCache, unsigned int numBlocks)
+{
+    // loop variable
+    unsigned int i = 0;
+
+    // first and last block being returned
+    MEMORY_POOL_BLOCK *firstBlock = poolCache->freeBlocks;
+    MEMORY_POOL_BLOCK *lastBlock = poolCache->freeBlocks;
+
+    if((numBlocks == 0) || (firstBlock == 0))
+    {
+        return;
+    }
+
+    // detach the blocks from the cache before taking the lock
+    for(i = 1; (i < numBlocks) && (lastBlock->nextBlock != 0); i++)
+    {
+        lastBlock = lastBlock->nextBlock;
+    }
+    poolCache->freeBlocks = lastBlock->nextBlock;
+    poolCache->numBlocks -= i;
+
+    // splice them into the pool
+    SyncLockMutex(&(memoryPool->poolMutex));
+    lastBlock->nextBlock = memoryPool->freeBlocks;
+    memoryPool->freeBlocks = firstBlock;
+    SyncUnlockMutex(&(memoryPool->poolMutex));
+}
+
+/*---------------------------------------------------------------------------*/
+/* FUNCTION DEFINITIONS */
+/*---------------------------------------------------------------------------*/
+
+MEMORY_POOL* GetMemoryPool(size_t blockSize)
+{
+    // index of the pool serving the block size
+    unsigned int poolIndex = 0;
+
+    // pool created by this call
+    MEMORY_POOL *memoryPool = 0;
+
+    // round up to the alignment (a free block must hold its link)
+    blockSize = (blockSize + MEMORY_POOL_BLOCK_ALIGNMENT - 1) & ~((size_t)MEMORY_POOL_BLOCK_ALIGNMENT - 1);
+    if(blockSize == 0)
+    {
+        blockSize = MEMORY_POOL_BLOCK_ALIGNMENT;
+    }
+    if(blockSize > MEMORY_POOL_MAX_BLOCK_SIZE)
+    {
+        return 0;
+    }
+    poolIndex = (unsigned int)(blockSize / MEMORY_POOL_BLOCK_ALIGNMENT) - 1;
+
+    // pool already exists
+    if(memoryPools[poolIndex] != 0)
+    {
+        return memoryPools[poolIndex];
+    }
+
+    // create the pool
+    memoryPool = (MEMORY_POOL*)malloc(sizeof(MEMORY_POOL));
+    if(memoryPool == 0)
+    {
+        return 0;
+    }
+    memset(memoryPool, 0, sizeof(MEMORY_POOL));
+    memoryPool->blockSize = blockSize;
+    memoryPool->poolIndex = poolIndex;
+    SyncCreateMutex(&(memoryPool->poolMutex), NULL);
+
+    // publish the pool, another thread may have created it first
+    if(SyncAtomicCompareExchangePointer((void* volatile*)&(memoryPools[poolIndex]), memoryPool, 0) != 0)
+    {
+        SyncDestroyMutex(&(memoryPool->poolMutex));
+        free(memoryPool);
+    }
+
+    return memoryPools[poolIndex];
+}
+
+void* AllocMemoryPoolBlock(MEMORY_POOL *memoryPool)
+{
+    // block to be returned
+    MEMORY_POOL_BLOCK *memoryBlock = 0;
+
+    // cache of the calling thread
+    MEMORY_POOL_CACHE *poolCache = &(memoryPoolCaches[memoryPool->poolIndex]);
+
+    if(poolCache->freeBlocks == 0)
+    {
+        RefillMemoryPoolCache(memoryPool, poolCache);
+        if(poolCache->freeBlocks == 0)
+        {
+            return 0;
+        }
+    }
+
+    memoryBlock = poolCache->freeBlocks;
+    poolCache->freeBlocks = memoryBlock->nextBlock;
+    poolCache->numBlocks--;
+
+    return (void*)memoryBlock;
+}
+
+void FreeMemoryPoolBlock(MEMORY_POOL *memoryPool, void *memoryBlock)
+{
+    // cache of the calling thread
+    MEMORY_POOL_CACHE *poolCache = &(memoryPoolCaches[memoryPool->poolIndex]);
+
+    ((MEMORY_POOL_BLOCK*)memoryBlock)->nextBlock = poolCache->freeBlocks;
+    poolCache->freeBlocks = (MEMORY_POOL_BLOCK*)memoryBlock;
+    poolCache->numBlocks++;
+
+    // blocks freed by a thread other than the allocating one flow back to the pool in batches
+    if(poolCache->numBlocks > MEMORY_POOL_MAX_CACHED_BLOCKS)
+    {
+        ReturnMemoryPoolBlocks(memoryPool, poolCache, MEMORY_POOL_BATCH_SIZE);
+    }
+}
+
+void FlushMemoryPoolCaches()
+{
+    // loop variable
+    unsigned int i = 0;
+
+    for(i = 0; i < MEMORY_POOL_NUM_POOLS; i++)
+    {
+        if(memoryPools[i] != 0)
+        {
+            ReturnMemoryPoolBlocks(memoryPools[i], &(memoryPoolCaches[i]), memoryPoolCaches[i].numBlocks);
+        }
+    }
+}
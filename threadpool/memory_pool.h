@@ -0,0 +1,79 @@
+#ifndef _MEMORY_POOL_H_
+#define _MEMORY_POOL_H_
+
+/*---------------------------------------------------------------------------*/
+/* FILE INCLUSION */
+/*---------------------------------------------------------------------------*/
+
+#include <stddef.h>
+
+#include "synchronize.h"
+
+/*---------------------------------------------------------------------------*/
+/* MACRO DEFINITIONS */
+/*---------------------------------------------------------------------------*/
+
+// block sizes are rounded up to a multiple of this value (one pool per multiple)
+#define MEMORY_POOL_BLOCK_ALIGNMENT     16
+
+// largest block size served by a pool
+#define MEMORY_POOL_MAX_BLOCK_SIZE      512
+
+// number of blocks moved between a thread cache and its pool at a time
+#define MEMORY_POOL_BATCH_SIZE          32
+
+// number of blocks allocated with a single malloc when a pool is empty
+#define MEMORY_POOL_SLAB_SIZE           256
+
+/*---------------------------------------------------------------------------*/
+/* ENUMERATIONS */
+/*---------------------------------------------------------------------------*/
+
+/* N/A */
+
+/*---------------------------------------------------------------------------*/
+/* TYPE DECLARATIONS */
+/*---------------------------------------------------------------------------*/
+
+// forward declaration to hide implementation
+typedef struct MEMORY_POOL_STRUCT MEMORY_POOL;
+
+/*---------------------------------------------------------------------------*/
+// FUNCTION PROTOTYPES
+// These methods can be called from application code.
+/*---------------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// returns the process wide pool for blocks of the given size, creating it on first use
+// pools are never destroyed, blocks may be allocated and released on any thread
+MEMORY_POOL*        GetMemoryPool(size_t blockSize);
+
+// allocates a block from the calling thread's cache of the pool (0 if memory could not be allocated)
+void*               AllocMemoryPoolBlock(MEMORY_POOL *memoryPool);
+
+// releases a block to the calling thread's cache of the pool
+void                FreeMemoryPoolBlock(MEMORY_POOL *memoryPool, void *memoryBlock);
+
+// returns every block cached by the calling thread to its pool (call before a thread exits)
+void                FlushMemoryPoolCaches();
+
+#ifdef __cplusplus
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+/* OBJECT DECLARATIONS */
+/*---------------------------------------------------------------------------*/
+
+#ifndef _MEMORY_POOL_C_
+
+/* N/A */
+
+#endif /* _MEMORY_POOL_C_ */
+
+/*****************************************************************************/
+
+#endif /* _MEMORY_POOL_H_ */
@@ -1,5 +1,10 @@
 #define _SYNCHRONIZE_C_
 
+// pthread_setaffinity_np, pthread_getattr_np and pthread_setname_np
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 /*---------------------------------------------------------------------------*/
 /* FILE INCLUSION */
 /*---------------------------------------------------------------------------*/
@@ -7,6 +12,20 @@
 #include "synchronize.h"
 
 #include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#ifdef SYNC_USE_FUTEX
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
 
 /*---------------------------------------------------------------------------*/
 /* MACRO DEFINITIONS */
@@ -30,13 +49,43 @@
 /* OBJECT DECLARATIONS */
 /*---------------------------------------------------------------------------*/
 
-/* N/A */
+#ifdef SYNC_USE_FUTEX
+
+// set if contended mutexes spin before sleeping (multiprocessor machines only), 0 until first checked
+static volatile int mutexSpinEnabled = 0;
+
+#endif
 
 /*---------------------------------------------------------------------------*/
 /* STATIC FUNCTION DEFINITIONS */
 /*---------------------------------------------------------------------------*/
 
-/* N/A */
+#ifdef SYNC_USE_FUTEX
+
+// sleeps while the futex holds the expected value (a timeout of 0 sleeps until woken)
+// returns 1 if the timeout elapsed
+static int FutexWait(volatile int *futexRef, int expectedValue, unsigned int timeoutMs)
+{
+    struct timespec waitTime;
+
+    if(timeoutMs == 0)
+    {
+        syscall(SYS_futex, futexRef, FUTEX_WAIT_PRIVATE, expectedValue, NULL, NULL, 0);
+        return 0;
+    }
+
+    waitTime.tv_sec = timeoutMs / 1000;
+    waitTime.tv_nsec = (long)(timeoutMs % 1000) * 1000000;
+    return ((syscall(SYS_futex, futexRef, FUTEX_WAIT_PRIVATE, expectedValue, &waitTime, NULL, 0) == -1) && (errno == ETIMEDOUT)) ? 1 : 0;
+}
+
+// wakes up to numWaiters threads sleeping on the futex
+static void FutexWake(volatile int *futexRef, int numWaiters)
+{
+    syscall(SYS_futex, futexRef, FUTEX_WAKE_PRIVATE, numWaiters, NULL, NULL, 0);
+}
+
+#endif
 
 #ifdef _WIN32
 
@@ -51,7 +100,7 @@ unsigned int        SyncGetThreadId()
 }
 
 // CreateThread
-int                 SyncCreateThread(THREAD *threadRef, void* threadAttr, THREAD_FUNC (WINAPI *threadFunction)(void *), void *threadContext)
+int                 SyncCreateThread(THREAD *threadRef, const SYNC_THREAD_ATTR *threadAttr, THREAD_FUNC (WINAPI *threadFunction)(void *), void *threadContext)
 {
     DWORD threadId = 0;
     
@@ -61,7 +110,7 @@ int                 SyncCreateThread(THREAD *threadRef, void* threadAttr, THREAD
     // http://msdn.microsoft.com/en-us/library/kdzttdcb(v=vs.110).aspx
     *threadRef = (THREAD)_beginthreadex(
             NULL,                   // default security attributes
-            0,                      // use default stack size  
+            (threadAttr != NULL) ? (unsigned int)threadAttr->stackSize : 0,  // stack size (0 is the default)
             threadFunction,         // thread function name
             threadContext,          // argument to thread function 
             0,                      // use default creation flags 
@@ -79,6 +128,110 @@ int                 SyncJoinThread(THREAD threadRef, void** returnValue)
     return 0;
 }
 
+// SwitchToThread
+int                 SyncYieldThread()
+{
+    SwitchToThread();
+    return 0;
+}
+
+// GetSystemInfo
+unsigned int        SyncGetProcessorCount()
+{
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    return (unsigned int)systemInfo.dwNumberOfProcessors;
+}
+
+// GetCurrentThreadStackLimits (Windows 8 and later)
+size_t              SyncGetThreadStackSize()
+{
+    ULONG_PTR lowLimit = 0;
+    ULONG_PTR highLimit = 0;
+
+    void (WINAPI *getStackLimits)(PULONG_PTR, PULONG_PTR) = (void (WINAPI *)(PULONG_PTR, PULONG_PTR))
+        GetProcAddress(GetModuleHandleA("kernel32.dll"), "GetCurrentThreadStackLimits");
+    if(getStackLimits == NULL)
+    {
+        return 0;
+    }
+
+    getStackLimits(&lowLimit, &highLimit);
+    return (size_t)(highLimit - lowLimit);
+}
+
+// SetThreadDescription (Windows 10 1607 and later)
+int                 SyncSetThreadName(const char *threadName)
+{
+    WCHAR wideName[16];
+
+    HRESULT (WINAPI *setDescription)(HANDLE, PCWSTR) = (HRESULT (WINAPI *)(HANDLE, PCWSTR))
+        GetProcAddress(GetModuleHandleA("kernel32.dll"), "SetThreadDescription");
+    if(setDescription == NULL)
+    {
+        return -1;
+    }
+
+    // names longer than the buffer are truncated
+    if(MultiByteToWideChar(CP_UTF8, 0, threadName, -1, wideName, 16) == 0)
+    {
+        wideName[15] = 0;
+    }
+
+    return SUCCEEDED(setDescription(GetCurrentThread(), wideName)) ? 0 : -1;
+}
+
+// SetThreadAffinityMask (processors of the first processor group only)
+int                 SyncSetThreadAffinity(const unsigned int *processorIds, unsigned int numProcessors)
+{
+    unsigned int i = 0;
+    DWORD_PTR affinityMask = 0;
+
+    for(i = 0; i < numProcessors; i++)
+    {
+        if(processorIds[i] < sizeof(DWORD_PTR) * 8)
+        {
+            affinityMask |= ((DWORD_PTR)1 << processorIds[i]);
+        }
+    }
+
+    return ((affinityMask != 0) && (SetThreadAffinityMask(GetCurrentThread(), affinityMask) != 0)) ? 0 : -1;
+}
+
+// GetProcessAffinityMask
+unsigned int        SyncGetThreadAffinity(unsigned int *processorIds, unsigned int maxProcessors)
+{
+    unsigned int i = 0;
+    unsigned int numProcessors = 0;
+    DWORD_PTR processMask = 0;
+    DWORD_PTR systemMask = 0;
+
+    GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+    for(i = 0; (i < sizeof(DWORD_PTR) * 8) && (numProcessors < maxProcessors); i++)
+    {
+        if(processMask & ((DWORD_PTR)1 << i))
+        {
+            processorIds[numProcessors++] = i;
+        }
+    }
+
+    return numProcessors;
+}
+
+// topology is not reported, every processor is its own core of a single package
+int                 SyncGetProcessorTopology(unsigned int processorId, unsigned int *packageId, unsigned int *coreId)
+{
+    *packageId = 0;
+    *coreId = processorId;
+    return -1;
+}
+
+// GetTickCount64
+unsigned long long  SyncGetTime()
+{
+    return GetTickCount64();
+}
+
 // InitializeCriticalSection
 int                 SyncCreateMutex(THREAD_MUTEX *mutexRef, void* mutexAttr)
 {
@@ -127,6 +280,16 @@ int                 SyncWaitCond(THREAD_COND *condRef, THREAD_MUTEX *mutexRef)
     return 0;
 }
 
+// SleepConditionVariableCS (timeout)
+int                 SyncTimedWaitCond(THREAD_COND *condRef, THREAD_MUTEX *mutexRef, unsigned int timeoutMs)
+{
+    if(!SleepConditionVariableCS(condRef, mutexRef, timeoutMs) && (GetLastError() == ERROR_TIMEOUT))
+    {
+        return 1;
+    }
+    return 0;
+}
+
 // WakeConditionVariable
 int                 SyncSignalCond(THREAD_COND *condRef)
 {
@@ -155,9 +318,22 @@ unsigned int        SyncGetThreadId()
 }
 
 // pthread_create
-int                 SyncCreateThread(THREAD *threadRef, void *threadAttr, void *(*threadFunction)(void *), void *threadContext)
+int                 SyncCreateThread(THREAD *threadRef, const SYNC_THREAD_ATTR *threadAttr, void *(*threadFunction)(void *), void *threadContext)
 {
-    return pthread_create(threadRef, threadAttr, threadFunction, threadContext);
+    int createStatus = 0;
+    pthread_attr_t pthreadAttr;
+
+    if((threadAttr == NULL) || (threadAttr->stackSize == 0))
+    {
+        return pthread_create(threadRef, NULL, threadFunction, threadContext);
+    }
+
+    pthread_attr_init(&pthreadAttr);
+    pthread_attr_setstacksize(&pthreadAttr, threadAttr->stackSize);
+    createStatus = pthread_create(threadRef, &pthreadAttr, threadFunction, threadContext);
+    pthread_attr_destroy(&pthreadAttr);
+
+    return createStatus;
 }
 
 // pthread_join
@@ -166,6 +342,306 @@ int                 SyncJoinThread(THREAD threadRef, void** returnValue)
     return pthread_join(threadRef, returnValue);
 }
 
+// sched_yield
+int                 SyncYieldThread()
+{
+    return sched_yield();
+}
+
+// sysconf
+unsigned int        SyncGetProcessorCount()
+{
+    long numProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+    return (numProcessors > 0) ? (unsigned int)numProcessors : 1;
+}
+
+// pthread_getattr_np (linux), pthread_get_stacksize_np (darwin)
+size_t              SyncGetThreadStackSize()
+{
+#if defined(__linux__)
+    size_t stackSize = 0;
+    pthread_attr_t threadAttr;
+
+    if(pthread_getattr_np(pthread_self(), &threadAttr) != 0)
+    {
+        return 0;
+    }
+    pthread_attr_getstacksize(&threadAttr, &stackSize);
+    pthread_attr_destroy(&threadAttr);
+
+    return stackSize;
+#elif defined(__APPLE__)
+    return pthread_get_stacksize_np(pthread_self());
+#else
+    return 0;
+#endif
+}
+
+// pthread_setname_np
+int                 SyncSetThreadName(const char *threadName)
+{
+    char shortName[16];
+
+    strncpy(shortName, threadName, sizeof(shortName) - 1);
+    shortName[sizeof(shortName) - 1] = 0;
+
+#if defined(__linux__)
+    return pthread_setname_np(pthread_self(), shortName);
+#elif defined(__APPLE__)
+    return pthread_setname_np(shortName);
+#else
+    return -1;
+#endif
+}
+
+// pthread_setaffinity_np (linux only)
+int                 SyncSetThreadAffinity(const unsigned int *processorIds, unsigned int numProcessors)
+{
+#if defined(__linux__)
+    unsigned int i = 0;
+    cpu_set_t processorSet;
+
+    CPU_ZERO(&processorSet);
+    for(i = 0; i < numProcessors; i++)
+    {
+        if(processorIds[i] < CPU_SETSIZE)
+        {
+            CPU_SET(processorIds[i], &processorSet);
+        }
+    }
+
+    return (CPU_COUNT(&processorSet) > 0) ? pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &processorSet) : -1;
+#else
+    return -1;
+#endif
+}
+
+// pthread_getaffinity_np (linux), every online processor elsewhere
+unsigned int        SyncGetThreadAffinity(unsigned int *processorIds, unsigned int maxProcessors)
+{
+    unsigned int i = 0;
+    unsigned int numProcessors = 0;
+
+#if defined(__linux__)
+    cpu_set_t processorSet;
+
+    CPU_ZERO(&processorSet);
+    if(pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &processorSet) == 0)
+    {
+        for(i = 0; (i < CPU_SETSIZE) && (numProcessors < maxProcessors); i++)
+        {
+            if(CPU_ISSET(i, &processorSet))
+            {
+                processorIds[numProcessors++] = i;
+            }
+        }
+        return numProcessors;
+    }
+#endif
+
+    for(i = 0; (i < SyncGetProcessorCount()) && (numProcessors < maxProcessors); i++)
+    {
+        processorIds[numProcessors++] = i;
+    }
+
+    return numProcessors;
+}
+
+// sysfs (linux only), every processor is its own core of a single package elsewhere
+int                 SyncGetProcessorTopology(unsigned int processorId, unsigned int *packageId, unsigned int *coreId)
+{
+    int topologyStatus = -1;
+
+#if defined(__linux__)
+    char topologyPath[128];
+    FILE *topologyFile = 0;
+
+    snprintf(topologyPath, sizeof(topologyPath), "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", processorId);
+    topologyFile = fopen(topologyPath, "r");
+    if((topologyFile != 0) && (fscanf(topologyFile, "%u", packageId) == 1))
+    {
+        topologyStatus = 0;
+    }
+    if(topologyFile != 0)
+    {
+        fclose(topologyFile);
+    }
+
+    snprintf(topologyPath, sizeof(topologyPath), "/sys/devices/system/cpu/cpu%u/topology/core_id", processorId);
+    topologyFile = fopen(topologyPath, "r");
+    if((topologyFile == 0) || (fscanf(topologyFile, "%u", coreId) != 1))
+    {
+        topologyStatus = -1;
+    }
+    if(topologyFile != 0)
+    {
+        fclose(topologyFile);
+    }
+#endif
+
+    if(topologyStatus != 0)
+    {
+        *packageId = 0;
+        *coreId = processorId;
+    }
+
+    return topologyStatus;
+}
+
+// clock_gettime (monotonic)
+unsigned long long  SyncGetTime()
+{
+    struct timespec currentTime;
+    clock_gettime(CLOCK_MONOTONIC, &currentTime);
+    return ((unsigned long long)currentTime.tv_sec * 1000) + (currentTime.tv_nsec / 1000000);
+}
+
+#ifdef SYNC_USE_FUTEX
+
+// unlocked futex mutex
+int                 SyncCreateMutex(THREAD_MUTEX *mutexRef, void* mutexAttr)
+{
+    mutexRef->lockState = 0;
+    return 0;
+}
+
+// nothing to release
+int                 SyncDestroyMutex(THREAD_MUTEX *mutexRef)
+{
+    return 0;
+}
+
+// compare and swap, spin, then sleep on the futex
+int                 SyncLockMutex(THREAD_MUTEX *mutexRef)
+{
+    int i = 0;
+    int lockState = SyncAtomicCompareExchange(&(mutexRef->lockState), 1, 0);
+
+    if(lockState == 0)
+    {
+        return 0;
+    }
+
+    // the holder usually releases the mutex within a short critical section
+    if(mutexSpinEnabled == 0)
+    {
+        mutexSpinEnabled = (SyncGetProcessorCount() > 1) ? 1 : -1;
+    }
+    if(mutexSpinEnabled > 0)
+    {
+        for(i = 0; i < SYNC_MUTEX_SPIN_COUNT; i++)
+        {
+            SyncCpuRelax();
+            if((mutexRef->lockState == 0) && ((lockState = SyncAtomicCompareExchange(&(mutexRef->lockState), 1, 0)) == 0))
+            {
+                return 0;
+            }
+        }
+    }
+
+    // mark the mutex as having sleeping waiters, the unlock wakes one of them
+    if(lockState != 2)
+    {
+        lockState = __sync_lock_test_and_set(&(mutexRef->lockState), 2);
+    }
+    while(lockState != 0)
+    {
+        FutexWait(&(mutexRef->lockState), 2, 0);
+        lockState = __sync_lock_test_and_set(&(mutexRef->lockState), 2);
+    }
+
+    return 0;
+}
+
+// release, waking a sleeping waiter if there is one
+int                 SyncUnlockMutex(THREAD_MUTEX *mutexRef)
+{
+    if(__sync_fetch_and_sub(&(mutexRef->lockState), 1) != 1)
+    {
+        SyncAtomicStore(&(mutexRef->lockState), 0);
+        FutexWake(&(mutexRef->lockState), 1);
+    }
+    return 0;
+}
+
+// eventcount without waiters
+int                 SyncCreateCond(THREAD_COND *condRef, void* condAttr)
+{
+    condRef->condSequence = 0;
+    condRef->numWaiters = 0;
+    return 0;
+}
+
+// nothing to release
+int                 SyncDestroyCond(THREAD_COND *condRef)
+{
+    return 0;
+}
+
+// sleeps on the sequence read while the mutex was held
+int                 SyncWaitCond(THREAD_COND *condRef, THREAD_MUTEX *mutexRef)
+{
+    int condSequence = SyncAtomicLoad(&(condRef->condSequence));
+
+    SyncAtomicIncrement(&(condRef->numWaiters));
+    SyncUnlockMutex(mutexRef);
+
+    FutexWait(&(condRef->condSequence), condSequence, 0);
+
+    SyncAtomicDecrement(&(condRef->numWaiters));
+    SyncLockMutex(mutexRef);
+
+    return 0;
+}
+
+// sleeps on the sequence read while the mutex was held (a timeout of 0 times out at once, as it does for pthreads)
+int                 SyncTimedWaitCond(THREAD_COND *condRef, THREAD_MUTEX *mutexRef, unsigned int timeoutMs)
+{
+    int timedOut = 0;
+    int condSequence = 0;
+
+    if(timeoutMs == 0)
+    {
+        return 1;
+    }
+
+    condSequence = SyncAtomicLoad(&(condRef->condSequence));
+
+    SyncAtomicIncrement(&(condRef->numWaiters));
+    SyncUnlockMutex(mutexRef);
+
+    timedOut = FutexWait(&(condRef->condSequence), condSequence, timeoutMs);
+
+    SyncAtomicDecrement(&(condRef->numWaiters));
+    SyncLockMutex(mutexRef);
+
+    return timedOut;
+}
+
+// advance the sequence, only enter the kernel if a thread waits
+int                 SyncSignalCond(THREAD_COND *condRef)
+{
+    SyncAtomicIncrement(&(condRef->condSequence));
+    if(SyncAtomicLoad(&(condRef->numWaiters)) > 0)
+    {
+        FutexWake(&(condRef->condSequence), 1);
+    }
+    return 0;
+}
+
+// advance the sequence, only enter the kernel if a thread waits
+int                 SyncBroadcastCond(THREAD_COND *condRef)
+{
+    SyncAtomicIncrement(&(condRef->condSequence));
+    if(SyncAtomicLoad(&(condRef->numWaiters)) > 0)
+    {
+        FutexWake(&(condRef->condSequence), INT_MAX);
+    }
+    return 0;
+}
+
+#else
+
 // pthread_mutex_init
 int                 SyncCreateMutex(THREAD_MUTEX *mutexRef, void* mutexAttr)
 {
@@ -208,6 +684,23 @@ int                 SyncWaitCond(THREAD_COND *condRef, THREAD_MUTEX *mutexRef)
     return pthread_cond_wait(condRef, mutexRef);
 }
 
+// pthread_cond_timedwait
+int                 SyncTimedWaitCond(THREAD_COND *condRef, THREAD_MUTEX *mutexRef, unsigned int timeoutMs)
+{
+    // absolute (realtime) time to wait until
+    struct timespec waitTime;
+    clock_gettime(CLOCK_REALTIME, &waitTime);
+    waitTime.tv_sec += timeoutMs / 1000;
+    waitTime.tv_nsec += (long)(timeoutMs % 1000) * 1000000;
+    if(waitTime.tv_nsec >= 1000000000)
+    {
+        waitTime.tv_sec++;
+        waitTime.tv_nsec -= 1000000000;
+    }
+
+    return (pthread_cond_timedwait(condRef, mutexRef, &waitTime) == ETIMEDOUT) ? 1 : 0;
+}
+
 // pthread_cond_signal
 int                 SyncSignalCond(THREAD_COND *condRef)
 {
@@ -220,4 +713,137 @@ int                 SyncBroadcastCond(THREAD_COND *condRef)
     return pthread_cond_broadcast(condRef);
 }
 
-#endif 
\ No newline at end of file
+#endif
+
+#endif
+
+/*---------------------------------------------------------------------------*/
+/* WAIT LIST FUNCTION DEFINITIONS */
+/*---------------------------------------------------------------------------*/
+
+int                 SyncCreateWaiter(SYNC_WAITER *waiterRef)
+{
+    waiterRef->waiterSignaled = 0;
+    waiterRef->waiterLinked = 0;
+    waiterRef->prevWaiter = 0;
+    waiterRef->nextWaiter = 0;
+    return SyncCreateCond(&(waiterRef->waiterCond), NULL);
+}
+
+int                 SyncDestroyWaiter(SYNC_WAITER *waiterRef)
+{
+    return SyncDestroyCond(&(waiterRef->waiterCond));
+}
+
+int                 SyncWaitList(SYNC_WAIT_LIST *waitListRef, SYNC_WAITER *waiterRef, THREAD_MUTEX *mutexRef, unsigned int timeoutMs)
+{
+    // time (ms) at which the wait times out and the current time
+    unsigned long long timeoutTime = (timeoutMs > 0) ? SyncGetTime() + timeoutMs : 0;
+    unsigned long long currentTime = 0;
+
+    // park at the front so the most recently active thread is woken first
+    waiterRef->waiterSignaled = 0;
+    waiterRef->waiterLinked = 1;
+    waiterRef->prevWaiter = 0;
+    waiterRef->nextWaiter = waitListRef->firstWaiter;
+    if(waitListRef->firstWaiter != 0)
+    {
+        waitListRef->firstWaiter->prevWaiter = waiterRef;
+    }
+    waitListRef->firstWaiter = waiterRef;
+
+    // wait until woken (needed for spurious wake-ups)
+    while(!waiterRef->waiterSignaled)
+    {
+        if(timeoutMs == 0)
+        {
+            SyncWaitCond(&(waiterRef->waiterCond), mutexRef);
+            continue;
+        }
+
+        currentTime = SyncGetTime();
+        if(currentTime >= timeoutTime)
+        {
+            break;
+        }
+        SyncTimedWaitCond(&(waiterRef->waiterCond), mutexRef, (unsigned int)(timeoutTime - currentTime));
+    }
+
+    // a waiter that timed out is still within the list
+    if(!waiterRef->waiterSignaled)
+    {
+        if(waiterRef->prevWaiter != 0)
+        {
+            waiterRef->prevWaiter->nextWaiter = waiterRef->nextWaiter;
+        }
+        else
+        {
+            waitListRef->firstWaiter = waiterRef->nextWaiter;
+        }
+        if(waiterRef->nextWaiter != 0)
+        {
+            waiterRef->nextWaiter->prevWaiter = waiterRef->prevWaiter;
+        }
+        waiterRef->waiterLinked = 0;
+        return 1;
+    }
+
+    return 0;
+}
+
+unsigned int        SyncWakeWaiters(SYNC_WAIT_LIST *waitListRef, unsigned int numWaiters)
+{
+    // number of waiters woken
+    unsigned int numWoken = 0;
+
+    // waiter being woken
+    SYNC_WAITER *waiterRef = 0;
+
+    while((numWoken < numWaiters) && ((waiterRef = waitListRef->firstWaiter) != 0))
+    {
+        waitListRef->firstWaiter = waiterRef->nextWaiter;
+        if(waitListRef->firstWaiter != 0)
+        {
+            waitListRef->firstWaiter->prevWaiter = 0;
+        }
+
+        waiterRef->waiterSignaled = 1;
+        waiterRef->waiterLinked = 0;
+        SyncSignalCond(&(waiterRef->waiterCond));
+        numWoken++;
+    }
+
+    return numWoken;
+}
+
+void                SyncWakeAllWaiters(SYNC_WAIT_LIST *waitListRef)
+{
+    SyncWakeWaiters(waitListRef, (unsigned int)-1);
+}
+
+int                 SyncWakeWaiter(SYNC_WAIT_LIST *waitListRef, SYNC_WAITER *waiterRef)
+{
+    if(!waiterRef->waiterLinked)
+    {
+        return 0;
+    }
+
+    if(waiterRef->prevWaiter != 0)
+    {
+        waiterRef->prevWaiter->nextWaiter = waiterRef->nextWaiter;
+    }
+    else
+    {
+        waitListRef->firstWaiter = waiterRef->nextWaiter;
+    }
+    if(waiterRef->nextWaiter != 0)
+    {
+        waiterRef->nextWaiter->prevWaiter = waiterRef->prevWaiter;
+    }
+
+    waiterRef->waiterSignaled = 1;
+    waiterRef->waiterLinked = 0;
+    SyncSignalCond(&(waiterRef->waiterCond));
+
+    return 1;
+}
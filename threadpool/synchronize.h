@@ -5,6 +5,8 @@
 /* FILE INCLUSION */
 /*---------------------------------------------------------------------------*/
 
+#include <stddef.h>
+
 #ifdef _WIN32
 
 #include <Windows.h>
@@ -22,7 +24,61 @@
 /* MACRO DEFINITIONS */
 /*---------------------------------------------------------------------------*/
 
-/* N/A */
+// size (bytes) used to pad data shared between threads onto separate cache lines
+#define SYNC_CACHE_LINE_SIZE    64
+
+// linux mutexes and conditionals are built on futexes, define SYNC_USE_PTHREAD to use pthreads instead
+#if defined(__linux__) && !defined(SYNC_USE_PTHREAD)
+#define SYNC_USE_FUTEX
+#endif
+
+// number of times a contended futex mutex is polled before the thread sleeps on it
+#define SYNC_MUTEX_SPIN_COUNT   100
+
+#ifdef _WIN32
+
+// Interlocked* functions act as a full memory barrier
+// volatile reads/writes have acquire/release semantics with msvc
+#define SyncAtomicIncrement(atomicRef)                          InterlockedIncrement((atomicRef))
+#define SyncAtomicDecrement(atomicRef)                          InterlockedDecrement((atomicRef))
+#define SyncAtomicAdd(atomicRef, addValue)                      (InterlockedExchangeAdd((atomicRef), (addValue)) + (addValue))
+#define SyncAtomicCompareExchange(atomicRef, newValue, oldValue) InterlockedCompareExchange((atomicRef), (newValue), (oldValue))
+#define SyncAtomicCompareExchangePointer(pointerRef, newValue, oldValue) InterlockedCompareExchangePointer((pointerRef), (newValue), (oldValue))
+#define SyncAtomicLoad(atomicRef)                               (*(atomicRef))
+#define SyncAtomicStore(atomicRef, newValue)                    (*(atomicRef) = (newValue))
+#define SyncMemoryBarrier()                                     MemoryBarrier()
+
+// hints the processor that the thread is spinning
+#define SyncCpuRelax()                                          YieldProcessor()
+
+// storage class of variables with one instance per thread
+#define SYNC_THREAD_LOCAL                                       __declspec(thread)
+
+#else
+
+// __sync_* builtins act as a full memory barrier
+#define SyncAtomicIncrement(atomicRef)                          __sync_add_and_fetch((atomicRef), 1)
+#define SyncAtomicDecrement(atomicRef)                          __sync_sub_and_fetch((atomicRef), 1)
+#define SyncAtomicAdd(atomicRef, addValue)                      __sync_add_and_fetch((atomicRef), (addValue))
+#define SyncAtomicCompareExchange(atomicRef, newValue, oldValue) __sync_val_compare_and_swap((atomicRef), (oldValue), (newValue))
+#define SyncAtomicCompareExchangePointer(pointerRef, newValue, oldValue) __sync_val_compare_and_swap((pointerRef), (oldValue), (newValue))
+#define SyncAtomicLoad(atomicRef)                               __atomic_load_n((atomicRef), __ATOMIC_ACQUIRE)
+#define SyncAtomicStore(atomicRef, newValue)                    __atomic_store_n((atomicRef), (newValue), __ATOMIC_RELEASE)
+#define SyncMemoryBarrier()                                     __sync_synchronize()
+
+// hints the processor that the thread is spinning
+#if defined(__i386__) || defined(__x86_64__)
+#define SyncCpuRelax()                                          __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define SyncCpuRelax()                                          __asm__ __volatile__("yield")
+#else
+#define SyncCpuRelax()                                          __sync_synchronize()
+#endif
+
+// storage class of variables with one instance per thread
+#define SYNC_THREAD_LOCAL                                       __thread
+
+#endif
 
 /*---------------------------------------------------------------------------*/
 /* ENUMERATIONS */
@@ -41,6 +97,7 @@ typedef CONDITION_VARIABLE  THREAD_COND;
 typedef CRITICAL_SECTION    THREAD_MUTEX;
 typedef HANDLE              THREAD;
 typedef DWORD               THREAD_FUNC;
+typedef volatile LONG       THREAD_ATOMIC;
 
 // defines
 #define THREAD_FUNC_RETURN  0
@@ -49,16 +106,71 @@ typedef DWORD               THREAD_FUNC;
 
 #define WINAPI
 
+#ifdef SYNC_USE_FUTEX
+
+// eventcount, waiters sleep until the sequence moves on so a signal is never lost between
+// releasing the mutex and sleeping, signals only enter the kernel while threads wait
+typedef struct SYNC_FUTEX_COND_STRUCT
+{
+    volatile int                condSequence;
+    volatile int                numWaiters;
+
+} THREAD_COND;
+
+// adaptive mutex, 0 is unlocked, 1 locked and 2 locked with sleeping waiters
+// contended lockers spin briefly and only unlocks of a mutex with sleeping waiters enter the kernel
+typedef struct SYNC_FUTEX_MUTEX_STRUCT
+{
+    volatile int                lockState;
+
+} THREAD_MUTEX;
+
+#else
+
 typedef pthread_cond_t      THREAD_COND;
 typedef pthread_mutex_t     THREAD_MUTEX;
+
+#endif
+
 typedef pthread_t           THREAD;
 typedef void*               THREAD_FUNC;
+typedef volatile long       THREAD_ATOMIC;
 
 // defines
 #define THREAD_FUNC_RETURN  NULL
 
 #endif
 
+// attributes of a new thread (NULL uses the defaults)
+typedef struct SYNC_THREAD_ATTR_STRUCT
+{
+    // size (bytes) of the thread's stack (0 uses the default)
+    size_t                      stackSize;
+
+} SYNC_THREAD_ATTR;
+
+// thread waiting within a wait list, each waiter is woken through its own conditional
+typedef struct SYNC_WAITER_STRUCT
+{
+    THREAD_COND                 waiterCond;
+    int                         waiterSignaled;
+
+    // set while the waiter is within a wait list
+    int                         waiterLinked;
+
+    struct SYNC_WAITER_STRUCT   *prevWaiter;
+    struct SYNC_WAITER_STRUCT   *nextWaiter;
+
+} SYNC_WAITER;
+
+// threads waiting for the same event, most recently parked first (zero to initialize)
+// the list is protected by the mutex the waiters wait with
+typedef struct SYNC_WAIT_LIST_STRUCT
+{
+    SYNC_WAITER                 *firstWaiter;
+
+} SYNC_WAIT_LIST;
+
 /*---------------------------------------------------------------------------*/
 /* FUNCTION PROTOTYPES */
 /*---------------------------------------------------------------------------*/
@@ -71,10 +183,37 @@ extern "C" {
 
 unsigned int        SyncGetThreadId();
 
-int                 SyncCreateThread(THREAD *threadRef, void* threadAttr, THREAD_FUNC (WINAPI *threadFunction)(void *), void *threadContext);
+int                 SyncCreateThread(THREAD *threadRef, const SYNC_THREAD_ATTR *threadAttr, THREAD_FUNC (WINAPI *threadFunction)(void *), void *threadContext);
 
 int                 SyncJoinThread(THREAD threadRef, void** returnValue);
 
+int                 SyncYieldThread();
+
+// number of online processors
+unsigned int        SyncGetProcessorCount();
+
+// size (bytes) of the calling thread's stack (0 if unknown)
+size_t              SyncGetThreadStackSize();
+
+// names the calling thread for debuggers and profilers (at most 15 characters are used)
+int                 SyncSetThreadName(const char *threadName);
+
+/* Processor Functions */
+
+// binds the calling thread to the given processors, returns 0 on success
+int                 SyncSetThreadAffinity(const unsigned int *processorIds, unsigned int numProcessors);
+
+// stores the processors the calling thread may run on, returns the number of processors stored
+unsigned int        SyncGetThreadAffinity(unsigned int *processorIds, unsigned int maxProcessors);
+
+// package (socket) and core of a processor, returns 0 on success
+int                 SyncGetProcessorTopology(unsigned int processorId, unsigned int *packageId, unsigned int *coreId);
+
+/* Time Functions */
+
+// milliseconds since an arbitrary point in time, never goes backwards
+unsigned long long  SyncGetTime();
+
 /* Mutex Functions */
 
 int                 SyncCreateMutex(THREAD_MUTEX *mutexRef, void* mutexAttr);
@@ -93,10 +232,35 @@ int                 SyncDestroyCond(THREAD_COND *condRef);
 
 int                 SyncWaitCond(THREAD_COND *condRef, THREAD_MUTEX *mutexRef);
 
+// returns 1 if the timeout elapsed before the conditional was signaled, a timeout of 0 elapses at once
+// (the mutex is held on return either way, SyncWaitCond waits without a timeout)
+int                 SyncTimedWaitCond(THREAD_COND *condRef, THREAD_MUTEX *mutexRef, unsigned int timeoutMs);
+
 int                 SyncSignalCond(THREAD_COND *condRef);
 
 int                 SyncBroadcastCond(THREAD_COND *condRef);
 
+/* Wait List Functions */
+
+int                 SyncCreateWaiter(SYNC_WAITER *waiterRef);
+
+int                 SyncDestroyWaiter(SYNC_WAITER *waiterRef);
+
+// waits until the waiter is woken (a timeout of 0 waits forever), the mutex must be held
+// returns 1 if the timeout elapsed before the waiter was woken
+int                 SyncWaitList(SYNC_WAIT_LIST *waitListRef, SYNC_WAITER *waiterRef, THREAD_MUTEX *mutexRef, unsigned int timeoutMs);
+
+// wakes up to numWaiters of the most recently parked waiters, the mutex must be held
+// returns the number of waiters woken
+unsigned int        SyncWakeWaiters(SYNC_WAIT_LIST *waitListRef, unsigned int numWaiters);
+
+// wakes every waiter, the mutex must be held
+void                SyncWakeAllWaiters(SYNC_WAIT_LIST *waitListRef);
+
+// wakes the given waiter if it is waiting, the mutex must be held
+// returns 1 if the waiter was woken
+int                 SyncWakeWaiter(SYNC_WAIT_LIST *waitListRef, SYNC_WAITER *waiterRef);
+
 #ifdef __cplusplus
 }
 #endif
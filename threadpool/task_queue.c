@@ -14,7 +14,8 @@
 /* MACRO DEFINITIONS */
 /*---------------------------------------------------------------------------*/
 
-/* N/A */
+// number of hash buckets of the tenants of a fair queue (power of 2)
+#define TASK_QUEUE_TENANT_BUCKETS   64
 
 /*---------------------------------------------------------------------------*/
 /* TYPE DECLARATIONS */
@@ -26,28 +27,132 @@ typedef struct TASK_QUEUE_NODE_STRUCT
     // reference to task queue item
     TASK_QUEUE_ITEM                 *taskQueueItem;
 
-    // node priority (TODO: use in future for prioritization)
+    // node priority (index of the list the node is within)
     unsigned int                    nodePriority;
 
+    // order in which the node was queued (used for aging)
+    unsigned long                   nodeSequence;
+
     // reference to next node in queue
     struct TASK_QUEUE_NODE_STRUCT   *nextNode;
 
 } TASK_QUEUE_NODE;
 
+// tenant of a fair task queue, each tenant queues its tasks in order
+typedef struct TASK_QUEUE_TENANT_STRUCT
+{
+    unsigned int                    tenantId;
+
+    // number of tasks taken per round and the number left within the current round
+    unsigned int                    tenantWeight;
+    unsigned int                    tenantDeficit;
+
+    // most tasks executing at once (0 is unlimited) and the number counted as executing
+    unsigned int                    maxRunning;
+    unsigned int                    numRunning;
+
+    // set if the weight or limit was set (only unset tenants are released while idle)
+    int                             isConfigured;
+
+    // queued tasks
+    struct TASK_QUEUE_NODE_STRUCT   *queueHead;
+    struct TASK_QUEUE_NODE_STRUCT   *queueTail;
+    unsigned int                    numQueued;
+
+    // set while the tenant is within the active tenants
+    int                             isActive;
+    struct TASK_QUEUE_TENANT_STRUCT *nextActive;
+
+    // next tenant within the same hash bucket
+    struct TASK_QUEUE_TENANT_STRUCT *nextTenant;
+
+} TASK_QUEUE_TENANT;
+
+// cell within a ring task queue
+typedef struct TASK_QUEUE_CELL_STRUCT
+{
+    // sequence used to determine if the cell is ready to be written or read
+    THREAD_ATOMIC                   cellSequence;
+
+    // reference to task queue item
+    TASK_QUEUE_ITEM                 *taskQueueItem;
+
+} TASK_QUEUE_CELL;
+
+// lock-free bounded multi-producer/multi-consumer ring
+// http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+typedef struct TASK_QUEUE_RING_STRUCT
+{
+    char                            ringPadding0[SYNC_CACHE_LINE_SIZE];
+
+    // array of cells (read-only after creation)
+    TASK_QUEUE_CELL                 *ringCells;
+
+    // number of cells - 1 (number of cells is a power of 2)
+    unsigned long                   ringMask;
+
+    char                            ringPadding1[SYNC_CACHE_LINE_SIZE];
+
+    // position of the next cell to be written by a producer
+    THREAD_ATOMIC                   enqueuePosition;
+
+    char                            ringPadding2[SYNC_CACHE_LINE_SIZE];
+
+    // position of the next cell to be read by a consumer
+    THREAD_ATOMIC                   dequeuePosition;
+
+    char                            ringPadding3[SYNC_CACHE_LINE_SIZE];
+
+} TASK_QUEUE_RING;
+
 // definition of a task queue
 struct TASK_QUEUE_STRUCT
 {
-    // reference to first item in queue
-    TASK_QUEUE_NODE     *queueHead;
+    // underlying implementation of the queue
+    TASK_QUEUE_TYPE     queueType;
+
+    // ring buffer (only used by TASK_QUEUE_TYPE_RING)
+    TASK_QUEUE_RING     *queueRing;
+
+    // pool of list nodes
+    MEMORY_POOL         *nodePool;
+
+    // number of threads waiting on the queue (registered before they check the queue one last time)
+    THREAD_ATOMIC       waitingThreads;
 
-    // reference to last item in queue
-    TASK_QUEUE_NODE     *queueTail;
+    // maximum number of nodes within a list queue (0 is unbounded)
+    unsigned int        queueCapacity;
+
+    // drain notification
+    unsigned int        queueLowWaterMark;
+    void                (*queueDrainCallback)(void *drainContext);
+    void                *queueDrainContext;
+
+    // set when an item was rejected and the drain callback has not been called yet
+    THREAD_ATOMIC       drainPending;
+
+    // reference to first item of each priority
+    TASK_QUEUE_NODE     *queueHead[TASK_QUEUE_NUM_PRIORITIES];
+
+    // reference to last item of each priority
+    TASK_QUEUE_NODE     *queueTail[TASK_QUEUE_NUM_PRIORITIES];
 
     // number of nodes within the queue
     int                 queueLength;
 
-    // synchronization mechanisms
-    THREAD_COND         queueCond;
+    // number of nodes ever queued
+    unsigned long       queueSequence;
+
+    // tenants of a fair queue by id, and the tenants that may have ready nodes in round-robin order
+    TASK_QUEUE_TENANT   *tenantBuckets[TASK_QUEUE_TENANT_BUCKETS];
+    TASK_QUEUE_TENANT   *activeHead;
+    TASK_QUEUE_TENANT   *activeTail;
+
+    // number of nodes of a fair queue whose tenant is below its concurrency limit
+    int                 readyLength;
+
+    // synchronization mechanisms, each waiting thread is woken individually
+    SYNC_WAIT_LIST      queueWaiters;
     THREAD_MUTEX        queueMutex;
 
 }; /* TASK_QUEUE */
@@ -56,7 +161,13 @@ struct TASK_QUEUE_STRUCT
 /* FUNCTION PROTOTYPES */
 /*---------------------------------------------------------------------------*/
 
-/* N/A */
+int                 GetQueueLength(TASK_QUEUE_DATA *taskQueueData);
+void                WaitTaskQueue(TASK_QUEUE_DATA *taskQueueData, SYNC_WAITER *queueWaiter);
+int                 WaitTaskQueueTimed(TASK_QUEUE_DATA *taskQueueData, SYNC_WAITER *queueWaiter, unsigned int timeoutMs);
+void                WakeTaskQueue(TASK_QUEUE_DATA *taskQueueData);
+int                 WakeTaskQueueWaiter(TASK_QUEUE_DATA *taskQueueData, SYNC_WAITER *queueWaiter);
+unsigned int        GetTaskQueueItems(TASK_QUEUE_DATA *taskQueueData, TASK_QUEUE_ITEM **taskQueueItems, unsigned int maxItems);
+void                ReleaseTaskQueueTenant(TASK_QUEUE_DATA *taskQueueData, TASK_QUEUE_ITEM *taskQueueItem);
 
 /*---------------------------------------------------------------------------*/
 /* OBJECT DECLARATIONS */
@@ -68,12 +179,12 @@ struct TASK_QUEUE_STRUCT
 /* STATIC FUNCTION DEFINITIONS */
 /*---------------------------------------------------------------------------*/
 
-static TASK_QUEUE_NODE* CreateQueueNode(TASK_QUEUE_ITEM *taskQueueItem)
+static TASK_QUEUE_NODE* CreateQueueNode(TASK_QUEUE *taskQueue, TASK_QUEUE_ITEM *taskQueueItem)
 {
     TASK_QUEUE_NODE *queueNode = 0;
 
     // create new node
-    queueNode = (TASK_QUEUE_NODE*)malloc(sizeof(TASK_QUEUE_NODE));
+    queueNode = (TASK_QUEUE_NODE*)AllocMemoryPoolBlock(taskQueue->nodePool);
     if(queueNode == 0)
     {
         return 0;
@@ -86,19 +197,328 @@ static TASK_QUEUE_NODE* CreateQueueNode(TASK_QUEUE_ITEM *taskQueueItem)
     return queueNode;
 }
 
-static void FreeQueueNode(TASK_QUEUE_NODE *queueNode)
+static void FreeQueueNode(TASK_QUEUE *taskQueue, TASK_QUEUE_NODE *queueNode)
 {
-    // release the task item data memory
-    free(queueNode->taskQueueItem->taskItemData);
-    queueNode->taskQueueItem->taskItemData = 0;
+    // release the node
+    FreeMemoryPoolBlock(taskQueue->nodePool, queueNode);
+}
 
-    // release the task item memory
-    free(queueNode->taskQueueItem);
-    queueNode->taskQueueItem = 0;
+static TASK_QUEUE_RING* CreateQueueRing(unsigned int queueCapacity)
+{
+    // loop variable
+    unsigned long i = 0;
 
-    // release the node
-    free(queueNode);
-    queueNode = 0;
+    // number of cells (rounded up to a power of 2)
+    unsigned long numCells = 2;
+
+    // ring to be returned
+    TASK_QUEUE_RING *queueRing = (TASK_QUEUE_RING*)malloc(sizeof(TASK_QUEUE_RING));
+    memset(queueRing, 0, sizeof(TASK_QUEUE_RING));
+
+    // round the capacity up to a power of 2 so positions can be masked
+    while(numCells < queueCapacity)
+    {
+        numCells <<= 1;
+    }
+    queueRing->ringMask = numCells - 1;
+
+    // each cell starts out ready to be written at its own position
+    queueRing->ringCells = (TASK_QUEUE_CELL*)malloc(numCells * sizeof(TASK_QUEUE_CELL));
+    for(i = 0; i < numCells; i++)
+    {
+        queueRing->ringCells[i].cellSequence = (long)i;
+        queueRing->ringCells[i].taskQueueItem = 0;
+    }
+
+    return queueRing;
+}
+
+static TASK_QUEUE_STATUS EnqueueRingItem(TASK_QUEUE_RING *queueRing, TASK_QUEUE_ITEM *taskQueueItem)
+{
+    // cell to be written
+    TASK_QUEUE_CELL *queueCell = 0;
+
+    // positions and sequence of the cell
+    unsigned long   enqueuePosition = (unsigned long)SyncAtomicLoad(&(queueRing->enqueuePosition));
+    unsigned long   cellSequence = 0;
+    long            sequenceDiff = 0;
+
+    for(;;)
+    {
+        queueCell = &(queueRing->ringCells[enqueuePosition & queueRing->ringMask]);
+        cellSequence = (unsigned long)SyncAtomicLoad(&(queueCell->cellSequence));
+        sequenceDiff = (long)(cellSequence - enqueuePosition);
+
+        // cell is free, attempt to claim the position
+        if(sequenceDiff == 0)
+        {
+            unsigned long claimedPosition = (unsigned long)SyncAtomicCompareExchange(
+                &(queueRing->enqueuePosition),
+                (long)(enqueuePosition + 1),
+                (long)enqueuePosition);
+
+            if(claimedPosition == enqueuePosition)
+            {
+                break;
+            }
+            enqueuePosition = claimedPosition;
+        }
+        // cell still holds an item from the previous lap, the ring is full
+        else if(sequenceDiff < 0)
+        {
+            return TASK_QUEUE_STATUS_ADD_FULL_FAIL;
+        }
+        // another producer claimed the position
+        else
+        {
+            enqueuePosition = (unsigned long)SyncAtomicLoad(&(queueRing->enqueuePosition));
+        }
+    }
+
+    // store the item and publish the cell to consumers
+    queueCell->taskQueueItem = taskQueueItem;
+    SyncAtomicStore(&(queueCell->cellSequence), (long)(enqueuePosition + 1));
+
+    return TASK_QUEUE_STATUS_ADD_SUCCESS;
+}
+
+static TASK_QUEUE_ITEM* DequeueRingItem(TASK_QUEUE_RING *queueRing)
+{
+    // cell to be read
+    TASK_QUEUE_CELL *queueCell = 0;
+
+    // task queue item to be returned
+    TASK_QUEUE_ITEM *taskQueueItem = 0;
+
+    // positions and sequence of the cell
+    unsigned long   dequeuePosition = (unsigned long)SyncAtomicLoad(&(queueRing->dequeuePosition));
+    unsigned long   cellSequence = 0;
+    long            sequenceDiff = 0;
+
+    for(;;)
+    {
+        queueCell = &(queueRing->ringCells[dequeuePosition & queueRing->ringMask]);
+        cellSequence = (unsigned long)SyncAtomicLoad(&(queueCell->cellSequence));
+        sequenceDiff = (long)(cellSequence - (dequeuePosition + 1));
+
+        // cell has been published, attempt to claim the position
+        if(sequenceDiff == 0)
+        {
+            unsigned long claimedPosition = (unsigned long)SyncAtomicCompareExchange(
+                &(queueRing->dequeuePosition),
+                (long)(dequeuePosition + 1),
+                (long)dequeuePosition);
+
+            if(claimedPosition == dequeuePosition)
+            {
+                break;
+            }
+            dequeuePosition = claimedPosition;
+        }
+        // cell has not been published yet, the ring is empty
+        else if(sequenceDiff < 0)
+        {
+            return 0;
+        }
+        // another consumer claimed the position
+        else
+        {
+            dequeuePosition = (unsigned long)SyncAtomicLoad(&(queueRing->dequeuePosition));
+        }
+    }
+
+    // take the item and release the cell for the next lap of producers
+    taskQueueItem = queueCell->taskQueueItem;
+    queueCell->taskQueueItem = 0;
+    SyncAtomicStore(&(queueCell->cellSequence), (long)(dequeuePosition + queueRing->ringMask + 1));
+
+    return taskQueueItem;
+}
+
+// returns the tenant with the given id, creating it if requested (0 if it does not exist or memory could not be allocated)
+static TASK_QUEUE_TENANT* GetQueueTenant(TASK_QUEUE *taskQueue, unsigned int tenantId, int createTenant)
+{
+    // bucket of the tenant
+    TASK_QUEUE_TENANT **tenantBucket = &(taskQueue->tenantBuckets[(tenantId * 2654435761u) & (TASK_QUEUE_TENANT_BUCKETS - 1)]);
+
+    // tenant to be returned
+    TASK_QUEUE_TENANT *queueTenant = *tenantBucket;
+
+    while((queueTenant != 0) && (queueTenant->tenantId != tenantId))
+    {
+        queueTenant = queueTenant->nextTenant;
+    }
+
+    if((queueTenant == 0) && createTenant)
+    {
+        queueTenant = (TASK_QUEUE_TENANT*)malloc(sizeof(TASK_QUEUE_TENANT));
+        if(queueTenant != 0)
+        {
+            memset(queueTenant, 0, sizeof(TASK_QUEUE_TENANT));
+            queueTenant->tenantId = tenantId;
+            queueTenant->tenantWeight = TASK_QUEUE_DEFAULT_TENANT_WEIGHT;
+            queueTenant->nextTenant = *tenantBucket;
+            *tenantBucket = queueTenant;
+        }
+    }
+
+    return queueTenant;
+}
+
+// releases a tenant that was never configured once it has no queued or executing tasks
+static void ReleaseIdleTenant(TASK_QUEUE *taskQueue, TASK_QUEUE_TENANT *queueTenant)
+{
+    // reference to the link to the tenant within its bucket
+    TASK_QUEUE_TENANT **tenantLink = &(taskQueue->tenantBuckets[(queueTenant->tenantId * 2654435761u) & (TASK_QUEUE_TENANT_BUCKETS - 1)]);
+
+    if(queueTenant->isConfigured || queueTenant->isActive || (queueTenant->numQueued > 0) || (queueTenant->numRunning > 0))
+    {
+        return;
+    }
+
+    while(*tenantLink != queueTenant)
+    {
+        tenantLink = &((*tenantLink)->nextTenant);
+    }
+    *tenantLink = queueTenant->nextTenant;
+    free(queueTenant);
+}
+
+// returns 1 if the tenant has queued nodes and is below its concurrency limit
+static int IsTenantReady(TASK_QUEUE_TENANT *queueTenant)
+{
+    return (queueTenant->numQueued > 0) && ((queueTenant->maxRunning == 0) || (queueTenant->numRunning < queueTenant->maxRunning));
+}
+
+// appends a tenant to the active tenants
+static void ActivateTenant(TASK_QUEUE *taskQueue, TASK_QUEUE_TENANT *queueTenant)
+{
+    if(queueTenant->isActive)
+    {
+        return;
+    }
+
+    queueTenant->isActive = 1;
+    queueTenant->nextActive = 0;
+    if(taskQueue->activeTail != 0)
+    {
+        taskQueue->activeTail->nextActive = queueTenant;
+    }
+    else
+    {
+        taskQueue->activeHead = queueTenant;
+    }
+    taskQueue->activeTail = queueTenant;
+}
+
+// removes the first active tenant, appending it again if requested (it starts a new round either way)
+static void RotateActiveTenant(TASK_QUEUE *taskQueue, int keepActive)
+{
+    // reference to the first active tenant
+    TASK_QUEUE_TENANT *queueTenant = taskQueue->activeHead;
+
+    taskQueue->activeHead = queueTenant->nextActive;
+    if(taskQueue->activeHead == 0)
+    {
+        taskQueue->activeTail = 0;
+    }
+    queueTenant->isActive = 0;
+    queueTenant->tenantDeficit = 0;
+
+    if(keepActive)
+    {
+        ActivateTenant(taskQueue, queueTenant);
+    }
+}
+
+// adds a node to the end of its tenant (the node's item must be set)
+static TASK_QUEUE_STATUS AddFairNode(TASK_QUEUE *taskQueue, TASK_QUEUE_NODE *queueNode)
+{
+    // tenant of the node
+    TASK_QUEUE_TENANT *queueTenant = GetQueueTenant(taskQueue, queueNode->taskQueueItem->taskTenant, 1);
+    if(queueTenant == 0)
+    {
+        return TASK_QUEUE_STATUS_ADD_MALLOC_FAIL;
+    }
+
+    if(queueTenant->queueTail != 0)
+    {
+        queueTenant->queueTail->nextNode = queueNode;
+    }
+    else
+    {
+        queueTenant->queueHead = queueNode;
+    }
+    queueTenant->queueTail = queueNode;
+    queueTenant->numQueued++;
+
+    // a tenant at its concurrency limit becomes ready again once one of its tasks completes
+    if(IsTenantReady(queueTenant))
+    {
+        taskQueue->readyLength++;
+        ActivateTenant(taskQueue, queueTenant);
+    }
+
+    return TASK_QUEUE_STATUS_ADD_SUCCESS;
+}
+
+// removes the next node by weighted deficit round-robin over the ready tenants (readyLength must not be 0)
+// each tenant takes up to its weight of nodes per round, so a tenant with a deep queue delays others by at most one round
+static TASK_QUEUE_NODE* RemoveFairNode(TASK_QUEUE *taskQueue)
+{
+    // tenant being served and the node to be returned
+    TASK_QUEUE_TENANT *queueTenant = 0;
+    TASK_QUEUE_NODE *queueNode = 0;
+
+    // tenants whose limit was lowered while they were active are skipped
+    while(!IsTenantReady(taskQueue->activeHead))
+    {
+        RotateActiveTenant(taskQueue, 0);
+    }
+    queueTenant = taskQueue->activeHead;
+
+    // a new round grants the tenant its weight
+    if(queueTenant->tenantDeficit == 0)
+    {
+        queueTenant->tenantDeficit = queueTenant->tenantWeight;
+    }
+
+    // unlink the node from its tenant
+    queueNode = queueTenant->queueHead;
+    queueTenant->queueHead = queueNode->nextNode;
+    if(queueTenant->queueHead == 0)
+    {
+        queueTenant->queueTail = 0;
+    }
+    queueNode->nextNode = 0;
+    queueTenant->numQueued--;
+    queueTenant->tenantDeficit--;
+    taskQueue->readyLength--;
+    taskQueue->queueLength--;
+
+    // count the task against the limit of its tenant until it completes
+    if(queueTenant->maxRunning > 0)
+    {
+        queueTenant->numRunning++;
+        queueNode->taskQueueItem->taskTenantRunning = 1;
+        if(queueTenant->numRunning >= queueTenant->maxRunning)
+        {
+            taskQueue->readyLength -= (int)queueTenant->numQueued;
+        }
+    }
+
+    // the tenant leaves the active tenants once it is no longer ready, or moves to the end once its round is over
+    if(!IsTenantReady(queueTenant))
+    {
+        RotateActiveTenant(taskQueue, 0);
+        ReleaseIdleTenant(taskQueue, queueTenant);
+    }
+    else if(queueTenant->tenantDeficit == 0)
+    {
+        RotateActiveTenant(taskQueue, 1);
+    }
+
+    return queueNode;
 }
 
 static TASK_QUEUE_STATUS AddTaskToQueueInternal(TASK_QUEUE_DATA *taskQueueData, TASK_QUEUE_ITEM *taskQueueItem)
@@ -109,8 +529,17 @@ static TASK_QUEUE_STATUS AddTaskToQueueInternal(TASK_QUEUE_DATA *taskQueueData,
     // node to be added to queue
     TASK_QUEUE_NODE     *queueNode = 0;
 
+    // reference to the queue
+    TASK_QUEUE          *taskQueue = taskQueueData->taskQueue;
+
+    // queue is at capacity
+    if((taskQueue->queueCapacity > 0) && (taskQueue->queueLength >= (int)taskQueue->queueCapacity))
+    {
+        return TASK_QUEUE_STATUS_ADD_FULL_FAIL;
+    }
+
     // create queue node
-    queueNode = CreateQueueNode(taskQueueItem);
+    queueNode = CreateQueueNode(taskQueue, taskQueueItem);
 
     // node creation failed
     if(queueNode == 0)
@@ -118,48 +547,265 @@ static TASK_QUEUE_STATUS AddTaskToQueueInternal(TASK_QUEUE_DATA *taskQueueData,
         // mark as malloc fail
         addStatus = TASK_QUEUE_STATUS_ADD_MALLOC_FAIL;
     }
+    // add node to its tenant
+    else if(taskQueue->queueType == TASK_QUEUE_TYPE_FAIR)
+    {
+        addStatus = AddFairNode(taskQueue, queueNode);
+        if(addStatus == TASK_QUEUE_STATUS_ADD_SUCCESS)
+        {
+            taskQueue->queueLength++;
+        }
+        else
+        {
+            FreeQueueNode(taskQueue, queueNode);
+        }
+    }
     // add node to queue
     else
     {
-        // queue is empty
-        if(taskQueueData->taskQueue->queueLength == 0)
+        // store priority and order of the node
+        queueNode->nodePriority = taskQueueItem->taskPriority < TASK_QUEUE_NUM_PRIORITIES ?
+            taskQueueItem->taskPriority :
+            TASK_QUEUE_NUM_PRIORITIES - 1;
+        queueNode->nodeSequence = taskQueue->queueSequence++;
+
+        // priority is empty
+        if(taskQueue->queueHead[queueNode->nodePriority] == 0)
         {
-            taskQueueData->taskQueue->queueHead = queueNode;
-            taskQueueData->taskQueue->queueTail = queueNode;
+            taskQueue->queueHead[queueNode->nodePriority] = queueNode;
+            taskQueue->queueTail[queueNode->nodePriority] = queueNode;
         }
-        // add node to end of queue
+        // add node to end of priority
         else
         {
-            taskQueueData->taskQueue->queueTail->nextNode = queueNode;
-            taskQueueData->taskQueue->queueTail = queueNode;
+            taskQueue->queueTail[queueNode->nodePriority]->nextNode = queueNode;
+            taskQueue->queueTail[queueNode->nodePriority] = queueNode;
         }
 
         // update queue length
-        taskQueueData->taskQueue->queueLength++;
+        taskQueue->queueLength++;
     }
 
     return addStatus;
 }
 
+// calls the drain callback if an item was rejected and the queue has fallen to the low water mark
+static void CheckTaskQueueDrain(TASK_QUEUE_DATA *taskQueueData)
+{
+    // reference to the queue
+    TASK_QUEUE *taskQueue = taskQueueData->taskQueue;
+
+    // only one thread may clear the pending drain and call the callback
+    // (nodes of a fair queue count whether or not their tenant is at its concurrency limit)
+    if((taskQueue->queueDrainCallback != 0) &&
+        (SyncAtomicLoad(&(taskQueue->drainPending)) != 0) &&
+        (((taskQueue->queueType == TASK_QUEUE_TYPE_RING) ? GetQueueLength(taskQueueData) : taskQueue->queueLength) <= (int)taskQueue->queueLowWaterMark) &&
+        (SyncAtomicCompareExchange(&(taskQueue->drainPending), 0, 1) == 1))
+    {
+        taskQueue->queueDrainCallback(taskQueue->queueDrainContext);
+    }
+}
+
+// wakes one waiting thread per added item, most recently parked first (queue mutex must be held)
+static void SignalTaskQueue(TASK_QUEUE_DATA *taskQueueData, unsigned int numItems)
+{
+    if((numItems == 0) || (SyncAtomicLoad(&(taskQueueData->taskQueue->waitingThreads)) == 0))
+    {
+        return;
+    }
+
+    SyncWakeWaiters(&(taskQueueData->taskQueue->queueWaiters), numItems);
+}
+
+// removes the node with the highest priority after aging (queue must not be empty)
+static TASK_QUEUE_NODE* RemoveQueueNode(TASK_QUEUE *taskQueue)
+{
+    // loop variable
+    unsigned int i = 0;
+
+    // priority of the node to be removed
+    unsigned int nodePriority = TASK_QUEUE_NUM_PRIORITIES;
+
+    // aged keys of the best node so far and the node being compared
+    unsigned long bestKey = 0;
+    unsigned long nodeKey = 0;
+
+    // node to be returned
+    TASK_QUEUE_NODE *queueNode = 0;
+
+    // the head of each priority is its oldest node, so only the heads need to be compared
+    // a node is raised one priority level for every TASK_QUEUE_AGING_INTERVAL nodes queued after it
+    for(i = 0; i < TASK_QUEUE_NUM_PRIORITIES; i++)
+    {
+        if(taskQueue->queueHead[i] != 0)
+        {
+            nodeKey = taskQueue->queueHead[i]->nodeSequence + (i * TASK_QUEUE_AGING_INTERVAL);
+            if((nodePriority == TASK_QUEUE_NUM_PRIORITIES) || ((long)(nodeKey - bestKey) < 0))
+            {
+                nodePriority = i;
+                bestKey = nodeKey;
+            }
+        }
+    }
+
+    // unlink the node from its priority
+    queueNode = taskQueue->queueHead[nodePriority];
+    taskQueue->queueHead[nodePriority] = queueNode->nextNode;
+    if(taskQueue->queueHead[nodePriority] == 0)
+    {
+        taskQueue->queueTail[nodePriority] = 0;
+    }
+
+    // decrement length of the queue
+    taskQueue->queueLength--;
+
+    return queueNode;
+}
+
+// releases every queued node of a fair queue, tenants keep their configuration
+static void FlushFairQueue(TASK_QUEUE *taskQueue)
+{
+    // loop variable
+    unsigned int i = 0;
+
+    // tenant being flushed and the next one within its bucket
+    TASK_QUEUE_TENANT *queueTenant = 0;
+    TASK_QUEUE_TENANT *nextTenant = 0;
+
+    // node to be deleted
+    TASK_QUEUE_NODE *queueNode = 0;
+
+    while(taskQueue->activeHead != 0)
+    {
+        RotateActiveTenant(taskQueue, 0);
+    }
+
+    for(i = 0; i < TASK_QUEUE_TENANT_BUCKETS; i++)
+    {
+        for(queueTenant = taskQueue->tenantBuckets[i]; queueTenant != 0; queueTenant = nextTenant)
+        {
+            nextTenant = queueTenant->nextTenant;
+            while((queueNode = queueTenant->queueHead) != 0)
+            {
+                queueTenant->queueHead = queueNode->nextNode;
+                DestroyTaskQueueItem(queueNode->taskQueueItem);
+                FreeQueueNode(taskQueue, queueNode);
+            }
+            queueTenant->queueTail = 0;
+            queueTenant->numQueued = 0;
+            ReleaseIdleTenant(taskQueue, queueTenant);
+        }
+    }
+
+    taskQueue->queueLength = 0;
+    taskQueue->readyLength = 0;
+}
+
+// unlinks the first node of a list holding the given item context (0 if there is none)
+static TASK_QUEUE_NODE* UnlinkListNode(TASK_QUEUE_NODE **queueHead, TASK_QUEUE_NODE **queueTail, unsigned int taskId, void *taskItemData)
+{
+    // node being compared and the node before it
+    TASK_QUEUE_NODE *queueNode = *queueHead;
+    TASK_QUEUE_NODE *prevNode = 0;
+
+    while((queueNode != 0) &&
+        ((queueNode->taskQueueItem->taskId != taskId) || (queueNode->taskQueueItem->taskItemData != taskItemData)))
+    {
+        prevNode = queueNode;
+        queueNode = queueNode->nextNode;
+    }
+    if(queueNode == 0)
+    {
+        return 0;
+    }
+
+    if(prevNode != 0)
+    {
+        prevNode->nextNode = queueNode->nextNode;
+    }
+    else
+    {
+        *queueHead = queueNode->nextNode;
+    }
+    if(*queueTail == queueNode)
+    {
+        *queueTail = prevNode;
+    }
+    queueNode->nextNode = 0;
+
+    return queueNode;
+}
+
+// unlinks the node holding the given item context from whichever tenant queued it (0 if there is none)
+static TASK_QUEUE_NODE* UnlinkFairNode(TASK_QUEUE *taskQueue, unsigned int taskId, void *taskItemData)
+{
+    // loop variable
+    unsigned int i = 0;
+
+    // tenant being searched
+    TASK_QUEUE_TENANT *queueTenant = 0;
+
+    // node to be returned
+    TASK_QUEUE_NODE *queueNode = 0;
+
+    for(i = 0; (i < TASK_QUEUE_TENANT_BUCKETS) && (queueNode == 0); i++)
+    {
+        for(queueTenant = taskQueue->tenantBuckets[i]; (queueTenant != 0) && (queueNode == 0); queueTenant = queueTenant->nextTenant)
+        {
+            queueNode = UnlinkListNode(&(queueTenant->queueHead), &(queueTenant->queueTail), taskId, taskItemData);
+            if(queueNode == 0)
+            {
+                continue;
+            }
+
+            // the node only counted as ready while its tenant was below its limit (an emptied active tenant is skipped lazily)
+            if((queueTenant->maxRunning == 0) || (queueTenant->numRunning < queueTenant->maxRunning))
+            {
+                taskQueue->readyLength--;
+            }
+            queueTenant->numQueued--;
+            ReleaseIdleTenant(taskQueue, queueTenant);
+            break;
+        }
+    }
+
+    return queueNode;
+}
+
 static void DestroyTaskQueueInternal(TASK_QUEUE_DATA *taskQueueData)
 {
     // node to be deleted
     TASK_QUEUE_NODE *queueNode = 0;
 
+    // item to be deleted
+    TASK_QUEUE_ITEM *taskQueueItem = 0;
+
+    // delete each ring item sequentially
+    if(taskQueueData->taskQueue->queueType == TASK_QUEUE_TYPE_RING)
+    {
+        while((taskQueueItem = DequeueRingItem(taskQueueData->taskQueue->queueRing)) != 0)
+        {
+            DestroyTaskQueueItem(taskQueueItem);
+        }
+        return;
+    }
+
+    // delete each node of each tenant
+    if(taskQueueData->taskQueue->queueType == TASK_QUEUE_TYPE_FAIR)
+    {
+        FlushFairQueue(taskQueueData->taskQueue);
+        return;
+    }
+
     // delete each node sequentially
     while(taskQueueData->taskQueue->queueLength > 0)
     {
         // get reference of node to be removed
-        queueNode = taskQueueData->taskQueue->queueHead;
-
-        // update head node
-        taskQueueData->taskQueue->queueHead = queueNode->nextNode;
-        
-        // release queue node memory
-        FreeQueueNode(queueNode);
+        queueNode = RemoveQueueNode(taskQueueData->taskQueue);
 
-        // decrement length of the queue
-        taskQueueData->taskQueue->queueLength--;
+        // release the item and the queue node memory
+        DestroyTaskQueueItem(queueNode->taskQueueItem);
+        FreeQueueNode(taskQueueData->taskQueue, queueNode);
     }
 }
 
@@ -168,6 +814,11 @@ static void DestroyTaskQueueInternal(TASK_QUEUE_DATA *taskQueueData)
 /*---------------------------------------------------------------------------*/
 
 TASK_QUEUE_DATA* CreateTaskQueue(unsigned int queueId)
+{
+    return CreateTaskQueueWithOptions(queueId, NULL);
+}
+
+TASK_QUEUE_DATA* CreateTaskQueueWithOptions(unsigned int queueId, const TASK_QUEUE_OPTIONS *queueOptions)
 {
     // define task queue data
     TASK_QUEUE_DATA *taskQueueData = (TASK_QUEUE_DATA*)malloc(sizeof(TASK_QUEUE_DATA));
@@ -181,13 +832,36 @@ TASK_QUEUE_DATA* CreateTaskQueue(unsigned int queueId)
     // initialize task queue
     memset(taskQueue, 0, sizeof(TASK_QUEUE));
 
-    // initialize the queue mutex and cond
+    // nodes are recycled through a pool
+    taskQueue->nodePool = GetMemoryPool(sizeof(TASK_QUEUE_NODE));
+
+    // store capacity and drain notification
+    if(queueOptions != NULL)
+    {
+        taskQueue->queueCapacity = queueOptions->queueCapacity;
+        taskQueue->queueLowWaterMark = queueOptions->queueLowWaterMark;
+        taskQueue->queueDrainCallback = queueOptions->queueDrainCallback;
+        taskQueue->queueDrainContext = queueOptions->queueDrainContext;
+    }
+
+    // create the ring if requested
+    if((queueOptions != NULL) && (queueOptions->queueType == TASK_QUEUE_TYPE_RING))
+    {
+        taskQueue->queueType = TASK_QUEUE_TYPE_RING;
+        taskQueue->queueRing = CreateQueueRing(queueOptions->queueCapacity > 0 ?
+            queueOptions->queueCapacity :
+            TASK_QUEUE_DEFAULT_RING_CAPACITY);
+    }
+    else if((queueOptions != NULL) && (queueOptions->queueType == TASK_QUEUE_TYPE_FAIR))
+    {
+        taskQueue->queueType = TASK_QUEUE_TYPE_FAIR;
+    }
+
+    // initialize the queue mutex
     SyncCreateMutex(&(taskQueue->queueMutex), NULL);
-    SyncCreateCond(&(taskQueue->queueCond), NULL);
 
     // set task queue data references
     taskQueueData->taskQueue = taskQueue;
-    taskQueueData->queueCond = &(taskQueue->queueCond);
     taskQueueData->queueMutex = &(taskQueue->queueMutex);
 
     // store the queue id
@@ -198,36 +872,222 @@ TASK_QUEUE_DATA* CreateTaskQueue(unsigned int queueId)
 
 void DestroyTaskQueue(TASK_QUEUE_DATA *taskQueueData)
 {
+    // loop variable
+    unsigned int i = 0;
+
+    // tenant to be released
+    TASK_QUEUE_TENANT *queueTenant = 0;
+
     // flush the queue
     FlushTaskQueue(taskQueueData);
 
-    // destroy the queue mutex and conditional
-    SyncDestroyCond(taskQueueData->queueCond);
+    // release the tenants that were kept for their configuration (or because their tasks are still executing)
+    for(i = 0; i < TASK_QUEUE_TENANT_BUCKETS; i++)
+    {
+        while((queueTenant = taskQueueData->taskQueue->tenantBuckets[i]) != 0)
+        {
+            taskQueueData->taskQueue->tenantBuckets[i] = queueTenant->nextTenant;
+            free(queueTenant);
+        }
+    }
+
+    // destroy the queue mutex
     SyncDestroyMutex(taskQueueData->queueMutex);
 
+    // release ring memory
+    if(taskQueueData->taskQueue->queueRing != 0)
+    {
+        free(taskQueueData->taskQueue->queueRing->ringCells);
+        free(taskQueueData->taskQueue->queueRing);
+    }
+
     // release task queue memory
     free(taskQueueData->taskQueue);
     free(taskQueueData);
 }
 
 TASK_QUEUE_STATUS AddTaskToQueue(TASK_QUEUE_DATA *taskQueueData, TASK_QUEUE_ITEM *taskQueueItem)
+{
+    return AddTasksToQueue(taskQueueData, &taskQueueItem, 1, NULL);
+}
+
+TASK_QUEUE_STATUS AddTasksToQueue(TASK_QUEUE_DATA *taskQueueData, TASK_QUEUE_ITEM **taskQueueItems, unsigned int numItems, unsigned int *numAdded)
 {
     // return value
     TASK_QUEUE_STATUS   addStatus = TASK_QUEUE_STATUS_ADD_SUCCESS;
 
-    // lock access to the queue
+    // number of items added
+    unsigned int        i = 0;
+
+    // time the items are queued (used to measure queue wait)
+    unsigned long long  queueTime = SyncGetTime();
+    for(i = 0; i < numItems; i++)
+    {
+        taskQueueItems[i]->taskQueueTime = queueTime;
+    }
+
+    // ring queues are only locked to wake waiting threads
+    if(taskQueueData->taskQueue->queueType == TASK_QUEUE_TYPE_RING)
+    {
+        for(i = 0; (i < numItems) && (addStatus == TASK_QUEUE_STATUS_ADD_SUCCESS); i++)
+        {
+            addStatus = EnqueueRingItem(taskQueueData->taskQueue->queueRing, taskQueueItems[i]);
+        }
+        if(addStatus != TASK_QUEUE_STATUS_ADD_SUCCESS)
+        {
+            i--;
+        }
+
+        // the items must be visible before checking for waiting threads (see WaitTaskQueue)
+        SyncMemoryBarrier();
+        if((i > 0) && (SyncAtomicLoad(&(taskQueueData->taskQueue->waitingThreads)) > 0))
+        {
+            SyncLockMutex(taskQueueData->queueMutex);
+            SignalTaskQueue(taskQueueData, i);
+            SyncUnlockMutex(taskQueueData->queueMutex);
+        }
+    }
+    else
+    {
+        // number of ready nodes before the batch (nodes of a tenant at its concurrency limit wake no thread)
+        int readyLength = 0;
+
+        // lock access to the queue
+        SyncLockMutex(taskQueueData->queueMutex);
+        readyLength = taskQueueData->taskQueue->readyLength;
+
+        // link the whole batch
+        for(i = 0; (i < numItems) && (addStatus == TASK_QUEUE_STATUS_ADD_SUCCESS); i++)
+        {
+            addStatus = AddTaskToQueueInternal(taskQueueData, taskQueueItems[i]);
+        }
+        if(addStatus != TASK_QUEUE_STATUS_ADD_SUCCESS)
+        {
+            i--;
+        }
+
+        // signal update to queue
+        SignalTaskQueue(taskQueueData, (taskQueueData->taskQueue->queueType == TASK_QUEUE_TYPE_FAIR) ?
+            (unsigned int)(taskQueueData->taskQueue->readyLength - readyLength) :
+            i);
+
+        // unlock access to the queue
+        SyncUnlockMutex(taskQueueData->queueMutex);
+    }
+
+    // mark the drain as pending, the queue may have drained before it was marked
+    if(addStatus == TASK_QUEUE_STATUS_ADD_FULL_FAIL)
+    {
+        SyncAtomicStore(&(taskQueueData->taskQueue->drainPending), 1);
+        SyncMemoryBarrier();
+        CheckTaskQueueDrain(taskQueueData);
+    }
+
+    if(numAdded != NULL)
+    {
+        *numAdded = i;
+    }
+
+    return addStatus;
+}
+
+int SetTaskQueueTenant(TASK_QUEUE_DATA *taskQueueData, unsigned int tenantId, unsigned int tenantWeight, unsigned int maxRunning)
+{
+    // tenant being configured
+    TASK_QUEUE_TENANT *queueTenant = 0;
+
+    // reference to the queue
+    TASK_QUEUE *taskQueue = taskQueueData->taskQueue;
+
+    // set if the tenant's nodes could be taken before it was configured
+    int wasReady = 0;
+
+    if(taskQueue->queueType != TASK_QUEUE_TYPE_FAIR)
+    {
+        return -1;
+    }
+
     SyncLockMutex(taskQueueData->queueMutex);
 
-    // add task item to queue
-    addStatus = AddTaskToQueueInternal(taskQueueData, taskQueueItem);
+    queueTenant = GetQueueTenant(taskQueue, tenantId, 1);
+    if(queueTenant == 0)
+    {
+        SyncUnlockMutex(taskQueueData->queueMutex);
+        return -1;
+    }
 
-    // signal update to queue
-    SyncSignalCond(taskQueueData->queueCond);
+    wasReady = IsTenantReady(queueTenant);
+    queueTenant->tenantWeight = (tenantWeight > 0) ? tenantWeight : TASK_QUEUE_DEFAULT_TENANT_WEIGHT;
+    queueTenant->maxRunning = maxRunning;
+    queueTenant->isConfigured = 1;
+
+    // a raised limit may make the tenant's nodes ready, a lowered one holds them back (inactive tenants are skipped lazily)
+    if(!wasReady && IsTenantReady(queueTenant))
+    {
+        taskQueue->readyLength += (int)queueTenant->numQueued;
+        ActivateTenant(taskQueue, queueTenant);
+        SignalTaskQueue(taskQueueData, queueTenant->numQueued);
+    }
+    else if(wasReady && !IsTenantReady(queueTenant))
+    {
+        taskQueue->readyLength -= (int)queueTenant->numQueued;
+    }
 
-    // unlock access to the queue
     SyncUnlockMutex(taskQueueData->queueMutex);
 
-    return addStatus;
+    return 0;
+}
+
+TASK_QUEUE_ITEM* RemoveTaskFromQueue(TASK_QUEUE_DATA *taskQueueData, unsigned int taskId, void *taskItemData)
+{
+    // loop variable
+    unsigned int i = 0;
+
+    // node holding the item
+    TASK_QUEUE_NODE *queueNode = 0;
+
+    // item to be returned
+    TASK_QUEUE_ITEM *taskQueueItem = 0;
+
+    // reference to the queue
+    TASK_QUEUE *taskQueue = taskQueueData->taskQueue;
+
+    // ring cells cannot be unlinked
+    if(taskQueue->queueType == TASK_QUEUE_TYPE_RING)
+    {
+        return 0;
+    }
+
+    SyncLockMutex(taskQueueData->queueMutex);
+
+    if(taskQueue->queueType == TASK_QUEUE_TYPE_FAIR)
+    {
+        queueNode = UnlinkFairNode(taskQueue, taskId, taskItemData);
+    }
+    else
+    {
+        for(i = 0; (i < TASK_QUEUE_NUM_PRIORITIES) && (queueNode == 0); i++)
+        {
+            queueNode = UnlinkListNode(&(taskQueue->queueHead[i]), &(taskQueue->queueTail[i]), taskId, taskItemData);
+        }
+    }
+
+    if(queueNode != 0)
+    {
+        taskQueue->queueLength--;
+        taskQueueItem = queueNode->taskQueueItem;
+        FreeQueueNode(taskQueue, queueNode);
+    }
+
+    SyncUnlockMutex(taskQueueData->queueMutex);
+
+    // the freed slot counts towards the drain
+    if(taskQueueItem != 0)
+    {
+        CheckTaskQueueDrain(taskQueueData);
+    }
+
+    return taskQueueItem;
 }
 
 void FlushTaskQueue(TASK_QUEUE_DATA *taskQueueData)
@@ -244,37 +1104,206 @@ void FlushTaskQueue(TASK_QUEUE_DATA *taskQueueData)
 
 TASK_QUEUE_ITEM* GetTaskQueueItem(TASK_QUEUE_DATA *taskQueueData)
 {
+    // task queue item to be returned
+    TASK_QUEUE_ITEM *taskQueueItem = 0;
+
+    GetTaskQueueItems(taskQueueData, &taskQueueItem, 1);
+
+    return taskQueueItem;
+}
+
+unsigned int GetTaskQueueItems(TASK_QUEUE_DATA *taskQueueData, TASK_QUEUE_ITEM **taskQueueItems, unsigned int maxItems)
+{
+    // number of items returned
+    unsigned int numItems = 0;
+
     // node to be processed
     TASK_QUEUE_NODE *queueNode = 0;
 
-    // task queue item to be returned
-    TASK_QUEUE_ITEM *taskQueueItem = 0;
+    // ring items are handed over as-is
+    if(taskQueueData->taskQueue->queueType == TASK_QUEUE_TYPE_RING)
+    {
+        while((numItems < maxItems) &&
+            ((taskQueueItems[numItems] = DequeueRingItem(taskQueueData->taskQueue->queueRing)) != 0))
+        {
+            numItems++;
+        }
+    }
+    else if(taskQueueData->taskQueue->queueType == TASK_QUEUE_TYPE_FAIR)
+    {
+        while((numItems < maxItems) && (taskQueueData->taskQueue->readyLength > 0))
+        {
+            // get node of the next tenant in turn
+            queueNode = RemoveFairNode(taskQueueData->taskQueue);
+
+            // hand over the item and release queue node memory
+            taskQueueItems[numItems++] = queueNode->taskQueueItem;
+            FreeQueueNode(taskQueueData->taskQueue, queueNode);
+        }
+    }
+    else
+    {
+        while((numItems < maxItems) && (taskQueueData->taskQueue->queueLength > 0))
+        {
+            // get node with the highest (aged) priority
+            queueNode = RemoveQueueNode(taskQueueData->taskQueue);
+
+            // hand over the item and release queue node memory
+            taskQueueItems[numItems++] = queueNode->taskQueueItem;
+            FreeQueueNode(taskQueueData->taskQueue, queueNode);
+        }
+    }
 
-    if(taskQueueData->taskQueue->queueLength > 0)
+    // notify producers waiting for the queue to drain
+    if(numItems > 0)
     {
-        // get node at front of queue
-        queueNode = taskQueueData->taskQueue->queueHead;
+        CheckTaskQueueDrain(taskQueueData);
+    }
 
-        // copy task queue item to return
-        taskQueueItem = (TASK_QUEUE_ITEM*)malloc(sizeof(TASK_QUEUE_ITEM));
-        memcpy(taskQueueItem, queueNode->taskQueueItem, sizeof(TASK_QUEUE_ITEM));
-        taskQueueItem->taskItemData = malloc(queueNode->taskQueueItem->dataSize);
-        memcpy(taskQueueItem->taskItemData, queueNode->taskQueueItem->taskItemData, queueNode->taskQueueItem->dataSize);
+    return numItems;
+}
 
-        // update head node
-        taskQueueData->taskQueue->queueHead = queueNode->nextNode;
+TASK_QUEUE_ITEM* CreateTaskQueueItem()
+{
+    // item to be returned
+    TASK_QUEUE_ITEM *taskQueueItem = 0;
 
-        // release queue node memory
-        FreeQueueNode(queueNode);
+    // items are recycled through a pool
+    MEMORY_POOL *itemPool = GetMemoryPool(sizeof(TASK_QUEUE_ITEM));
+    if(itemPool == 0)
+    {
+        return 0;
+    }
 
-        // decrement length of the queue
-        taskQueueData->taskQueue->queueLength--;
+    taskQueueItem = (TASK_QUEUE_ITEM*)AllocMemoryPoolBlock(itemPool);
+    if(taskQueueItem != 0)
+    {
+        memset(taskQueueItem, 0, sizeof(TASK_QUEUE_ITEM));
     }
 
     return taskQueueItem;
 }
 
+void DestroyTaskQueueItem(TASK_QUEUE_ITEM *taskQueueItem)
+{
+    // release the task item data memory
+    if(taskQueueItem->taskItemData != 0)
+    {
+        if(taskQueueItem->taskItemRelease != 0)
+        {
+            taskQueueItem->taskItemRelease(taskQueueItem->taskItemData);
+        }
+        else
+        {
+            free(taskQueueItem->taskItemData);
+        }
+        taskQueueItem->taskItemData = 0;
+    }
+
+    // release the task item memory
+    FreeMemoryPoolBlock(GetMemoryPool(sizeof(TASK_QUEUE_ITEM)), taskQueueItem);
+}
+
 int GetQueueLength(TASK_QUEUE_DATA *taskQueueData)
 {
+    // positions of the ring (dequeue is read first so the length can't go negative)
+    unsigned long dequeuePosition = 0;
+    unsigned long enqueuePosition = 0;
+
+    if(taskQueueData->taskQueue->queueType == TASK_QUEUE_TYPE_RING)
+    {
+        dequeuePosition = (unsigned long)SyncAtomicLoad(&(taskQueueData->taskQueue->queueRing->dequeuePosition));
+        enqueuePosition = (unsigned long)SyncAtomicLoad(&(taskQueueData->taskQueue->queueRing->enqueuePosition));
+        return (int)(enqueuePosition - dequeuePosition);
+    }
+
+    // nodes of a tenant at its concurrency limit can't be taken yet
+    if(taskQueueData->taskQueue->queueType == TASK_QUEUE_TYPE_FAIR)
+    {
+        return taskQueueData->taskQueue->readyLength;
+    }
+
     return taskQueueData->taskQueue->queueLength;
-}
\ No newline at end of file
+}
+
+int IsTaskQueueLockFree(TASK_QUEUE_DATA *taskQueueData)
+{
+    return (taskQueueData->taskQueue->queueType == TASK_QUEUE_TYPE_RING);
+}
+
+void WaitTaskQueue(TASK_QUEUE_DATA *taskQueueData, SYNC_WAITER *queueWaiter)
+{
+    WaitTaskQueueTimed(taskQueueData, queueWaiter, 0);
+}
+
+int WaitTaskQueueTimed(TASK_QUEUE_DATA *taskQueueData, SYNC_WAITER *queueWaiter, unsigned int timeoutMs)
+{
+    // set if the timeout elapsed before the queue was signaled
+    int timedOut = 0;
+
+    // register as waiting before checking the length one last time, a lock-free producer
+    // will either see this thread waiting or this thread will see the produced item
+    SyncAtomicIncrement(&(taskQueueData->taskQueue->waitingThreads));
+    if(GetQueueLength(taskQueueData) == 0)
+    {
+        timedOut = SyncWaitList(&(taskQueueData->taskQueue->queueWaiters), queueWaiter, taskQueueData->queueMutex, timeoutMs);
+    }
+    SyncAtomicDecrement(&(taskQueueData->taskQueue->waitingThreads));
+
+    return timedOut;
+}
+
+void WakeTaskQueue(TASK_QUEUE_DATA *taskQueueData)
+{
+    SyncWakeAllWaiters(&(taskQueueData->taskQueue->queueWaiters));
+}
+
+int WakeTaskQueueWaiter(TASK_QUEUE_DATA *taskQueueData, SYNC_WAITER *queueWaiter)
+{
+    // the most recently parked waiter when none is given
+    if(queueWaiter == 0)
+    {
+        return (int)SyncWakeWaiters(&(taskQueueData->taskQueue->queueWaiters), 1);
+    }
+
+    return SyncWakeWaiter(&(taskQueueData->taskQueue->queueWaiters), queueWaiter);
+}
+
+void ReleaseTaskQueueTenant(TASK_QUEUE_DATA *taskQueueData, TASK_QUEUE_ITEM *taskQueueItem)
+{
+    // tenant of the completed task
+    TASK_QUEUE_TENANT *queueTenant = 0;
+
+    // reference to the queue
+    TASK_QUEUE *taskQueue = taskQueueData->taskQueue;
+
+    // tenant's queued nodes were ready before the task completed
+    int wasReady = 0;
+
+    // only tasks of tenants with a concurrency limit are counted
+    if(!taskQueueItem->taskTenantRunning)
+    {
+        return;
+    }
+    taskQueueItem->taskTenantRunning = 0;
+
+    SyncLockMutex(taskQueueData->queueMutex);
+
+    // a counted task keeps its tenant from being released
+    queueTenant = GetQueueTenant(taskQueue, taskQueueItem->taskTenant, 0);
+    if((queueTenant != 0) && (queueTenant->numRunning > 0))
+    {
+        // the tenant's queued nodes become ready once it drops below its limit
+        wasReady = IsTenantReady(queueTenant);
+        queueTenant->numRunning--;
+        if(!wasReady && IsTenantReady(queueTenant))
+        {
+            taskQueue->readyLength += (int)queueTenant->numQueued;
+            ActivateTenant(taskQueue, queueTenant);
+            SignalTaskQueue(taskQueueData, 1);
+        }
+        ReleaseIdleTenant(taskQueue, queueTenant);
+    }
+
+    SyncUnlockMutex(taskQueueData->queueMutex);
+}
@@ -6,17 +6,46 @@
 /*---------------------------------------------------------------------------*/
 
 #include "synchronize.h"
+#include "memory_pool.h"
 
 /*---------------------------------------------------------------------------*/
 /* MACRO DEFINITIONS */
 /*---------------------------------------------------------------------------*/
 
-/* N/A */
+// default capacity of a ring task queue when none is specified
+#define TASK_QUEUE_DEFAULT_RING_CAPACITY    1024
+
+// number of priority levels of a list task queue (0 is the highest priority)
+#define TASK_QUEUE_NUM_PRIORITIES           8
+
+// priority of a task when none is specified
+#define TASK_QUEUE_DEFAULT_PRIORITY         4
+
+// number of tasks queued after a task that raise it by one priority level (prevents starvation)
+#define TASK_QUEUE_AGING_INTERVAL           64
+
+// number of tasks a tenant of a fair task queue takes per round when no weight is set
+#define TASK_QUEUE_DEFAULT_TENANT_WEIGHT    1
 
 /*---------------------------------------------------------------------------*/
 /* ENUMERATIONS */
 /*---------------------------------------------------------------------------*/
 
+// underlying implementation of a task queue
+typedef enum TASK_QUEUE_TYPE_ENUM
+{
+    // unbounded mutex guarded linked list
+    TASK_QUEUE_TYPE_LIST = 0,
+
+    // fixed capacity lock-free multi-producer/multi-consumer ring buffer
+    TASK_QUEUE_TYPE_RING,
+
+    // mutex guarded linked list per tenant, tenants are served by weighted deficit round-robin
+    // (only tasks taken from the task queue itself are shared fairly, use it with the shared scheduler)
+    TASK_QUEUE_TYPE_FAIR
+
+} TASK_QUEUE_TYPE;
+
 // success/fail of adding a task item to the queue
 typedef enum TASK_QUEUE_STATUS_ENUM
 {
@@ -55,20 +84,60 @@ typedef struct TASK_QUEUE_ITEM_STRUCT
     // reference to work item function
     void*           (*taskItemFunction)(TASK_QUEUE_WORK_DATA *taskData, void *threadContext, void *workData);
 
-    // reference to work item callback function
+    // reference to work item callback function (when present it takes ownership of the work item context)
     void            (*taskItemCallback)(TASK_QUEUE_WORK_DATA *taskData, void *threadContext, void *callbackData);
 
     // reference to work item context (this will be passed to the work item function)
     void            *taskItemData;
 
+    // releases the work item context when the item is destroyed without a callback taking ownership (free() if not set)
+    void            (*taskItemRelease)(void *workData);
+
     // size (bytes) of the work item context
     unsigned int    dataSize;
 
     // id of task
     unsigned int    taskId;
 
+    // priority of task (0 is the highest, only used by list queues)
+    unsigned int    taskPriority;
+
+    // time (ms) the task was added to a queue (set by the queue)
+    unsigned long long taskQueueTime;
+
+    // key of the state the task warms up on the thread executing it (only used by the affinity scheduler)
+    unsigned int    taskAffinityKey;
+    int             taskHasAffinity;
+
+    // tenant the task is queued for (only used by fair queues)
+    unsigned int    taskTenant;
+
+    // set while the task counts against the concurrency limit of its tenant (set by the queue)
+    int             taskTenantRunning;
+
 } TASK_QUEUE_ITEM;
 
+// use this structure to configure a task queue when it is created
+typedef struct TASK_QUEUE_OPTIONS_STRUCT
+{
+    // underlying implementation of the queue
+    TASK_QUEUE_TYPE queueType;
+
+    // maximum number of items within the queue (ring queues round up to a power of 2, 0 is unbounded for list queues)
+    unsigned int    queueCapacity;
+
+    // after an item was rejected because the queue was full, the drain callback is
+    // called once the number of items within the queue falls to this value
+    unsigned int    queueLowWaterMark;
+
+    // drain callback, called from the thread that removed an item (optional)
+    void            (*queueDrainCallback)(void *drainContext);
+
+    // reference passed to the drain callback
+    void            *queueDrainContext;
+
+} TASK_QUEUE_OPTIONS;
+
 // forward declaration to hide implementation
 typedef struct TASK_QUEUE_STRUCT TASK_QUEUE;
 
@@ -78,7 +147,6 @@ typedef struct TASK_QUEUE_DATA_STRUCT
     // this is the only member that should ever be accessed as read-only
     unsigned int                queueId;
 
-    THREAD_COND                 *queueCond;
     THREAD_MUTEX                *queueMutex;
     TASK_QUEUE                  *taskQueue;
 
@@ -96,15 +164,36 @@ extern "C" {
 // should only be called during application startup
 TASK_QUEUE_DATA*    CreateTaskQueue(unsigned int queueId);
 
+// should only be called during application startup (NULL options creates a list queue)
+TASK_QUEUE_DATA*    CreateTaskQueueWithOptions(unsigned int queueId, const TASK_QUEUE_OPTIONS *queueOptions);
+
 // should only be called once per task queue and after destroying the associated thread pool
 void                DestroyTaskQueue(TASK_QUEUE_DATA *taskQueueData);
 
 // thread safe
 TASK_QUEUE_STATUS   AddTaskToQueue(TASK_QUEUE_DATA *taskQueueData, TASK_QUEUE_ITEM *taskQueueItem);
 
+// thread safe, adds the items in order with a single lock until one is rejected
+// numAdded (optional) receives the number of items added, the caller keeps ownership of the rest
+TASK_QUEUE_STATUS   AddTasksToQueue(TASK_QUEUE_DATA *taskQueueData, TASK_QUEUE_ITEM **taskQueueItems, unsigned int numItems, unsigned int *numAdded);
+
+// thread safe, unlinks the queued item with the given task id and context from a list or fair queue,
+// returns it to the caller (0 if it is not queued, ring queues never return an item)
+TASK_QUEUE_ITEM*    RemoveTaskFromQueue(TASK_QUEUE_DATA *taskQueueData, unsigned int taskId, void *taskItemData);
+
 // thread safe
 void                FlushTaskQueue(TASK_QUEUE_DATA *taskQueueData);
 
+// thread safe, sets how many tasks a tenant of a fair queue takes per round (0 restores the default)
+// and how many of its tasks may execute at once (0 is unlimited), returns -1 if the queue is not fair
+int                 SetTaskQueueTenant(TASK_QUEUE_DATA *taskQueueData, unsigned int tenantId, unsigned int tenantWeight, unsigned int maxRunning);
+
+// thread safe, allocates a zeroed item from a pool (0 if memory could not be allocated)
+TASK_QUEUE_ITEM*    CreateTaskQueueItem();
+
+// thread safe, releases the work item context and returns the item to its pool
+void                DestroyTaskQueueItem(TASK_QUEUE_ITEM *taskQueueItem);
+
 #ifdef __cplusplus
 }
 #endif
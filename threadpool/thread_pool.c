@@ -11,23 +11,72 @@
 #include <string.h>
 
 #include "synchronize.h"
+#include "timer_wheel.h"
 
 /*---------------------------------------------------------------------------*/
 /* MACRO DEFINITIONS */
 /*---------------------------------------------------------------------------*/
 
-/* N/A */
+// number of items each thread's deque can hold (power of 2)
+#define THREAD_DEQUE_CAPACITY           1024
+
+// number of items each thread's inbox can hold before submissions overflow to the task queue
+#define THREAD_INBOX_CAPACITY           256
+
+// maximum number of items moved from a thread's inbox to its deque at once
+#define THREAD_INBOX_TRANSFER_SIZE      32
+
+// lower bound of the adaptive spin of a thread
+#define THREAD_MIN_SPIN_COUNT           64
+
+// state of each thread slot of the pool
+#define THREAD_SLOT_FREE                0
+#define THREAD_SLOT_RUNNING             1
+#define THREAD_SLOT_EXITED              2
 
 /*---------------------------------------------------------------------------*/
 /* TYPE DECLARATIONS */
 /*---------------------------------------------------------------------------*/
 
+// fixed capacity Chase-Lev work stealing deque
+// the owning thread pushes and pops at the bottom, other threads steal from the top
+// http://www.di.ens.fr/~zappa/readings/ppopp13.pdf
+typedef struct THREAD_DEQUE_STRUCT
+{
+    char                        dequePadding0[SYNC_CACHE_LINE_SIZE];
+
+    // array of item references (read-only after creation)
+    TASK_QUEUE_ITEM* volatile   *dequeItems;
+
+    char                        dequePadding1[SYNC_CACHE_LINE_SIZE];
+
+    // position of the next item to be stolen
+    THREAD_ATOMIC               dequeTop;
+
+    char                        dequePadding2[SYNC_CACHE_LINE_SIZE];
+
+    // position of the next item to be pushed by the owner
+    THREAD_ATOMIC               dequeBottom;
+
+    char                        dequePadding3[SYNC_CACHE_LINE_SIZE];
+
+} THREAD_DEQUE;
+
 // context per thread
 typedef struct THREAD_DATA_STRUCT
 {
     // task queue and thread information
     TASK_QUEUE_WORK_DATA    *taskQueueWorkData;
 
+    // reference to the thread pool
+    THREAD_POOL_DATA        *threadPool;
+
+    // index of the thread within the pool
+    unsigned int            threadIndex;
+
+    // state of the random victim selection (work stealing scheduler only)
+    unsigned int            randomState;
+
     // reference to thread's pool terminate signal
     unsigned int            *terminateThread;
 
@@ -46,16 +95,98 @@ typedef struct THREAD_DATA_STRUCT
     // reference to destroy method
     void                    (*destroy)(void* context);
 
+    // parks the thread while it waits for tasks
+    SYNC_WAITER             threadWaiter;
+
+    // number of checks for tasks while spinning, adapted to how often spinning finds a task
+    unsigned int            spinLimit;
+
 } THREAD_DATA;
 
+// affinity state of each thread (affinity scheduler only)
+typedef struct THREAD_AFFINITY_SLOT_STRUCT
+{
+    // affinity keys (plus one, 0 is empty) of the tasks the thread executed, open addressing
+    // written by the thread only, read by submitters
+    THREAD_ATOMIC           warmKeys[THREAD_POOL_MAX_WARM_KEYS];
+    unsigned int            numWarmKeys;
+
+    // set while the thread waits for tasks
+    THREAD_ATOMIC           threadIdle;
+
+    // time (ms) the thread's inbox last went from empty to non-empty (0 while it is empty)
+    THREAD_ATOMIC           inboxTime;
+
+    // parks the thread, woken when a task is routed to it
+    SYNC_WAITER             *threadWaiter;
+
+} THREAD_AFFINITY_SLOT;
+
+// position of a processor within the topology
+typedef struct THREAD_PROCESSOR_STRUCT
+{
+    unsigned int            processorId;
+    unsigned int            packageId;
+    unsigned int            coreId;
+
+    // index of the core within its package and of the processor within its core
+    unsigned int            coreRank;
+    unsigned int            siblingRank;
+
+} THREAD_PROCESSOR;
+
 // context per thread pool
 struct THREAD_POOL_DATA_STRUCT
 {
-    // stores number of threads within pool
+    // stores the maximum number of threads within pool
     unsigned int        numThreads;
 
-    // array of pthread references
+    // array of pthread references and the state of each slot
     THREAD              *threadIds;
+    THREAD_ATOMIC       *threadStates;
+
+    // number of running threads, threads above the retire threshold exit after their current batch
+    THREAD_ATOMIC       liveThreads;
+    THREAD_ATOMIC       retireThreshold;
+
+    // number of checks for tasks while spinning and yielding before a thread parks
+    unsigned int        spinCount;
+    unsigned int        yieldCount;
+
+    // elastic sizing (shared scheduler only)
+    unsigned int        minThreads;
+    unsigned int        idleTimeout;
+    unsigned int        spawnWaitTime;
+
+    // time (ms) the last batch waited within the queue and when tasks were last taken
+    THREAD_ATOMIC       queueWaitTime;
+    THREAD_ATOMIC       lastDequeueTime;
+
+    // when the last thread was spawned to absorb load (protected by spawnMutex)
+    unsigned long long  lastSpawnTime;
+
+    // thread callbacks, kept to spawn threads after creation
+    void*               (*threadInit)();
+    void                (*threadPostInit)(void *threadContext);
+    void                (*threadDestroy)(void *threadContext);
+
+    // serializes spawning and joining threads
+    THREAD_MUTEX        spawnMutex;
+
+    // thread that created the pool, the only one that spawns threads to absorb load
+    // (threadInit may need to run on it, tasks are also added by threads of the pool and the timer wheel)
+    unsigned int        ownerThreadId;
+
+    // processors of the pool in placement order (NULL leaves threads unbound)
+    THREAD_POOL_AFFINITY affinityPolicy;
+    unsigned int        *processorIds;
+    unsigned int        numProcessors;
+
+    // size (bytes) of each thread's stack (0 uses the default)
+    size_t              stackSize;
+
+    // prefix of the thread names (empty leaves threads unnamed)
+    char                threadName[THREAD_POOL_MAX_NAME_LENGTH + 1];
 
     // thread pool's terminate signal
     unsigned int        terminateThread;
@@ -63,6 +194,47 @@ struct THREAD_POOL_DATA_STRUCT
     // reference to the task queue of the pool
     TASK_QUEUE_DATA     *taskQueueData;
 
+    // how tasks are distributed to the threads
+    THREAD_POOL_SCHEDULER schedulerType;
+
+    // maximum number of tasks a thread takes at once
+    unsigned int        maxBatchSize;
+
+    // called around each batch of tasks
+    void                (*threadBatchEnter)(void *threadContext);
+    void                (*threadBatchExit)(void *threadContext);
+
+    // per-thread submission queues (rings for the work stealing scheduler, lists for the affinity scheduler)
+    // and deques (work stealing scheduler only)
+    TASK_QUEUE_DATA     **inboxQueues;
+    THREAD_DEQUE        **taskDeques;
+
+    // per-thread warm keys, the time tasks wait for them and the number of tasks within the inboxes (affinity scheduler only)
+    THREAD_AFFINITY_SLOT *affinitySlots;
+    unsigned int        affinityWaitTime;
+    THREAD_ATOMIC       routedTasks;
+
+    // next thread to receive a submission
+    THREAD_ATOMIC       nextThread;
+
+    // number of tasks submitted but not yet taken by a thread
+    THREAD_ATOMIC       pendingTasks;
+
+    // items taken by threads that were told to terminate, destroyed by the thread destroying the pool
+    // (protected by poolMutex, each thread slot hands back at most one batch)
+    TASK_QUEUE_ITEM     **abandonedItems;
+    unsigned int        numAbandoned;
+
+    // number of threads parked (registered before they check for tasks one last time)
+    THREAD_ATOMIC       waitingThreads;
+
+    // synchronization mechanisms used to park idle threads (work stealing scheduler only)
+    SYNC_WAIT_LIST      poolWaiters;
+    THREAD_MUTEX        poolMutex;
+
+    // delayed tasks, the wheel is created by the first one
+    TIMER_WHEEL* volatile timerWheel;
+
 }; /* THREAD_POOL_DATA */
 
 /*---------------------------------------------------------------------------*/
@@ -75,7 +247,14 @@ struct THREAD_POOL_DATA_STRUCT
 /*---------------------------------------------------------------------------*/
 
 extern TASK_QUEUE_ITEM*    GetTaskQueueItem(TASK_QUEUE_DATA *taskQueueData);
+extern unsigned int        GetTaskQueueItems(TASK_QUEUE_DATA *taskQueueData, TASK_QUEUE_ITEM **taskQueueItems, unsigned int maxItems);
 extern int                 GetQueueLength(TASK_QUEUE_DATA *taskQueueData);
+extern int                 IsTaskQueueLockFree(TASK_QUEUE_DATA *taskQueueData);
+extern void                WaitTaskQueue(TASK_QUEUE_DATA *taskQueueData, SYNC_WAITER *queueWaiter);
+extern int                 WaitTaskQueueTimed(TASK_QUEUE_DATA *taskQueueData, SYNC_WAITER *queueWaiter, unsigned int timeoutMs);
+extern void                WakeTaskQueue(TASK_QUEUE_DATA *taskQueueData);
+extern int                 WakeTaskQueueWaiter(TASK_QUEUE_DATA *taskQueueData, SYNC_WAITER *queueWaiter);
+extern void                ReleaseTaskQueueTenant(TASK_QUEUE_DATA *taskQueueData, TASK_QUEUE_ITEM *taskQueueItem);
 
 /*---------------------------------------------------------------------------*/
 /* OBJECT DECLARATIONS */
@@ -85,181 +264,1792 @@ extern int                 GetQueueLength(TASK_QUEUE_DATA *taskQueueData);
 /* STATIC FUNCTION DEFINITIONS */
 /*---------------------------------------------------------------------------*/
 
-// individual thread function
-static THREAD_FUNC WINAPI threadFunction(void *threadArg)
+static THREAD_DEQUE* CreateThreadDeque()
 {
-    // task item function return data reference
-    void* taskData = 0;
+    // create deque
+    THREAD_DEQUE *taskDeque = (THREAD_DEQUE*)malloc(sizeof(THREAD_DEQUE));
+    memset(taskDeque, 0, sizeof(THREAD_DEQUE));
 
-    // local reference to task queue item to be worked
-    TASK_QUEUE_ITEM *taskQueueItem = 0;
+    // create item array
+    taskDeque->dequeItems = (TASK_QUEUE_ITEM* volatile*)malloc(THREAD_DEQUE_CAPACITY * sizeof(TASK_QUEUE_ITEM*));
+    memset((void*)taskDeque->dequeItems, 0, THREAD_DEQUE_CAPACITY * sizeof(TASK_QUEUE_ITEM*));
 
-    // store thread context data locally and update thread id
-    THREAD_DATA *threadData = (THREAD_DATA*)threadArg;
-    threadData->taskQueueWorkData->threadId = SyncGetThreadId();
+    return taskDeque;
+}
 
-    // execute post initialize if set
-    if(threadData->postInit != NULL)
+static void DestroyThreadDeque(THREAD_DEQUE *taskDeque)
+{
+    free((void*)taskDeque->dequeItems);
+    free(taskDeque);
+}
+
+// number of items that can still be pushed (owner only)
+static unsigned long GetThreadDequeSpace(THREAD_DEQUE *taskDeque)
+{
+    unsigned long dequeTop = (unsigned long)SyncAtomicLoad(&(taskDeque->dequeTop));
+    unsigned long dequeBottom = (unsigned long)taskDeque->dequeBottom;
+
+    return THREAD_DEQUE_CAPACITY - (dequeBottom - dequeTop);
+}
+
+// owner only
+static int PushThreadDeque(THREAD_DEQUE *taskDeque, TASK_QUEUE_ITEM *taskQueueItem)
+{
+    unsigned long dequeBottom = (unsigned long)taskDeque->dequeBottom;
+
+    // deque is full
+    if(GetThreadDequeSpace(taskDeque) == 0)
     {
-        //fprintf(stdout, "[%u] threadFunction - postInit\n", SyncGetThreadId());
-        threadData->postInit(threadData->context);
+        return 0;
     }
 
-    // continue until termination signaled
-    while(!*(threadData->terminateThread))
+    // store the item and publish it to thieves
+    taskDeque->dequeItems[dequeBottom & (THREAD_DEQUE_CAPACITY - 1)] = taskQueueItem;
+    SyncAtomicStore(&(taskDeque->dequeBottom), (long)(dequeBottom + 1));
+
+    return 1;
+}
+
+// owner only
+static TASK_QUEUE_ITEM* PopThreadDeque(THREAD_DEQUE *taskDeque)
+{
+    // item to be returned
+    TASK_QUEUE_ITEM *taskQueueItem = 0;
+
+    // reserve the bottom item before looking at the top
+    unsigned long dequeBottom = (unsigned long)taskDeque->dequeBottom - 1;
+    unsigned long dequeTop = 0;
+    SyncAtomicStore(&(taskDeque->dequeBottom), (long)dequeBottom);
+    SyncMemoryBarrier();
+    dequeTop = (unsigned long)SyncAtomicLoad(&(taskDeque->dequeTop));
+
+    // deque is not empty
+    if((long)(dequeBottom - dequeTop) >= 0)
     {
-        // lock the queue before checking if there is work to be done
-        SyncLockMutex(threadData->taskQueueData->queueMutex);
+        taskQueueItem = taskDeque->dequeItems[dequeBottom & (THREAD_DEQUE_CAPACITY - 1)];
 
-        // continue while not terminating AND no work (needed for spurious wake-ups)
-        while(!*(threadData->terminateThread) && (GetQueueLength(threadData->taskQueueData) == 0))
+        // last item, race against thieves for it
+        if(dequeBottom == dequeTop)
         {
-            //printf("Thread [%u] is waiting....\n", (unsigned int)threadData->taskQueueWorkData->threadId);
-            SyncWaitCond(threadData->taskQueueData->queueCond, threadData->taskQueueData->queueMutex);
+            if((unsigned long)SyncAtomicCompareExchange(&(taskDeque->dequeTop), (long)(dequeTop + 1), (long)dequeTop) != dequeTop)
+            {
+                taskQueueItem = 0;
+            }
+            SyncAtomicStore(&(taskDeque->dequeBottom), (long)(dequeBottom + 1));
         }
+    }
+    // deque is empty, restore the bottom
+    else
+    {
+        SyncAtomicStore(&(taskDeque->dequeBottom), (long)(dequeBottom + 1));
+    }
+
+    return taskQueueItem;
+}
+
+// thread safe
+static TASK_QUEUE_ITEM* StealThreadDeque(THREAD_DEQUE *taskDeque)
+{
+    // item to be returned
+    TASK_QUEUE_ITEM *taskQueueItem = 0;
 
-        // thread is not suppose to terminate
-        if(!*(threadData->terminateThread))
+    // read the top before the bottom
+    unsigned long dequeTop = (unsigned long)SyncAtomicLoad(&(taskDeque->dequeTop));
+    unsigned long dequeBottom = 0;
+    SyncMemoryBarrier();
+    dequeBottom = (unsigned long)SyncAtomicLoad(&(taskDeque->dequeBottom));
+
+    // deque is not empty
+    if((long)(dequeBottom - dequeTop) > 0)
+    {
+        // claim the top item, give up if the owner or another thief took it
+        taskQueueItem = taskDeque->dequeItems[dequeTop & (THREAD_DEQUE_CAPACITY - 1)];
+        if((unsigned long)SyncAtomicCompareExchange(&(taskDeque->dequeTop), (long)(dequeTop + 1), (long)dequeTop) != dequeTop)
         {
-            // get the work item from the queue
-            taskQueueItem = GetTaskQueueItem(threadData->taskQueueData);
+            taskQueueItem = 0;
         }
+    }
 
-        // unlock the queue
-        SyncUnlockMutex(threadData->taskQueueData->queueMutex);
+    return taskQueueItem;
+}
 
-        // check one more time if work should actually be done AND if the task queue item is valid
-        if((taskQueueItem != 0) && !*(threadData->terminateThread))
-        {
-            // store the task id
-            threadData->taskQueueWorkData->taskId = taskQueueItem->taskId;
+// number of tasks to take at once, an equal share of the queued tasks within the batch limit
+static unsigned int GetBatchSize(THREAD_POOL_DATA *threadPool, int queueLength)
+{
+    // number of threads sharing the queue
+    unsigned int numThreads = (unsigned int)SyncAtomicLoad(&(threadPool->liveThreads));
 
-            // execute the task and get the return value
-            taskData = taskQueueItem->taskItemFunction(threadData->taskQueueWorkData, threadData->context, taskQueueItem->taskItemData);
+    // share of the queued tasks
+    unsigned int batchSize = (queueLength > 0) ? (unsigned int)queueLength / (numThreads > 0 ? numThreads : 1) : 0;
 
-            // execute callback if present
-            if(taskQueueItem->taskItemCallback != 0)
-            {
-                taskQueueItem->taskItemCallback(threadData->taskQueueWorkData, threadData->context, taskData);
-            }
+    if(batchSize < 1)
+    {
+        return 1;
+    }
+    if(batchSize > threadPool->maxBatchSize)
+    {
+        return threadPool->maxBatchSize;
+    }
+    return batchSize;
+}
+
+// moves a share of the task queue to the deque of the calling thread
+static void TransferSharedItems(THREAD_POOL_DATA *threadPool, THREAD_DEQUE *taskDeque)
+{
+    // loop variable
+    unsigned int i = 0;
 
-            // release the task item data memory
-            free(taskQueueItem->taskItemData);
-            taskQueueItem->taskItemData = 0;
+    // items being moved
+    TASK_QUEUE_ITEM *taskQueueItems[THREAD_POOL_MAX_BATCH_SIZE];
+    unsigned int    numItems = 0;
 
-            // release the task item memory
-            free(taskQueueItem);
-            taskQueueItem = 0;
+    // reference to the task queue
+    TASK_QUEUE_DATA *taskQueueData = threadPool->taskQueueData;
+
+    if(IsTaskQueueLockFree(taskQueueData))
+    {
+        numItems = GetTaskQueueItems(taskQueueData, taskQueueItems, GetBatchSize(threadPool, GetQueueLength(taskQueueData)));
+    }
+    // only lock the queue if it appears to have items
+    else if(GetQueueLength(taskQueueData) > 0)
+    {
+        SyncLockMutex(taskQueueData->queueMutex);
+        numItems = GetTaskQueueItems(taskQueueData, taskQueueItems, GetBatchSize(threadPool, GetQueueLength(taskQueueData)));
+        SyncUnlockMutex(taskQueueData->queueMutex);
+    }
+
+    // the deque is empty when this is called so it has room for a batch
+    for(i = 0; i < numItems; i++)
+    {
+        PushThreadDeque(taskDeque, taskQueueItems[i]);
+    }
+}
+
+// moves up to maxItems submissions from an inbox to the deque of the calling thread
+static void TransferInboxItems(THREAD_DEQUE *taskDeque, TASK_QUEUE_DATA *inboxQueue, unsigned int maxItems)
+{
+    // loop variable
+    unsigned int i = 0;
+
+    // item being moved
+    TASK_QUEUE_ITEM *taskQueueItem = 0;
+
+    for(i = 0; (i < maxItems) && (GetThreadDequeSpace(taskDeque) > 0); i++)
+    {
+        taskQueueItem = GetTaskQueueItem(inboxQueue);
+        if(taskQueueItem == 0)
+        {
+            break;
         }
+        PushThreadDeque(taskDeque, taskQueueItem);
     }
+}
 
-    // call destroy if set
-    if(threadData->destroy != NULL)
+static TASK_QUEUE_ITEM* GetWorkStealingItem(THREAD_DATA *threadData)
+{
+    // loop variables
+    unsigned int i = 0;
+    unsigned int victimIndex = 0;
+
+    // item to be returned
+    TASK_QUEUE_ITEM *taskQueueItem = 0;
+
+    // references to the pool and the queues of this thread
+    THREAD_POOL_DATA *threadPool = threadData->threadPool;
+    THREAD_DEQUE *taskDeque = threadPool->taskDeques[threadData->threadIndex];
+    TASK_QUEUE_DATA *inboxQueue = threadPool->inboxQueues[threadData->threadIndex];
+
+    // own deque first
+    taskQueueItem = PopThreadDeque(taskDeque);
+
+    // move a batch of submissions from the inbox to the deque so other threads can steal them
+    if(taskQueueItem == 0)
     {
-        threadData->destroy(threadData->context);
+        TransferInboxItems(taskDeque, inboxQueue, THREAD_INBOX_TRANSFER_SIZE);
+        taskQueueItem = PopThreadDeque(taskDeque);
     }
 
-    //printf("Thread [%u] is done!\n", (unsigned int)threadData->taskQueueWorkData->threadId);
+    // submissions that overflowed the inboxes
+    if(taskQueueItem == 0)
+    {
+        TransferSharedItems(threadPool, taskDeque);
+        taskQueueItem = PopThreadDeque(taskDeque);
+    }
 
-    // free up thread data
-    free(threadData->taskQueueWorkData);
-    free(threadData);
+    // steal from the other threads starting at a random victim
+    if(taskQueueItem == 0)
+    {
+        // xorshift
+        threadData->randomState ^= threadData->randomState << 13;
+        threadData->randomState ^= threadData->randomState >> 17;
+        threadData->randomState ^= threadData->randomState << 5;
 
-#ifdef _WIN32
-    // http://msdn.microsoft.com/en-us/library/kdzttdcb(v=vs.110).aspx
-    _endthreadex(0);
-#endif
+        for(i = 0; (i < threadPool->numThreads) && (taskQueueItem == 0); i++)
+        {
+            victimIndex = (threadData->randomState + i) % threadPool->numThreads;
+            if(victimIndex != threadData->threadIndex)
+            {
+                taskQueueItem = StealThreadDeque(threadPool->taskDeques[victimIndex]);
 
-    return THREAD_FUNC_RETURN;
-}
+                // take half a batch of the victim's pending submissions
+                if(taskQueueItem == 0)
+                {
+                    TransferInboxItems(taskDeque, threadPool->inboxQueues[victimIndex], THREAD_INBOX_TRANSFER_SIZE / 2);
+                    taskQueueItem = PopThreadDeque(taskDeque);
+                }
+            }
+        }
+    }
 
-/*---------------------------------------------------------------------------*/
-/* FUNCTION DEFINITIONS */
-/*---------------------------------------------------------------------------*/
+    return taskQueueItem;
+}
 
-THREAD_POOL_DATA* CreateThreadPool(
-    unsigned int numThreads,
-    TASK_QUEUE_DATA *taskQueueData,
-    void* (*threadInit)(void),
-    void (*threadPostInit)(void* threadContext),
-    void (*threadDestory)(void* threadContext))
+static unsigned int GetWorkStealingItems(THREAD_DATA *threadData, TASK_QUEUE_ITEM **taskQueueItems)
 {
-    // loop variable
-    unsigned int i = 0;
+    // number of items returned
+    unsigned int numItems = 0;
 
-    // thread context reference
-    THREAD_DATA *threadData = 0;
+    // number of items to take from the deque
+    unsigned int batchSize = 0;
 
-    // create thread pool
-    THREAD_POOL_DATA *threadPool = (THREAD_POOL_DATA*)malloc(sizeof(THREAD_POOL_DATA));
-    memset(threadPool, 0, sizeof(THREAD_POOL_DATA));
+    // references to the pool and the deque of this thread
+    THREAD_POOL_DATA *threadPool = threadData->threadPool;
+    THREAD_DEQUE *taskDeque = threadPool->taskDeques[threadData->threadIndex];
 
-    // store number of threads
-    threadPool->numThreads = numThreads;
+    taskQueueItems[0] = GetWorkStealingItem(threadData);
+    if(taskQueueItems[0] == 0)
+    {
+        return 0;
+    }
+    numItems = 1;
 
-    // store task queue reference
-    threadPool->taskQueueData = taskQueueData;
+    // take more from the deque while leaving half of it for thieves
+    batchSize = (unsigned int)((THREAD_DEQUE_CAPACITY - GetThreadDequeSpace(taskDeque)) / 2) + 1;
+    if(batchSize > threadPool->maxBatchSize)
+    {
+        batchSize = threadPool->maxBatchSize;
+    }
+    while((numItems < batchSize) && ((taskQueueItems[numItems] = PopThreadDeque(taskDeque)) != 0))
+    {
+        numItems++;
+    }
 
-    // allocate memory for thread ids
-    threadPool->threadIds = (THREAD*)malloc(numThreads * sizeof(THREAD));
+    return numItems;
+}
 
-    // create each thread
-    for(i = 0; i < numThreads; i++)
+// returns 1 if tasks are waiting for the calling thread (a hint, the tasks may be taken by another thread)
+static int HasPendingTasks(THREAD_DATA *threadData)
+{
+    if(threadData->threadPool->schedulerType == THREAD_POOL_SCHEDULER_WORK_STEALING)
+    {
+        return SyncAtomicLoad(&(threadData->threadPool->pendingTasks)) > 0;
+    }
+    if((threadData->threadPool->schedulerType == THREAD_POOL_SCHEDULER_AFFINITY) &&
+        (GetQueueLength(threadData->threadPool->inboxQueues[threadData->threadIndex]) > 0))
     {
-        // create thread context
-        threadData = (THREAD_DATA*)malloc(sizeof(THREAD_DATA));
-        memset(threadData, 0, sizeof(THREAD_DATA));
+        return 1;
+    }
+    return GetQueueLength(threadData->taskQueueData) > 0;
+}
+
+// spins and then yields while the pool is idle so a task submitted shortly after
+// starts without a wake-up, returns 1 if tasks arrived (0 if the thread should park)
+// the spin is doubled each time it finds a task and halved each time it does not
+static int SpinWaitForTasks(THREAD_DATA *threadData)
+{
+    // loop variable
+    unsigned int i = 0;
 
-        // create task queue work data
-        threadData->taskQueueWorkData = (TASK_QUEUE_WORK_DATA*)malloc(sizeof(TASK_QUEUE_WORK_DATA));
-        memset(threadData->taskQueueWorkData, 0, sizeof(TASK_QUEUE_WORK_DATA));
-        threadData->taskQueueWorkData->queueId = threadPool->taskQueueData->queueId;
+    // reference to the pool
+    THREAD_POOL_DATA *threadPool = threadData->threadPool;
 
-        // store reference to termination signal and task queue
-        threadData->terminateThread = &(threadPool->terminateThread);
-        threadData->taskQueueData   = threadPool->taskQueueData;
+    // number of checks while spinning and in total
+    unsigned int spinLimit = threadData->spinLimit;
+    unsigned int waitLimit = spinLimit + threadPool->yieldCount;
 
-        // set init and destroy functions if valid
-        if(threadInit != NULL)
+    for(i = 0; i < waitLimit; i++)
+    {
+        if(*(threadData->terminateThread) || HasPendingTasks(threadData))
         {
-            threadData->initialize = threadInit;
-            threadData->context = threadData->initialize();
+            if(i < spinLimit)
+            {
+                threadData->spinLimit = (spinLimit * 2 < threadPool->spinCount) ? spinLimit * 2 : threadPool->spinCount;
+            }
+            return 1;
         }
-        if(threadPostInit != NULL)
+
+        if(i < spinLimit)
         {
-            threadData->postInit = threadPostInit;
+            SyncCpuRelax();
         }
-        if(threadDestory != NULL)
+        else
         {
-            threadData->destroy = threadDestory;
+            SyncYieldThread();
         }
+    }
 
-        // create the thread
-        SyncCreateThread(&(threadPool->threadIds[i]), NULL, threadFunction, threadData);
-        //printf("Created Thread: %u (Queue: %u)\n", (unsigned int)threadPool->threadIds[i], threadData->taskQueueWorkData->queueId);
+    // spinning did not pay off
+    threadData->spinLimit = (spinLimit / 2 > THREAD_MIN_SPIN_COUNT) ? spinLimit / 2 : THREAD_MIN_SPIN_COUNT;
+    if(threadData->spinLimit > threadPool->spinCount)
+    {
+        threadData->spinLimit = threadPool->spinCount;
     }
 
-    return threadPool;
+    return HasPendingTasks(threadData);
 }
 
-void DestroyThreadPool(THREAD_POOL_DATA *threadPool)
+static void ExecuteTaskQueueItem(THREAD_DATA *threadData, TASK_QUEUE_ITEM *taskQueueItem)
+{
+    // task item function return data reference
+    void* taskData = 0;
+
+    // store the task id
+    threadData->taskQueueWorkData->taskId = taskQueueItem->taskId;
+
+    // execute the task and get the return value
+    taskData = taskQueueItem->taskItemFunction(threadData->taskQueueWorkData, threadData->context, taskQueueItem->taskItemData);
+
+    // execute callback if present, the callback takes ownership of the work item context
+    if(taskQueueItem->taskItemCallback != 0)
+    {
+        taskQueueItem->taskItemCallback(threadData->taskQueueWorkData, threadData->context, taskData);
+        taskQueueItem->taskItemData = 0;
+    }
+
+    // the task no longer counts against the concurrency limit of its tenant
+    ReleaseTaskQueueTenant(threadData->taskQueueData, taskQueueItem);
+
+    // release the task item
+    DestroyTaskQueueItem(taskQueueItem);
+}
+
+// executes a batch of items within a single batch enter/exit, the callback of each item is called as it completes
+static void ExecuteTaskQueueItems(THREAD_DATA *threadData, TASK_QUEUE_ITEM **taskQueueItems, unsigned int numItems)
 {
     // loop variable
     unsigned int i = 0;
 
-    // broadcast thread termination
-    SyncLockMutex(threadPool->taskQueueData->queueMutex);
-    threadPool->terminateThread = 1;
-    SyncBroadcastCond(threadPool->taskQueueData->queueCond);
-    SyncUnlockMutex(threadPool->taskQueueData->queueMutex);
+    // reference to the pool
+    THREAD_POOL_DATA *threadPool = threadData->threadPool;
 
-    // wait for each thread to finish
-    for(i = 0; i < threadPool->numThreads; i++)
+    if(threadPool->threadBatchEnter != 0)
     {
-        SyncJoinThread(threadPool->threadIds[i], NULL);
+        threadPool->threadBatchEnter(threadData->context);
     }
 
-    // free up thread pool memory
-    free(threadPool->threadIds);
-    free(threadPool);
-}
\ No newline at end of file
+    for(i = 0; i < numItems; i++)
+    {
+        ExecuteTaskQueueItem(threadData, taskQueueItems[i]);
+    }
+
+    if(threadPool->threadBatchExit != 0)
+    {
+        threadPool->threadBatchExit(threadData->context);
+    }
+}
+
+// work stealing scheduler loop
+static void WorkStealingLoop(THREAD_DATA *threadData)
+{
+    // local references to task queue items to be worked
+    TASK_QUEUE_ITEM *taskQueueItems[THREAD_POOL_MAX_BATCH_SIZE];
+    unsigned int    numItems = 0;
+
+    // reference to the pool
+    THREAD_POOL_DATA *threadPool = threadData->threadPool;
+
+    // continue until termination signaled
+    while(!*(threadData->terminateThread))
+    {
+        numItems = GetWorkStealingItems(threadData, taskQueueItems);
+        if(numItems > 0)
+        {
+            SyncAtomicAdd(&(threadPool->pendingTasks), -(long)numItems);
+            ExecuteTaskQueueItems(threadData, taskQueueItems, numItems);
+            continue;
+        }
+
+        // a pending item is still being handed over to a queue
+        if(SyncAtomicLoad(&(threadPool->pendingTasks)) > 0)
+        {
+            SyncYieldThread();
+            continue;
+        }
+
+        // wait for a task without parking first
+        if(SpinWaitForTasks(threadData))
+        {
+            continue;
+        }
+
+        // park until a task is submitted, registering as waiting before checking for
+        // pending tasks so a submitter either sees this thread or this thread sees the task
+        SyncLockMutex(&(threadPool->poolMutex));
+        SyncAtomicIncrement(&(threadPool->waitingThreads));
+        while(!*(threadData->terminateThread) && (SyncAtomicLoad(&(threadPool->pendingTasks)) == 0))
+        {
+            SyncWaitList(&(threadPool->poolWaiters), &(threadData->threadWaiter), &(threadPool->poolMutex), 0);
+        }
+        SyncAtomicDecrement(&(threadPool->waitingThreads));
+        SyncUnlockMutex(&(threadPool->poolMutex));
+    }
+}
+
+// claims the exit of the calling thread when the pool has more threads than it should keep
+// idle threads retire down to the minimum, busy threads down to the retire threshold
+static int RetireThread(THREAD_POOL_DATA *threadPool, int isIdle)
+{
+    // number of running threads and the number to keep
+    long liveThreads = 0;
+    long keepThreads = 0;
+
+    do
+    {
+        liveThreads = SyncAtomicLoad(&(threadPool->liveThreads));
+        keepThreads = SyncAtomicLoad(&(threadPool->retireThreshold));
+        if(isIdle && (keepThreads > (long)threadPool->minThreads))
+        {
+            keepThreads = (long)threadPool->minThreads;
+        }
+        if(liveThreads <= keepThreads)
+        {
+            return 0;
+        }
+    }
+    while(SyncAtomicCompareExchange(&(threadPool->liveThreads), liveThreads - 1, liveThreads) != liveThreads);
+
+    return 1;
+}
+
+// records how long the oldest task of a batch waited within the queue (elastic pools only)
+static void RecordQueueWait(THREAD_POOL_DATA *threadPool, TASK_QUEUE_ITEM *taskQueueItem)
+{
+    // current time (ms)
+    unsigned long long currentTime = 0;
+
+    if(threadPool->spawnWaitTime == 0)
+    {
+        return;
+    }
+
+    currentTime = SyncGetTime();
+    SyncAtomicStore(&(threadPool->queueWaitTime), (long)(currentTime - taskQueueItem->taskQueueTime));
+    SyncAtomicStore(&(threadPool->lastDequeueTime), (long)currentTime);
+}
+
+// shared scheduler loop
+static void SharedQueueLoop(THREAD_DATA *threadData)
+{
+    // local references to task queue items to be worked
+    TASK_QUEUE_ITEM *taskQueueItems[THREAD_POOL_MAX_BATCH_SIZE];
+    unsigned int    numItems = 0;
+
+    // reference to the pool
+    THREAD_POOL_DATA *threadPool = threadData->threadPool;
+
+    // set when the thread claimed its exit
+    int             threadRetired = 0;
+
+    // continue until termination signaled
+    while(!*(threadData->terminateThread) && !threadRetired)
+    {
+        // lock-free queues are polled without the lock and only park when empty
+        if(IsTaskQueueLockFree(threadData->taskQueueData))
+        {
+            numItems = GetTaskQueueItems(threadData->taskQueueData, taskQueueItems,
+                GetBatchSize(threadData->threadPool, GetQueueLength(threadData->taskQueueData)));
+        }
+
+        if(numItems == 0)
+        {
+            // wait for a task without parking first
+            SpinWaitForTasks(threadData);
+
+            // lock the queue before checking if there is work to be done
+            SyncLockMutex(threadData->taskQueueData->queueMutex);
+
+            // continue while not terminating AND no work (needed for spurious wake-ups)
+            while(!*(threadData->terminateThread) && (GetQueueLength(threadData->taskQueueData) == 0))
+            {
+                // the pool was shrunk
+                if(RetireThread(threadPool, 0))
+                {
+                    threadRetired = 1;
+                    break;
+                }
+
+                //printf("Thread [%u] is waiting....\n", (unsigned int)threadData->taskQueueWorkData->threadId);
+                if(threadPool->idleTimeout == 0)
+                {
+                    WaitTaskQueue(threadData->taskQueueData, &(threadData->threadWaiter));
+                }
+                // retire after idling for the timeout, unless a task arrived as the exit was claimed
+                // (a submitter that saw this thread running does not spawn a replacement)
+                else if(WaitTaskQueueTimed(threadData->taskQueueData, &(threadData->threadWaiter), threadPool->idleTimeout) &&
+                    (GetQueueLength(threadData->taskQueueData) == 0) &&
+                    RetireThread(threadPool, 1))
+                {
+                    // the last thread stays while delayed tasks are pending, the timer wheel can't spawn one
+                    if((GetQueueLength(threadData->taskQueueData) == 0) &&
+                        ((SyncAtomicLoad(&(threadPool->liveThreads)) > 0) || (GetDelayedTaskCount(threadPool) == 0)))
+                    {
+                        threadRetired = 1;
+                        break;
+                    }
+                    SyncAtomicIncrement(&(threadPool->liveThreads));
+                }
+            }
+
+            // thread is not suppose to terminate
+            if(!*(threadData->terminateThread) && !threadRetired)
+            {
+                // get a share of the work items from the queue
+                numItems = GetTaskQueueItems(threadData->taskQueueData, taskQueueItems,
+                    GetBatchSize(threadData->threadPool, GetQueueLength(threadData->taskQueueData)));
+            }
+
+            // unlock the queue
+            SyncUnlockMutex(threadData->taskQueueData->queueMutex);
+        }
+
+        // check one more time if work should actually be done AND if there are task queue items
+        if((numItems > 0) && !*(threadData->terminateThread))
+        {
+            RecordQueueWait(threadPool, taskQueueItems[0]);
+            ExecuteTaskQueueItems(threadData, taskQueueItems, numItems);
+            numItems = 0;
+
+            // the pool was shrunk while the batch was running
+            threadRetired = RetireThread(threadPool, 0);
+        }
+    }
+
+    // hand back items taken by a thread that was told to terminate, their release functions
+    // may only run on the thread destroying the pool
+    if(numItems > 0)
+    {
+        SyncLockMutex(&(threadPool->poolMutex));
+        while(numItems > 0)
+        {
+            ReleaseTaskQueueTenant(threadData->taskQueueData, taskQueueItems[--numItems]);
+            threadPool->abandonedItems[threadPool->numAbandoned++] = taskQueueItems[numItems];
+        }
+        SyncUnlockMutex(&(threadPool->poolMutex));
+    }
+}
+
+// position of an affinity key within a thread's warm keys
+static unsigned int GetWarmKeyIndex(unsigned int affinityKey)
+{
+    return (affinityKey * 2654435761u) & (THREAD_POOL_MAX_WARM_KEYS - 1);
+}
+
+// returns 1 if the thread executed a task with the affinity key
+static int IsWarmKey(THREAD_AFFINITY_SLOT *affinitySlot, unsigned int affinityKey)
+{
+    // loop variable
+    unsigned int i = 0;
+
+    // stored key and the position being probed
+    long warmKey = 0;
+    unsigned int keyIndex = GetWarmKeyIndex(affinityKey);
+
+    for(i = 0; i < THREAD_POOL_MAX_WARM_KEYS; i++)
+    {
+        warmKey = SyncAtomicLoad(&(affinitySlot->warmKeys[keyIndex]));
+        if(warmKey == (long)affinityKey + 1)
+        {
+            return 1;
+        }
+        if(warmKey == 0)
+        {
+            return 0;
+        }
+        keyIndex = (keyIndex + 1) & (THREAD_POOL_MAX_WARM_KEYS - 1);
+    }
+
+    return 0;
+}
+
+// records the affinity keys of the tasks the calling thread is about to execute
+static void AddWarmKeys(THREAD_AFFINITY_SLOT *affinitySlot, TASK_QUEUE_ITEM **taskQueueItems, unsigned int numItems)
+{
+    // loop variable
+    unsigned int i = 0;
+
+    // position being probed
+    unsigned int keyIndex = 0;
+
+    for(i = 0; i < numItems; i++)
+    {
+        // keys beyond the limit are not tracked (their tasks go to any thread)
+        if(!taskQueueItems[i]->taskHasAffinity || (affinitySlot->numWarmKeys >= (THREAD_POOL_MAX_WARM_KEYS / 4) * 3))
+        {
+            continue;
+        }
+
+        keyIndex = GetWarmKeyIndex(taskQueueItems[i]->taskAffinityKey);
+        while(SyncAtomicLoad(&(affinitySlot->warmKeys[keyIndex])) != 0)
+        {
+            if(SyncAtomicLoad(&(affinitySlot->warmKeys[keyIndex])) == (long)taskQueueItems[i]->taskAffinityKey + 1)
+            {
+                break;
+            }
+            keyIndex = (keyIndex + 1) & (THREAD_POOL_MAX_WARM_KEYS - 1);
+        }
+        if(SyncAtomicLoad(&(affinitySlot->warmKeys[keyIndex])) == 0)
+        {
+            SyncAtomicStore(&(affinitySlot->warmKeys[keyIndex]), (long)taskQueueItems[i]->taskAffinityKey + 1);
+            affinitySlot->numWarmKeys++;
+        }
+    }
+}
+
+// returns the thread a task should be routed to (-1 for the task queue), an idle thread with the
+// task's key warm is preferred, otherwise the busy thread with the key warm and the fewest routed tasks
+static int RouteAffinityTask(THREAD_POOL_DATA *threadPool, TASK_QUEUE_ITEM *taskQueueItem)
+{
+    // loop variable
+    unsigned int i = 0;
+
+    // thread being considered, the first one rotates so equally warm threads share the load
+    unsigned int threadIndex = 0;
+    unsigned int firstIndex = 0;
+
+    // best busy thread and the length of its inbox
+    int busyIndex = -1;
+    int busyLength = 0;
+    int inboxLength = 0;
+
+    if(!taskQueueItem->taskHasAffinity)
+    {
+        return -1;
+    }
+
+    firstIndex = (unsigned int)((unsigned long)SyncAtomicIncrement(&(threadPool->nextThread)) % threadPool->numThreads);
+    for(i = 0; i < threadPool->numThreads; i++)
+    {
+        threadIndex = (firstIndex + i) % threadPool->numThreads;
+        if(!IsWarmKey(&(threadPool->affinitySlots[threadIndex]), taskQueueItem->taskAffinityKey))
+        {
+            continue;
+        }
+
+        if(SyncAtomicLoad(&(threadPool->affinitySlots[threadIndex].threadIdle)))
+        {
+            return (int)threadIndex;
+        }
+
+        inboxLength = GetQueueLength(threadPool->inboxQueues[threadIndex]);
+        if((busyIndex < 0) || (inboxLength < busyLength))
+        {
+            busyIndex = (int)threadIndex;
+            busyLength = inboxLength;
+        }
+    }
+
+    return busyIndex;
+}
+
+// adds a task to the inbox of a thread with its key warm or to the task queue
+static TASK_QUEUE_STATUS AddAffinityTask(THREAD_POOL_DATA *threadPool, TASK_QUEUE_ITEM *taskQueueItem)
+{
+    // thread the task is routed to
+    int threadIndex = RouteAffinityTask(threadPool, taskQueueItem);
+
+    // reference to the affinity state of the thread
+    THREAD_AFFINITY_SLOT *affinitySlot = 0;
+
+    // set if the thread was parked
+    int threadWoken = 0;
+
+    // no thread has the key warm, any thread may take the task
+    if(threadIndex < 0)
+    {
+        return AddTaskToQueue(threadPool->taskQueueData, taskQueueItem);
+    }
+
+    // count the task before it is visible so idle threads wait for it to become overdue
+    affinitySlot = &(threadPool->affinitySlots[threadIndex]);
+    SyncAtomicIncrement(&(threadPool->routedTasks));
+    if(AddTaskToQueue(threadPool->inboxQueues[threadIndex], taskQueueItem) != TASK_QUEUE_STATUS_ADD_SUCCESS)
+    {
+        SyncAtomicDecrement(&(threadPool->routedTasks));
+        return AddTaskToQueue(threadPool->taskQueueData, taskQueueItem);
+    }
+    SyncAtomicCompareExchange(&(affinitySlot->inboxTime), (long)SyncGetTime(), 0);
+
+    // wake the thread if it is parked, otherwise wake another parked thread so it waits
+    // for the task to become overdue (threads park without a timeout while no task is routed)
+    SyncLockMutex(threadPool->taskQueueData->queueMutex);
+    threadWoken = WakeTaskQueueWaiter(threadPool->taskQueueData, affinitySlot->threadWaiter);
+    if(!threadWoken)
+    {
+        WakeTaskQueueWaiter(threadPool->taskQueueData, 0);
+    }
+    SyncUnlockMutex(threadPool->taskQueueData->queueMutex);
+
+    return TASK_QUEUE_STATUS_ADD_SUCCESS;
+}
+
+// takes a share of the tasks within an inbox, only tasks that became overdue are taken from another thread's inbox
+static unsigned int GetInboxItems(THREAD_POOL_DATA *threadPool, unsigned int threadIndex, TASK_QUEUE_ITEM **taskQueueItems, int isOwner)
+{
+    // number of items taken
+    unsigned int numItems = 0;
+
+    // time (ms) the inbox went from empty to non-empty
+    unsigned long inboxTime = 0;
+
+    // references to the inbox and its affinity state
+    TASK_QUEUE_DATA *inboxQueue = threadPool->inboxQueues[threadIndex];
+    THREAD_AFFINITY_SLOT *affinitySlot = &(threadPool->affinitySlots[threadIndex]);
+
+    if(GetQueueLength(inboxQueue) == 0)
+    {
+        return 0;
+    }
+    if(!isOwner)
+    {
+        inboxTime = (unsigned long)SyncAtomicLoad(&(affinitySlot->inboxTime));
+        if((inboxTime == 0) || ((unsigned long)SyncGetTime() - inboxTime < threadPool->affinityWaitTime))
+        {
+            return 0;
+        }
+    }
+
+    SyncLockMutex(inboxQueue->queueMutex);
+    numItems = GetTaskQueueItems(inboxQueue, taskQueueItems, GetBatchSize(threadPool, GetQueueLength(inboxQueue)));
+    if(GetQueueLength(inboxQueue) == 0)
+    {
+        SyncAtomicStore(&(affinitySlot->inboxTime), 0);
+    }
+    SyncUnlockMutex(inboxQueue->queueMutex);
+
+    if(numItems > 0)
+    {
+        SyncAtomicAdd(&(threadPool->routedTasks), -(long)numItems);
+    }
+
+    return numItems;
+}
+
+// takes tasks routed to the calling thread, then tasks from the task queue, then overdue tasks routed to other threads
+static unsigned int GetAffinityItems(THREAD_DATA *threadData, TASK_QUEUE_ITEM **taskQueueItems)
+{
+    // loop variable
+    unsigned int i = 0;
+
+    // number of items taken
+    unsigned int numItems = 0;
+
+    // reference to the pool
+    THREAD_POOL_DATA *threadPool = threadData->threadPool;
+
+    numItems = GetInboxItems(threadPool, threadData->threadIndex, taskQueueItems, 1);
+    if(numItems > 0)
+    {
+        return numItems;
+    }
+
+    if(GetQueueLength(threadData->taskQueueData) > 0)
+    {
+        if(!IsTaskQueueLockFree(threadData->taskQueueData))
+        {
+            SyncLockMutex(threadData->taskQueueData->queueMutex);
+        }
+        numItems = GetTaskQueueItems(threadData->taskQueueData, taskQueueItems,
+            GetBatchSize(threadPool, GetQueueLength(threadData->taskQueueData)));
+        if(!IsTaskQueueLockFree(threadData->taskQueueData))
+        {
+            SyncUnlockMutex(threadData->taskQueueData->queueMutex);
+        }
+        if(numItems > 0)
+        {
+            return numItems;
+        }
+    }
+
+    for(i = 1; (i < threadPool->numThreads) && (SyncAtomicLoad(&(threadPool->routedTasks)) > 0); i++)
+    {
+        numItems = GetInboxItems(threadPool, (threadData->threadIndex + i) % threadPool->numThreads, taskQueueItems, 0);
+        if(numItems > 0)
+        {
+            return numItems;
+        }
+    }
+
+    return 0;
+}
+
+// returns the time (ms) until a task routed to another thread becomes overdue (0 if one is, -1 if none is routed)
+static unsigned int GetAffinityWaitTime(THREAD_DATA *threadData)
+{
+    // loop variable
+    unsigned int i = 0;
+
+    // reference to the pool
+    THREAD_POOL_DATA *threadPool = threadData->threadPool;
+
+    // current time, the time an inbox became non-empty and how long it has waited (ms)
+    unsigned long currentTime = 0;
+    unsigned long inboxTime = 0;
+    unsigned long waitTime = 0;
+
+    // time until the first inbox becomes overdue
+    unsigned int overdueTime = (unsigned int)-1;
+
+    if(SyncAtomicLoad(&(threadPool->routedTasks)) <= 0)
+    {
+        return overdueTime;
+    }
+
+    currentTime = (unsigned long)SyncGetTime();
+    for(i = 1; i < threadPool->numThreads; i++)
+    {
+        inboxTime = (unsigned long)SyncAtomicLoad(&(threadPool->affinitySlots[(threadData->threadIndex + i) % threadPool->numThreads].inboxTime));
+        if(inboxTime == 0)
+        {
+            continue;
+        }
+
+        waitTime = currentTime - inboxTime;
+        if(waitTime >= threadPool->affinityWaitTime)
+        {
+            return 0;
+        }
+        if(threadPool->affinityWaitTime - waitTime < overdueTime)
+        {
+            overdueTime = (unsigned int)(threadPool->affinityWaitTime - waitTime);
+        }
+    }
+
+    return overdueTime;
+}
+
+// affinity scheduler loop
+static void AffinityQueueLoop(THREAD_DATA *threadData)
+{
+    // local references to task queue items to be worked
+    TASK_QUEUE_ITEM *taskQueueItems[THREAD_POOL_MAX_BATCH_SIZE];
+    unsigned int    numItems = 0;
+
+    // reference to the pool and the affinity state of this thread
+    THREAD_POOL_DATA *threadPool = threadData->threadPool;
+    THREAD_AFFINITY_SLOT *affinitySlot = &(threadPool->affinitySlots[threadData->threadIndex]);
+
+    // time (ms) to wait for a routed task to become overdue
+    unsigned int    waitTime = 0;
+
+    // continue until termination signaled
+    while(!*(threadData->terminateThread))
+    {
+        numItems = GetAffinityItems(threadData, taskQueueItems);
+        if(numItems > 0)
+        {
+            SyncAtomicStore(&(affinitySlot->threadIdle), 0);
+            AddWarmKeys(affinitySlot, taskQueueItems, numItems);
+            ExecuteTaskQueueItems(threadData, taskQueueItems, numItems);
+            continue;
+        }
+
+        // wait for a task without parking first, submitters prefer idle threads with the key warm
+        SyncAtomicStore(&(affinitySlot->threadIdle), 1);
+        if(SpinWaitForTasks(threadData))
+        {
+            continue;
+        }
+
+        // park until a task is added or routed to this thread, or a task routed to another thread becomes overdue
+        // (submitters route tasks before locking the queue to wake this thread)
+        SyncLockMutex(threadData->taskQueueData->queueMutex);
+        while(!*(threadData->terminateThread) && !HasPendingTasks(threadData))
+        {
+            waitTime = GetAffinityWaitTime(threadData);
+            if(waitTime == 0)
+            {
+                break;
+            }
+            if(waitTime == (unsigned int)-1)
+            {
+                WaitTaskQueue(threadData->taskQueueData, &(threadData->threadWaiter));
+            }
+            else
+            {
+                WaitTaskQueueTimed(threadData->taskQueueData, &(threadData->threadWaiter), waitTime);
+            }
+        }
+        SyncUnlockMutex(threadData->taskQueueData->queueMutex);
+    }
+}
+
+// orders processors so consecutive threads share cores and packages
+static int CompareCompactProcessors(const void *processorA, const void *processorB)
+{
+    const THREAD_PROCESSOR *a = (const THREAD_PROCESSOR*)processorA;
+    const THREAD_PROCESSOR *b = (const THREAD_PROCESSOR*)processorB;
+
+    if(a->packageId != b->packageId)
+    {
+        return a->packageId < b->packageId ? -1 : 1;
+    }
+    if(a->coreId != b->coreId)
+    {
+        return a->coreId < b->coreId ? -1 : 1;
+    }
+    return a->processorId < b->processorId ? -1 : (a->processorId > b->processorId);
+}
+
+// orders processors so consecutive threads land on different packages, then different cores
+static int CompareScatterProcessors(const void *processorA, const void *processorB)
+{
+    const THREAD_PROCESSOR *a = (const THREAD_PROCESSOR*)processorA;
+    const THREAD_PROCESSOR *b = (const THREAD_PROCESSOR*)processorB;
+
+    if(a->siblingRank != b->siblingRank)
+    {
+        return a->siblingRank < b->siblingRank ? -1 : 1;
+    }
+    if(a->coreRank != b->coreRank)
+    {
+        return a->coreRank < b->coreRank ? -1 : 1;
+    }
+    if(a->packageId != b->packageId)
+    {
+        return a->packageId < b->packageId ? -1 : 1;
+    }
+    return a->processorId < b->processorId ? -1 : (a->processorId > b->processorId);
+}
+
+// stores the pool's processors in the placement order of its affinity policy
+static void OrderThreadProcessors(THREAD_POOL_DATA *threadPool)
+{
+    // loop variables
+    unsigned int i = 0;
+    unsigned int j = 0;
+
+    // topology of each processor
+    THREAD_PROCESSOR *threadProcessors = 0;
+
+    if((threadPool->affinityPolicy == THREAD_POOL_AFFINITY_NONE) || (threadPool->numProcessors == 0))
+    {
+        return;
+    }
+
+    threadProcessors = (THREAD_PROCESSOR*)malloc(threadPool->numProcessors * sizeof(THREAD_PROCESSOR));
+    memset(threadProcessors, 0, threadPool->numProcessors * sizeof(THREAD_PROCESSOR));
+    for(i = 0; i < threadPool->numProcessors; i++)
+    {
+        threadProcessors[i].processorId = threadPool->processorIds[i];
+        SyncGetProcessorTopology(threadProcessors[i].processorId, &(threadProcessors[i].packageId), &(threadProcessors[i].coreId));
+    }
+
+    // rank the cores within each package and the processors within each core
+    qsort(threadProcessors, threadPool->numProcessors, sizeof(THREAD_PROCESSOR), CompareCompactProcessors);
+    for(i = 1; i < threadPool->numProcessors; i++)
+    {
+        j = i - 1;
+        if(threadProcessors[i].packageId != threadProcessors[j].packageId)
+        {
+            continue;
+        }
+        if(threadProcessors[i].coreId == threadProcessors[j].coreId)
+        {
+            threadProcessors[i].coreRank = threadProcessors[j].coreRank;
+            threadProcessors[i].siblingRank = threadProcessors[j].siblingRank + 1;
+        }
+        else
+        {
+            threadProcessors[i].coreRank = threadProcessors[j].coreRank + 1;
+        }
+    }
+
+    if(threadPool->affinityPolicy == THREAD_POOL_AFFINITY_SCATTER)
+    {
+        qsort(threadProcessors, threadPool->numProcessors, sizeof(THREAD_PROCESSOR), CompareScatterProcessors);
+    }
+
+    for(i = 0; i < threadPool->numProcessors; i++)
+    {
+        threadPool->processorIds[i] = threadProcessors[i].processorId;
+    }
+
+    free(threadProcessors);
+}
+
+// places and names the calling thread (best effort, failures leave the thread as created)
+static void ConfigureThread(THREAD_POOL_DATA *threadPool, unsigned int threadIndex)
+{
+    // name of the thread
+    char threadName[THREAD_POOL_MAX_NAME_LENGTH + 16];
+
+    if(threadPool->processorIds != NULL)
+    {
+        if(threadPool->affinityPolicy == THREAD_POOL_AFFINITY_NONE)
+        {
+            SyncSetThreadAffinity(threadPool->processorIds, threadPool->numProcessors);
+        }
+        else
+        {
+            SyncSetThreadAffinity(&(threadPool->processorIds[threadIndex % threadPool->numProcessors]), 1);
+        }
+    }
+
+    if(threadPool->threadName[0] != 0)
+    {
+        snprintf(threadName, sizeof(threadName), "%s%u", threadPool->threadName, threadIndex);
+        SyncSetThreadName(threadName);
+    }
+}
+
+// individual thread function
+static THREAD_FUNC WINAPI threadFunction(void *threadArg)
+{
+    // store thread context data locally and update thread id
+    THREAD_DATA *threadData = (THREAD_DATA*)threadArg;
+
+    // slot of the thread, released once the thread is done with the pool
+    THREAD_POOL_DATA *threadPool = threadData->threadPool;
+    unsigned int threadIndex = threadData->threadIndex;
+
+    threadData->taskQueueWorkData->threadId = SyncGetThreadId();
+
+    // bind the thread before post initialize so the memory it touches is local to its processor
+    ConfigureThread(threadPool, threadIndex);
+
+    // execute post initialize if set
+    if(threadData->postInit != NULL)
+    {
+        //fprintf(stdout, "[%u] threadFunction - postInit\n", SyncGetThreadId());
+        threadData->postInit(threadData->context);
+    }
+
+    // process tasks until termination signaled
+    if(threadData->threadPool->schedulerType == THREAD_POOL_SCHEDULER_WORK_STEALING)
+    {
+        WorkStealingLoop(threadData);
+    }
+    else if(threadData->threadPool->schedulerType == THREAD_POOL_SCHEDULER_AFFINITY)
+    {
+        AffinityQueueLoop(threadData);
+    }
+    else
+    {
+        SharedQueueLoop(threadData);
+    }
+
+    // call destroy if set
+    if(threadData->destroy != NULL)
+    {
+        threadData->destroy(threadData->context);
+    }
+
+    // hand the blocks cached by this thread back to their pools
+    FlushMemoryPoolCaches();
+
+    //printf("Thread [%u] is done!\n", (unsigned int)threadData->taskQueueWorkData->threadId);
+
+    // free up thread data
+    SyncDestroyWaiter(&(threadData->threadWaiter));
+    free(threadData->taskQueueWorkData);
+    free(threadData);
+
+    // the slot can be joined and reused
+    SyncAtomicStore(&(threadPool->threadStates[threadIndex]), THREAD_SLOT_EXITED);
+
+#ifdef _WIN32
+    // http://msdn.microsoft.com/en-us/library/kdzttdcb(v=vs.110).aspx
+    _endthreadex(0);
+#endif
+
+    return THREAD_FUNC_RETURN;
+}
+
+// creates the thread of a free slot
+static void StartThread(THREAD_POOL_DATA *threadPool, unsigned int threadIndex)
+{
+    // attributes of the thread
+    SYNC_THREAD_ATTR threadAttr;
+
+    // create thread context
+    THREAD_DATA *threadData = (THREAD_DATA*)malloc(sizeof(THREAD_DATA));
+    memset(threadData, 0, sizeof(THREAD_DATA));
+
+    // create task queue work data
+    threadData->taskQueueWorkData = (TASK_QUEUE_WORK_DATA*)malloc(sizeof(TASK_QUEUE_WORK_DATA));
+    memset(threadData->taskQueueWorkData, 0, sizeof(TASK_QUEUE_WORK_DATA));
+    threadData->taskQueueWorkData->queueId = threadPool->taskQueueData->queueId;
+
+    // store reference to termination signal and task queue
+    threadData->terminateThread = &(threadPool->terminateThread);
+    threadData->taskQueueData   = threadPool->taskQueueData;
+
+    // store reference to the pool and position within it
+    threadData->threadPool      = threadPool;
+    threadData->threadIndex     = threadIndex;
+    threadData->randomState     = (threadIndex + 1) * 2654435761u;
+    SyncCreateWaiter(&(threadData->threadWaiter));
+    threadData->spinLimit       = threadPool->spinCount;
+    if(threadPool->affinitySlots != NULL)
+    {
+        threadPool->affinitySlots[threadIndex].threadWaiter = &(threadData->threadWaiter);
+    }
+
+    // set init and destroy functions if valid
+    if(threadPool->threadInit != NULL)
+    {
+        threadData->initialize = threadPool->threadInit;
+        threadData->context = threadData->initialize();
+    }
+    if(threadPool->threadPostInit != NULL)
+    {
+        threadData->postInit = threadPool->threadPostInit;
+    }
+    if(threadPool->threadDestroy != NULL)
+    {
+        threadData->destroy = threadPool->threadDestroy;
+    }
+
+    // create the thread
+    SyncAtomicStore(&(threadPool->threadStates[threadIndex]), THREAD_SLOT_RUNNING);
+    memset(&threadAttr, 0, sizeof(SYNC_THREAD_ATTR));
+    threadAttr.stackSize = threadPool->stackSize;
+    SyncCreateThread(&(threadPool->threadIds[threadIndex]), &threadAttr, threadFunction, threadData);
+    //printf("Created Thread: %u (Queue: %u)\n", (unsigned int)threadPool->threadIds[threadIndex], threadData->taskQueueWorkData->queueId);
+}
+
+// joins retired threads and spawns up to numThreads threads into free slots (spawnMutex must be held)
+static unsigned int SpawnThreads(THREAD_POOL_DATA *threadPool, unsigned int numThreads)
+{
+    // loop variable
+    unsigned int i = 0;
+
+    // number of threads spawned
+    unsigned int numSpawned = 0;
+
+    for(i = 0; i < threadPool->numThreads; i++)
+    {
+        if(SyncAtomicLoad(&(threadPool->threadStates[i])) == THREAD_SLOT_EXITED)
+        {
+            SyncJoinThread(threadPool->threadIds[i], NULL);
+            SyncAtomicStore(&(threadPool->threadStates[i]), THREAD_SLOT_FREE);
+        }
+
+        if((numSpawned < numThreads) && (SyncAtomicLoad(&(threadPool->threadStates[i])) == THREAD_SLOT_FREE))
+        {
+            // count the thread before it runs so it is never mistaken for a surplus thread
+            SyncAtomicIncrement(&(threadPool->liveThreads));
+            StartThread(threadPool, i);
+            numSpawned++;
+        }
+    }
+
+    return numSpawned;
+}
+
+// spawns a thread when the queued tasks wait longer than the spawn threshold (shared scheduler only)
+static void GrowThreadPool(THREAD_POOL_DATA *threadPool)
+{
+    // number of running threads
+    long liveThreads = 0;
+
+    // current time and how long the queue has been waiting (ms)
+    unsigned long long currentTime = 0;
+    unsigned long queueWaitTime = 0;
+    unsigned long dequeueWaitTime = 0;
+
+    if(SyncGetThreadId() != threadPool->ownerThreadId)
+    {
+        return;
+    }
+
+    // make the added tasks visible before checking for threads that are retiring
+    SyncMemoryBarrier();
+
+    liveThreads = SyncAtomicLoad(&(threadPool->liveThreads));
+    if(liveThreads >= (long)threadPool->numThreads)
+    {
+        return;
+    }
+
+    // the queue is always serviced by at least one thread
+    if(liveThreads > 0)
+    {
+        if(threadPool->spawnWaitTime == 0)
+        {
+            return;
+        }
+
+        // the last batch waited too long or the threads have not taken a task for too long
+        currentTime = SyncGetTime();
+        queueWaitTime = (unsigned long)SyncAtomicLoad(&(threadPool->queueWaitTime));
+        dequeueWaitTime = (unsigned long)currentTime - (unsigned long)SyncAtomicLoad(&(threadPool->lastDequeueTime));
+        if((queueWaitTime < threadPool->spawnWaitTime) &&
+            ((dequeueWaitTime < threadPool->spawnWaitTime) || (GetQueueLength(threadPool->taskQueueData) == 0)))
+        {
+            return;
+        }
+    }
+
+    // spawn at most one thread per spawn threshold
+    SyncLockMutex(&(threadPool->spawnMutex));
+    currentTime = SyncGetTime();
+    if(!threadPool->terminateThread &&
+        ((SyncAtomicLoad(&(threadPool->liveThreads)) == 0) || (currentTime - threadPool->lastSpawnTime >= threadPool->spawnWaitTime)))
+    {
+        SyncAtomicStore(&(threadPool->retireThreshold), (long)threadPool->numThreads);
+        if(SpawnThreads(threadPool, 1) > 0)
+        {
+            threadPool->lastSpawnTime = currentTime;
+            SyncAtomicStore(&(threadPool->queueWaitTime), 0);
+            SyncAtomicStore(&(threadPool->lastDequeueTime), (long)currentTime);
+        }
+    }
+    SyncUnlockMutex(&(threadPool->spawnMutex));
+}
+
+// called on the timer wheel's thread with the delayed tasks that are due, the tasks are added
+// as a batch and the ones the pool can't take (a full queue) are offered again by the wheel
+static unsigned int AddDueTasks(void *dueContext, TASK_QUEUE_ITEM **taskQueueItems, unsigned int numItems)
+{
+    // number of tasks added
+    unsigned int numAdded = 0;
+
+    AddTasksToThreadPool((THREAD_POOL_DATA*)dueContext, taskQueueItems, numItems, &numAdded);
+    return numAdded;
+}
+
+/*---------------------------------------------------------------------------*/
+/* FUNCTION DEFINITIONS */
+/*---------------------------------------------------------------------------*/
+
+THREAD_POOL_DATA* CreateThreadPool(
+    unsigned int numThreads,
+    TASK_QUEUE_DATA *taskQueueData,
+    void* (*threadInit)(void),
+    void (*threadPostInit)(void* threadContext),
+    void (*threadDestory)(void* threadContext))
+{
+    return CreateThreadPoolWithOptions(numThreads, taskQueueData, NULL, threadInit, threadPostInit, threadDestory);
+}
+
+THREAD_POOL_DATA* CreateThreadPoolWithOptions(
+    unsigned int numThreads,
+    TASK_QUEUE_DATA *taskQueueData,
+    const THREAD_POOL_OPTIONS *poolOptions,
+    void* (*threadInit)(void),
+    void (*threadPostInit)(void* threadContext),
+    void (*threadDestory)(void* threadContext))
+{
+    // loop variable
+    unsigned int i = 0;
+
+    // number of threads started with the pool
+    unsigned int initialThreads = numThreads;
+
+    // inbox queue options
+    TASK_QUEUE_OPTIONS inboxOptions;
+
+    // create thread pool
+    THREAD_POOL_DATA *threadPool = (THREAD_POOL_DATA*)malloc(sizeof(THREAD_POOL_DATA));
+    memset(threadPool, 0, sizeof(THREAD_POOL_DATA));
+
+    // store number of threads
+    threadPool->numThreads = numThreads;
+    threadPool->minThreads = numThreads;
+
+    // store task queue reference
+    threadPool->taskQueueData = taskQueueData;
+
+    // store scheduler type and batching
+    threadPool->maxBatchSize = THREAD_POOL_DEFAULT_BATCH_SIZE;
+    if(poolOptions != NULL)
+    {
+        threadPool->schedulerType = poolOptions->schedulerType;
+        threadPool->threadBatchEnter = poolOptions->threadBatchEnter;
+        threadPool->threadBatchExit = poolOptions->threadBatchExit;
+
+        // spinning and yielding only help when the submitting thread runs on another processor
+        if(SyncGetProcessorCount() > 1)
+        {
+            threadPool->spinCount = poolOptions->spinCount;
+            threadPool->yieldCount = poolOptions->yieldCount;
+        }
+
+        if(poolOptions->maxBatchSize > 0)
+        {
+            threadPool->maxBatchSize = poolOptions->maxBatchSize < THREAD_POOL_MAX_BATCH_SIZE ?
+                poolOptions->maxBatchSize :
+                THREAD_POOL_MAX_BATCH_SIZE;
+        }
+
+        // elastic sizing, the other schedulers keep state per thread and stay at numThreads
+        if(threadPool->schedulerType == THREAD_POOL_SCHEDULER_SHARED)
+        {
+            if(poolOptions->maxThreads > numThreads)
+            {
+                threadPool->numThreads = poolOptions->maxThreads;
+            }
+            threadPool->minThreads = poolOptions->minThreads < numThreads ? poolOptions->minThreads : numThreads;
+            threadPool->idleTimeout = poolOptions->idleTimeout;
+            threadPool->spawnWaitTime = poolOptions->spawnWaitTime;
+        }
+
+        // thread placement, an explicit processor set binds threads even without a policy
+        threadPool->affinityPolicy = poolOptions->affinityPolicy;
+        if((poolOptions->affinityCpus != NULL) && (poolOptions->numAffinityCpus > 0))
+        {
+            threadPool->numProcessors = poolOptions->numAffinityCpus;
+            threadPool->processorIds = (unsigned int*)malloc(threadPool->numProcessors * sizeof(unsigned int));
+            memcpy(threadPool->processorIds, poolOptions->affinityCpus, threadPool->numProcessors * sizeof(unsigned int));
+        }
+        else if(threadPool->affinityPolicy != THREAD_POOL_AFFINITY_NONE)
+        {
+            threadPool->processorIds = (unsigned int*)malloc(SyncGetProcessorCount() * sizeof(unsigned int));
+            threadPool->numProcessors = SyncGetThreadAffinity(threadPool->processorIds, SyncGetProcessorCount());
+            if(threadPool->numProcessors == 0)
+            {
+                free(threadPool->processorIds);
+                threadPool->processorIds = NULL;
+            }
+        }
+        OrderThreadProcessors(threadPool);
+
+        threadPool->affinityWaitTime = poolOptions->affinityWaitTime > 0 ? poolOptions->affinityWaitTime : THREAD_POOL_DEFAULT_AFFINITY_WAIT;
+
+        threadPool->stackSize = poolOptions->stackSize;
+        if(poolOptions->threadName != NULL)
+        {
+            strncpy(threadPool->threadName, poolOptions->threadName, THREAD_POOL_MAX_NAME_LENGTH);
+        }
+    }
+
+    // threads only retire when shrunk or idle
+    SyncAtomicStore(&(threadPool->retireThreshold), (long)threadPool->numThreads);
+    SyncAtomicStore(&(threadPool->lastDequeueTime), (long)SyncGetTime());
+
+    // store the thread callbacks
+    threadPool->threadInit = threadInit;
+    threadPool->threadPostInit = threadPostInit;
+    threadPool->threadDestroy = threadDestory;
+
+    // initialize the pool mutex and cond
+    SyncCreateMutex(&(threadPool->poolMutex), NULL);
+    SyncCreateMutex(&(threadPool->spawnMutex), NULL);
+
+    // create the per-thread queues
+    if(threadPool->schedulerType == THREAD_POOL_SCHEDULER_WORK_STEALING)
+    {
+        memset(&inboxOptions, 0, sizeof(TASK_QUEUE_OPTIONS));
+        inboxOptions.queueType = TASK_QUEUE_TYPE_RING;
+        inboxOptions.queueCapacity = THREAD_INBOX_CAPACITY;
+
+        threadPool->inboxQueues = (TASK_QUEUE_DATA**)malloc(numThreads * sizeof(TASK_QUEUE_DATA*));
+        threadPool->taskDeques = (THREAD_DEQUE**)malloc(numThreads * sizeof(THREAD_DEQUE*));
+        for(i = 0; i < numThreads; i++)
+        {
+            threadPool->inboxQueues[i] = CreateTaskQueueWithOptions(taskQueueData->queueId, &inboxOptions);
+            threadPool->taskDeques[i] = CreateThreadDeque();
+        }
+    }
+    else if(threadPool->schedulerType == THREAD_POOL_SCHEDULER_AFFINITY)
+    {
+        memset(&inboxOptions, 0, sizeof(TASK_QUEUE_OPTIONS));
+        inboxOptions.queueType = TASK_QUEUE_TYPE_LIST;
+
+        threadPool->inboxQueues = (TASK_QUEUE_DATA**)malloc(numThreads * sizeof(TASK_QUEUE_DATA*));
+        threadPool->affinitySlots = (THREAD_AFFINITY_SLOT*)malloc(numThreads * sizeof(THREAD_AFFINITY_SLOT));
+        memset((void*)threadPool->affinitySlots, 0, numThreads * sizeof(THREAD_AFFINITY_SLOT));
+        for(i = 0; i < numThreads; i++)
+        {
+            threadPool->inboxQueues[i] = CreateTaskQueueWithOptions(taskQueueData->queueId, &inboxOptions);
+        }
+    }
+
+    // allocate memory for thread ids and slot states
+    threadPool->abandonedItems = (TASK_QUEUE_ITEM**)malloc(threadPool->numThreads * THREAD_POOL_MAX_BATCH_SIZE * sizeof(TASK_QUEUE_ITEM*));
+    threadPool->threadIds = (THREAD*)malloc(threadPool->numThreads * sizeof(THREAD));
+    threadPool->threadStates = (THREAD_ATOMIC*)malloc(threadPool->numThreads * sizeof(THREAD_ATOMIC));
+    memset((void*)threadPool->threadStates, 0, threadPool->numThreads * sizeof(THREAD_ATOMIC));
+
+    // spawn the initial threads
+    threadPool->ownerThreadId = SyncGetThreadId();
+    SyncLockMutex(&(threadPool->spawnMutex));
+    SpawnThreads(threadPool, initialThreads);
+    threadPool->lastSpawnTime = SyncGetTime();
+    SyncUnlockMutex(&(threadPool->spawnMutex));
+
+    return threadPool;
+}
+
+TASK_QUEUE_STATUS AddTaskToThreadPool(THREAD_POOL_DATA *threadPool, TASK_QUEUE_ITEM *taskQueueItem)
+{
+    // return value
+    TASK_QUEUE_STATUS   addStatus = TASK_QUEUE_STATUS_ADD_SUCCESS;
+
+    // index of the thread to receive the item
+    unsigned int        threadIndex = 0;
+
+    // the affinity scheduler routes tasks to threads with their key warm
+    if((threadPool->schedulerType == THREAD_POOL_SCHEDULER_AFFINITY) && (threadPool->numThreads > 0))
+    {
+        return AddAffinityTask(threadPool, taskQueueItem);
+    }
+
+    // the shared scheduler works directly from the task queue
+    if((threadPool->schedulerType != THREAD_POOL_SCHEDULER_WORK_STEALING) || (threadPool->numThreads == 0))
+    {
+        addStatus = AddTaskToQueue(threadPool->taskQueueData, taskQueueItem);
+        if(addStatus == TASK_QUEUE_STATUS_ADD_SUCCESS)
+        {
+            GrowThreadPool(threadPool);
+        }
+        return addStatus;
+    }
+
+    // count the item before it is visible so threads never park while it is in flight
+    SyncAtomicIncrement(&(threadPool->pendingTasks));
+
+    // spread submissions round-robin, overflowing to the task queue
+    threadIndex = (unsigned int)((unsigned long)SyncAtomicIncrement(&(threadPool->nextThread)) % threadPool->numThreads);
+    addStatus = AddTaskToQueue(threadPool->inboxQueues[threadIndex], taskQueueItem);
+    if(addStatus != TASK_QUEUE_STATUS_ADD_SUCCESS)
+    {
+        addStatus = AddTaskToQueue(threadPool->taskQueueData, taskQueueItem);
+    }
+
+    if(addStatus != TASK_QUEUE_STATUS_ADD_SUCCESS)
+    {
+        SyncAtomicDecrement(&(threadPool->pendingTasks));
+    }
+    // wake the most recently parked thread
+    else if(SyncAtomicLoad(&(threadPool->waitingThreads)) > 0)
+    {
+        SyncLockMutex(&(threadPool->poolMutex));
+        SyncWakeWaiters(&(threadPool->poolWaiters), 1);
+        SyncUnlockMutex(&(threadPool->poolMutex));
+    }
+
+    return addStatus;
+}
+
+TASK_QUEUE_STATUS AddTasksToThreadPool(THREAD_POOL_DATA *threadPool, TASK_QUEUE_ITEM **taskQueueItems, unsigned int numItems, unsigned int *numAdded)
+{
+    // return value
+    TASK_QUEUE_STATUS   addStatus = TASK_QUEUE_STATUS_ADD_SUCCESS;
+
+    // loop variables
+    unsigned int        i = 0;
+    unsigned int        threadIndex = 0;
+
+    // number of items handed to each inbox and the number actually added
+    unsigned int        chunkSize = 0;
+    unsigned int        chunkAdded = 0;
+
+    // number of items added and the number still to be added
+    unsigned int        itemsAdded = 0;
+    unsigned int        itemsLeft = numItems;
+
+    // the affinity scheduler routes each task on its own
+    if((threadPool->schedulerType == THREAD_POOL_SCHEDULER_AFFINITY) && (threadPool->numThreads > 0))
+    {
+        for(itemsAdded = 0; itemsAdded < numItems; itemsAdded++)
+        {
+            addStatus = AddAffinityTask(threadPool, taskQueueItems[itemsAdded]);
+            if(addStatus != TASK_QUEUE_STATUS_ADD_SUCCESS)
+            {
+                break;
+            }
+        }
+        if(numAdded != NULL)
+        {
+            *numAdded = itemsAdded;
+        }
+        return addStatus;
+    }
+
+    // the shared scheduler works directly from the task queue
+    if((threadPool->schedulerType != THREAD_POOL_SCHEDULER_WORK_STEALING) || (threadPool->numThreads == 0))
+    {
+        addStatus = AddTasksToQueue(threadPool->taskQueueData, taskQueueItems, numItems, &itemsAdded);
+        if(itemsAdded > 0)
+        {
+            GrowThreadPool(threadPool);
+        }
+        if(numAdded != NULL)
+        {
+            *numAdded = itemsAdded;
+        }
+        return addStatus;
+    }
+
+    // count the items before they are visible so threads never park while they are in flight
+    SyncAtomicAdd(&(threadPool->pendingTasks), (long)numItems);
+
+    // split the batch into one chunk per inbox, starting with the next round-robin thread
+    chunkSize = (numItems + threadPool->numThreads - 1) / threadPool->numThreads;
+    threadIndex = (unsigned int)((unsigned long)SyncAtomicIncrement(&(threadPool->nextThread)) % threadPool->numThreads);
+    for(i = 0; (i < threadPool->numThreads) && (itemsLeft > 0); i++)
+    {
+        AddTasksToQueue(threadPool->inboxQueues[(threadIndex + i) % threadPool->numThreads],
+            &(taskQueueItems[itemsAdded]),
+            itemsLeft < chunkSize ? itemsLeft : chunkSize,
+            &chunkAdded);
+
+        // stop at the first full inbox, the rest of the batch overflows to the task queue
+        itemsAdded += chunkAdded;
+        itemsLeft -= chunkAdded;
+        if((itemsLeft > 0) && (chunkAdded < chunkSize))
+        {
+            break;
+        }
+    }
+
+    // overflow to the task queue
+    if(itemsLeft > 0)
+    {
+        addStatus = AddTasksToQueue(threadPool->taskQueueData, &(taskQueueItems[itemsAdded]), itemsLeft, &chunkAdded);
+        itemsAdded += chunkAdded;
+        itemsLeft -= chunkAdded;
+    }
+
+    if(itemsLeft > 0)
+    {
+        SyncAtomicAdd(&(threadPool->pendingTasks), -(long)itemsLeft);
+    }
+
+    // wake one parked thread per item
+    if((itemsAdded > 0) && (SyncAtomicLoad(&(threadPool->waitingThreads)) > 0))
+    {
+        SyncLockMutex(&(threadPool->poolMutex));
+        SyncWakeWaiters(&(threadPool->poolWaiters), itemsAdded);
+        SyncUnlockMutex(&(threadPool->poolMutex));
+    }
+
+    if(numAdded != NULL)
+    {
+        *numAdded = itemsAdded;
+    }
+
+    return addStatus;
+}
+
+TASK_QUEUE_STATUS AddDelayedTaskToThreadPool(THREAD_POOL_DATA *threadPool, TASK_QUEUE_ITEM *taskQueueItem, unsigned int delayMs)
+{
+    // return value
+    TASK_QUEUE_STATUS addStatus = TASK_QUEUE_STATUS_ADD_SUCCESS;
+
+    // wheel created by this call
+    TIMER_WHEEL *timerWheel = 0;
+
+    // create the wheel with the first delayed task, another thread may have created it first
+    if(threadPool->timerWheel == 0)
+    {
+        timerWheel = CreateTimerWheel(AddDueTasks, threadPool);
+        if(timerWheel == 0)
+        {
+            return TASK_QUEUE_STATUS_ADD_MALLOC_FAIL;
+        }
+        if(SyncAtomicCompareExchangePointer((void* volatile*)&(threadPool->timerWheel), timerWheel, 0) != 0)
+        {
+            DestroyTimerWheel(timerWheel);
+        }
+    }
+
+    addStatus = AddTimerWheelTask(threadPool->timerWheel, taskQueueItem, delayMs);
+
+    // an elastic pool whose threads all retired spawns one to take the task once it is due
+    if((addStatus == TASK_QUEUE_STATUS_ADD_SUCCESS) && (threadPool->schedulerType == THREAD_POOL_SCHEDULER_SHARED))
+    {
+        GrowThreadPool(threadPool);
+    }
+
+    return addStatus;
+}
+
+unsigned int ExpireDelayedTasks(THREAD_POOL_DATA *threadPool, unsigned int taskId)
+{
+    if(threadPool->timerWheel == 0)
+    {
+        return 0;
+    }
+
+    return ExpireTimerWheelTasks(threadPool->timerWheel, taskId);
+}
+
+TASK_QUEUE_ITEM* RemoveTaskFromThreadPool(THREAD_POOL_DATA *threadPool, unsigned int taskId, void *taskItemData)
+{
+    // item unlinked from the task queue
+    TASK_QUEUE_ITEM *taskQueueItem = RemoveTaskFromQueue(threadPool->taskQueueData, taskId, taskItemData);
+
+    // the overflow of the work stealing scheduler counts as pending
+    if((taskQueueItem != 0) && (threadPool->schedulerType == THREAD_POOL_SCHEDULER_WORK_STEALING))
+    {
+        SyncAtomicDecrement(&(threadPool->pendingTasks));
+    }
+
+    return taskQueueItem;
+}
+
+unsigned int GetDelayedTaskCount(THREAD_POOL_DATA *threadPool)
+{
+    if(threadPool->timerWheel == 0)
+    {
+        return 0;
+    }
+
+    return GetTimerWheelLength(threadPool->timerWheel);
+}
+
+int ResizeThreadPool(THREAD_POOL_DATA *threadPool, unsigned int numThreads)
+{
+    // number of running threads
+    unsigned int liveThreads = 0;
+
+    // the per-thread state of the other schedulers is fixed, and a pool always keeps one thread
+    if((threadPool->schedulerType != THREAD_POOL_SCHEDULER_SHARED) ||
+        (numThreads == 0) || (numThreads > threadPool->numThreads))
+    {
+        return -1;
+    }
+
+    SyncLockMutex(&(threadPool->spawnMutex));
+
+    // idle threads no longer retire below the new size, nor stay above it
+    if(threadPool->minThreads > numThreads)
+    {
+        threadPool->minThreads = numThreads;
+    }
+
+    liveThreads = (unsigned int)SyncAtomicLoad(&(threadPool->liveThreads));
+    if(numThreads >= liveThreads)
+    {
+        SyncAtomicStore(&(threadPool->retireThreshold), (long)threadPool->numThreads);
+        SpawnThreads(threadPool, numThreads - liveThreads);
+        threadPool->lastSpawnTime = SyncGetTime();
+    }
+    else
+    {
+        // wake idle threads so the surplus retires
+        SyncLockMutex(threadPool->taskQueueData->queueMutex);
+        SyncAtomicStore(&(threadPool->retireThreshold), (long)numThreads);
+        WakeTaskQueue(threadPool->taskQueueData);
+        SyncUnlockMutex(threadPool->taskQueueData->queueMutex);
+    }
+
+    SyncUnlockMutex(&(threadPool->spawnMutex));
+
+    return 0;
+}
+
+unsigned int GetThreadPoolSize(THREAD_POOL_DATA *threadPool)
+{
+    return (unsigned int)SyncAtomicLoad(&(threadPool->liveThreads));
+}
+
+unsigned int GetThreadPoolWarmKeys(THREAD_POOL_DATA *threadPool, unsigned int threadIndex, unsigned int *affinityKeys, unsigned int maxKeys)
+{
+    // loop variable
+    unsigned int i = 0;
+
+    // number of keys stored
+    unsigned int numKeys = 0;
+
+    // stored key
+    long warmKey = 0;
+
+    if((threadPool->affinitySlots == NULL) || (threadIndex >= threadPool->numThreads))
+    {
+        return 0;
+    }
+
+    for(i = 0; (i < THREAD_POOL_MAX_WARM_KEYS) && (numKeys < maxKeys); i++)
+    {
+        warmKey = SyncAtomicLoad(&(threadPool->affinitySlots[threadIndex].warmKeys[i]));
+        if(warmKey != 0)
+        {
+            affinityKeys[numKeys++] = (unsigned int)(warmKey - 1);
+        }
+    }
+
+    return numKeys;
+}
+
+void DestroyThreadPool(THREAD_POOL_DATA *threadPool)
+{
+    // loop variable
+    unsigned int i = 0;
+
+    // item left within a deque
+    TASK_QUEUE_ITEM *taskQueueItem = 0;
+
+    // stop adding delayed tasks and destroy the ones that are not yet due
+    if(threadPool->timerWheel != 0)
+    {
+        DestroyTimerWheel(threadPool->timerWheel);
+        threadPool->timerWheel = 0;
+    }
+
+    // broadcast thread termination
+    SyncLockMutex(threadPool->taskQueueData->queueMutex);
+    threadPool->terminateThread = 1;
+    WakeTaskQueue(threadPool->taskQueueData);
+    SyncUnlockMutex(threadPool->taskQueueData->queueMutex);
+
+    SyncLockMutex(&(threadPool->poolMutex));
+    SyncWakeAllWaiters(&(threadPool->poolWaiters));
+    SyncUnlockMutex(&(threadPool->poolMutex));
+
+    // wait for each thread to finish
+    SyncLockMutex(&(threadPool->spawnMutex));
+    for(i = 0; i < threadPool->numThreads; i++)
+    {
+        if(SyncAtomicLoad(&(threadPool->threadStates[i])) != THREAD_SLOT_FREE)
+        {
+            SyncJoinThread(threadPool->threadIds[i], NULL);
+        }
+    }
+    SyncUnlockMutex(&(threadPool->spawnMutex));
+
+    // items the threads took as they were told to terminate
+    for(i = 0; i < threadPool->numAbandoned; i++)
+    {
+        DestroyTaskQueueItem(threadPool->abandonedItems[i]);
+    }
+
+    // release the per-thread queues and any items left within them
+    if(threadPool->schedulerType == THREAD_POOL_SCHEDULER_WORK_STEALING)
+    {
+        for(i = 0; i < threadPool->numThreads; i++)
+        {
+            while((taskQueueItem = PopThreadDeque(threadPool->taskDeques[i])) != 0)
+            {
+                DestroyTaskQueueItem(taskQueueItem);
+            }
+            DestroyThreadDeque(threadPool->taskDeques[i]);
+            DestroyTaskQueue(threadPool->inboxQueues[i]);
+        }
+        free(threadPool->taskDeques);
+        free(threadPool->inboxQueues);
+    }
+    else if(threadPool->schedulerType == THREAD_POOL_SCHEDULER_AFFINITY)
+    {
+        for(i = 0; i < threadPool->numThreads; i++)
+        {
+            DestroyTaskQueue(threadPool->inboxQueues[i]);
+        }
+        free(threadPool->inboxQueues);
+        free((void*)threadPool->affinitySlots);
+    }
+
+    // destroy the pool mutexes
+    SyncDestroyMutex(&(threadPool->poolMutex));
+    SyncDestroyMutex(&(threadPool->spawnMutex));
+
+    // free up thread pool memory
+    free(threadPool->processorIds);
+    free(threadPool->abandonedItems);
+    free(threadPool->threadIds);
+    free((void*)threadPool->threadStates);
+    free(threadPool);
+}
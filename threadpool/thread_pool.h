@@ -11,18 +11,120 @@
 /* MACRO DEFINITIONS */
 /*---------------------------------------------------------------------------*/
 
-/* N/A */
+// maximum number of tasks a thread takes at once when none is specified
+#define THREAD_POOL_DEFAULT_BATCH_SIZE      16
+
+// upper limit of the number of tasks a thread takes at once
+#define THREAD_POOL_MAX_BATCH_SIZE          64
+
+// suggested queue wait (ms) before an elastic pool spawns another thread
+#define THREAD_POOL_DEFAULT_SPAWN_WAIT      10
+
+// suggested time (ms) an idle thread of an elastic pool waits before it retires
+#define THREAD_POOL_DEFAULT_IDLE_TIMEOUT    30000
+
+// suggested number of times an idle thread checks for tasks while spinning and then yielding before it parks
+#define THREAD_POOL_DEFAULT_SPIN_COUNT      4000
+#define THREAD_POOL_DEFAULT_YIELD_COUNT     16
+
+// suggested time (ms) a task waits for a busy thread that has its affinity key warm (affinity scheduler only)
+#define THREAD_POOL_DEFAULT_AFFINITY_WAIT   5
+
+// number of affinity keys tracked per thread (power of 2, at most three quarters are used)
+#define THREAD_POOL_MAX_WARM_KEYS           256
+
+// longest thread name prefix kept by a pool (the thread index is appended to it)
+#define THREAD_POOL_MAX_NAME_LENGTH         15
 
 /*---------------------------------------------------------------------------*/
 /* ENUMERATIONS */
 /*---------------------------------------------------------------------------*/
 
-/* N/A */
+// how tasks are distributed to the threads of a pool
+typedef enum THREAD_POOL_SCHEDULER_ENUM
+{
+    // every thread takes tasks from the shared task queue
+    THREAD_POOL_SCHEDULER_SHARED = 0,
+
+    // tasks are spread round-robin to per-thread deques, idle threads steal from other threads
+    THREAD_POOL_SCHEDULER_WORK_STEALING,
+
+    // tasks with an affinity key are routed to a thread that executed a task with the same key,
+    // preferring idle threads, other threads take them once they waited for affinityWaitTime
+    THREAD_POOL_SCHEDULER_AFFINITY
+
+} THREAD_POOL_SCHEDULER;
+
+// how the threads of a pool are placed on the processors
+typedef enum THREAD_POOL_AFFINITY_ENUM
+{
+    // threads may run on any of the pool's processors
+    THREAD_POOL_AFFINITY_NONE = 0,
+
+    // each thread is pinned to one processor, filling the cores of one package before the next
+    THREAD_POOL_AFFINITY_COMPACT,
+
+    // each thread is pinned to one processor, spreading threads across packages and cores first
+    THREAD_POOL_AFFINITY_SCATTER
+
+} THREAD_POOL_AFFINITY;
 
 /*---------------------------------------------------------------------------*/
 /* TYPE DECLARATIONS */
 /*---------------------------------------------------------------------------*/
 
+// use this structure to configure a thread pool when it is created
+typedef struct THREAD_POOL_OPTIONS_STRUCT
+{
+    // how tasks are distributed to the threads
+    THREAD_POOL_SCHEDULER   schedulerType;
+
+    // maximum number of tasks a thread takes at once, scaled down when the queue is shallow
+    // (0 uses THREAD_POOL_DEFAULT_BATCH_SIZE, limited to THREAD_POOL_MAX_BATCH_SIZE)
+    unsigned int            maxBatchSize;
+
+    // called on the thread before and after it executes a batch of tasks (optional)
+    void                    (*threadBatchEnter)(void *threadContext);
+    void                    (*threadBatchExit)(void *threadContext);
+
+    // time (ms) a task waits for a busy thread with its affinity key warm before any thread takes it
+    // (affinity scheduler only, 0 uses THREAD_POOL_DEFAULT_AFFINITY_WAIT)
+    unsigned int            affinityWaitTime;
+
+    // elastic sizing (shared scheduler only), the pool starts with numThreads threads
+    // and the defaults (0) keep it at numThreads threads
+
+    // maximum number of threads (0 uses numThreads)
+    unsigned int            maxThreads;
+
+    // number of threads idle threads retire down to
+    unsigned int            minThreads;
+
+    // time (ms) a thread waits for a task before it retires (0 never retires idle threads)
+    unsigned int            idleTimeout;
+
+    // queue wait (ms) after which another thread is spawned when tasks are added (0 never spawns)
+    unsigned int            spawnWaitTime;
+
+    // wait policy of an idle thread, it checks for tasks spinCount times while spinning,
+    // then yieldCount times while yielding its time slice and then parks (0 parks immediately)
+    unsigned int            spinCount;
+    unsigned int            yieldCount;
+
+    // placement of the threads on the processors of affinityCpus
+    // (NULL uses the processors the creating thread may run on, copied by the pool)
+    THREAD_POOL_AFFINITY    affinityPolicy;
+    const unsigned int      *affinityCpus;
+    unsigned int            numAffinityCpus;
+
+    // size (bytes) of each thread's stack (0 uses the default)
+    size_t                  stackSize;
+
+    // threads are named with this prefix followed by their index (NULL leaves them unnamed, copied by the pool)
+    const char              *threadName;
+
+} THREAD_POOL_OPTIONS;
+
 // forward declaration to hide implementation
 typedef struct THREAD_POOL_DATA_STRUCT THREAD_POOL_DATA;
 
@@ -34,7 +136,8 @@ typedef struct THREAD_POOL_DATA_STRUCT THREAD_POOL_DATA;
 extern "C" {
 #endif
 
-// this should only be called once per task queue
+// this should only be called once per task queue, threadInit is called on the calling thread,
+// which is the only thread that spawns threads after creation (when it adds tasks or resizes the pool)
 THREAD_POOL_DATA*   CreateThreadPool(
 	unsigned int numThreads,
 	TASK_QUEUE_DATA *taskQueueData,
@@ -42,6 +145,49 @@ THREAD_POOL_DATA*   CreateThreadPool(
 	void (*threadPostInit)(void* threadContext),
 	void (*threadDestory)(void* threadContext));
 
+// this should only be called once per task queue (NULL options uses the shared scheduler)
+THREAD_POOL_DATA*   CreateThreadPoolWithOptions(
+    unsigned int numThreads,
+    TASK_QUEUE_DATA *taskQueueData,
+    const THREAD_POOL_OPTIONS *poolOptions,
+    void* (*threadInit)(),
+    void (*threadPostInit)(void* threadContext),
+    void (*threadDestory)(void* threadContext));
+
+// thread safe, the task queue is only used directly by the shared scheduler
+// and as an overflow of the per-thread deques by the work stealing scheduler
+TASK_QUEUE_STATUS   AddTaskToThreadPool(THREAD_POOL_DATA *threadPool, TASK_QUEUE_ITEM *taskQueueItem);
+
+// thread safe, adds the items in order and wakes at most one thread per item added
+// numAdded (optional) receives the number of items added, the caller keeps ownership of the rest
+TASK_QUEUE_STATUS   AddTasksToThreadPool(THREAD_POOL_DATA *threadPool, TASK_QUEUE_ITEM **taskQueueItems, unsigned int numItems, unsigned int *numAdded);
+
+// thread safe, adds the item once delayMs elapsed, the pool takes ownership of the item unless it returns
+// TASK_QUEUE_STATUS_ADD_MALLOC_FAIL (an item due while the queue is full is added once the queue has room)
+TASK_QUEUE_STATUS   AddDelayedTaskToThreadPool(THREAD_POOL_DATA *threadPool, TASK_QUEUE_ITEM *taskQueueItem, unsigned int delayMs);
+
+// thread safe, adds the delayed items with the given task id immediately, returns the number of items found
+// (every delayed item is searched, use it for rare events such as cancellation)
+unsigned int        ExpireDelayedTasks(THREAD_POOL_DATA *threadPool, unsigned int taskId);
+
+// thread safe, unlinks a queued item from the task queue and returns it to the caller (0 if it is not there)
+// items within a ring queue, a per-thread deque or an inbox are not searched
+TASK_QUEUE_ITEM*    RemoveTaskFromThreadPool(THREAD_POOL_DATA *threadPool, unsigned int taskId, void *taskItemData);
+
+// returns the number of delayed items not yet due
+unsigned int        GetDelayedTaskCount(THREAD_POOL_DATA *threadPool);
+
+// thread safe, sets the number of threads of a shared scheduler pool (at most the maximum number of threads)
+// threads are spawned immediately, surplus threads retire once their current batch completes
+// returns 0 on success, -1 if the pool cannot be resized
+int                 ResizeThreadPool(THREAD_POOL_DATA *threadPool, unsigned int numThreads);
+
+// returns the number of running threads
+unsigned int        GetThreadPoolSize(THREAD_POOL_DATA *threadPool);
+
+// stores the affinity keys warm on a thread (affinity scheduler only), returns the number of keys stored
+unsigned int        GetThreadPoolWarmKeys(THREAD_POOL_DATA *threadPool, unsigned int threadIndex, unsigned int *affinityKeys, unsigned int maxKeys);
+
 // this should only be called once per thread pool and prior to destorying the associated task queue
 void                DestroyThreadPool(THREAD_POOL_DATA *threadPool);
 
@@ -0,0 +1,553 @@
+#define _TIMER_WHEEL_C_
+
+/*---------------------------------------------------------------------------*/
+/* FILE INCLUSION */
+/*---------------------------------------------------------------------------*/
+
+#include "timer_wheel.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*---------------------------------------------------------------------------*/
+/* MACRO DEFINITIONS */
+/*---------------------------------------------------------------------------*/
+
+// number of ticks spanned by a slot of a level
+#define TIMER_WHEEL_SLOT_SPAN(level)        (1ULL << ((level) * TIMER_WHEEL_LEVEL_BITS))
+
+// slot of a level a tick falls in
+#define TIMER_WHEEL_SLOT_INDEX(tick, level) ((unsigned int)(((tick) >> ((level) * TIMER_WHEEL_LEVEL_BITS)) & (TIMER_WHEEL_NUM_SLOTS - 1)))
+
+// maximum number of tasks handed to the due callback at once
+#define TIMER_WHEEL_DUE_BATCH_SIZE          64
+
+// tick the thread sleeps until while the wheel is empty
+#define TIMER_WHEEL_NO_TICK                 (~0ULL)
+
+/*---------------------------------------------------------------------------*/
+/* TYPE DECLARATIONS */
+/*---------------------------------------------------------------------------*/
+
+// task waiting within a slot
+typedef struct TIMER_WHEEL_NODE_STRUCT
+{
+    struct TIMER_WHEEL_NODE_STRUCT *nextNode;
+
+    // task and the tick it becomes due
+    TASK_QUEUE_ITEM     *taskQueueItem;
+    unsigned long long  dueTick;
+
+} TIMER_WHEEL_NODE;
+
+// tasks of a slot in the order they were placed
+typedef struct TIMER_WHEEL_SLOT_STRUCT
+{
+    TIMER_WHEEL_NODE    *slotHead;
+    TIMER_WHEEL_NODE    *slotTail;
+
+} TIMER_WHEEL_SLOT;
+
+// hierarchical timing wheel, level 0 holds the tasks due within a turn of its slots,
+// a slot of each level above holds the tasks due within a turn of the level below it
+// and is cascaded down once the level below wraps around to it
+struct TIMER_WHEEL_STRUCT
+{
+    // slots of each level and the number of tasks within each level
+    TIMER_WHEEL_SLOT    wheelSlots[TIMER_WHEEL_NUM_LEVELS][TIMER_WHEEL_NUM_SLOTS];
+    unsigned int        levelLengths[TIMER_WHEEL_NUM_LEVELS];
+
+    // time (ms) of tick 0 and the next tick to be processed (every earlier tick was processed)
+    unsigned long long  startTime;
+    unsigned long long  currentTick;
+
+    // tick the thread sleeps until (0 while it is awake)
+    unsigned long long  wakeTick;
+
+    // number of tasks not yet handed to the due callback
+    unsigned int        numTasks;
+
+    // receives the tasks once they are due
+    TIMER_WHEEL_DUE_CALLBACK dueCallback;
+    void                *dueContext;
+
+    // nodes are recycled through a pool
+    MEMORY_POOL         *nodePool;
+
+    // thread advancing the wheel and its terminate signal
+    THREAD              wheelThread;
+    unsigned int        terminateThread;
+
+    // synchronization mechanisms
+    THREAD_MUTEX        wheelMutex;
+    THREAD_COND         wheelCond;
+
+}; /* TIMER_WHEEL */
+
+/*---------------------------------------------------------------------------*/
+/* STATIC FUNCTION DEFINITIONS */
+/*---------------------------------------------------------------------------*/
+
+// tick of the current time
+static unsigned long long GetTimerWheelTick(TIMER_WHEEL *timerWheel)
+{
+    return (SyncGetTime() - timerWheel->startTime) / TIMER_WHEEL_TICK_TIME;
+}
+
+// appends a node to a list
+static void AppendTimerNode(TIMER_WHEEL_NODE **listHead, TIMER_WHEEL_NODE **listTail, TIMER_WHEEL_NODE *timerNode)
+{
+    timerNode->nextNode = 0;
+    if(*listTail != 0)
+    {
+        (*listTail)->nextNode = timerNode;
+    }
+    else
+    {
+        *listHead = timerNode;
+    }
+    *listTail = timerNode;
+}
+
+// places a node in the slot of the lowest level whose turn reaches its due tick (mutex must be held)
+static void PlaceTimerNode(TIMER_WHEEL *timerWheel, TIMER_WHEEL_NODE *timerNode)
+{
+    // level and slot receiving the node
+    unsigned int level = 0;
+    TIMER_WHEEL_SLOT *wheelSlot = 0;
+
+    // ticks until the node is due and the tick selecting its slot
+    unsigned long long dueDelta = 0;
+    unsigned long long slotTick = 0;
+
+    // a tick that already passed is processed next
+    if(timerNode->dueTick < timerWheel->currentTick)
+    {
+        timerNode->dueTick = timerWheel->currentTick;
+    }
+    dueDelta = timerNode->dueTick - timerWheel->currentTick;
+    slotTick = timerNode->dueTick;
+
+    for(level = 0; level < TIMER_WHEEL_NUM_LEVELS - 1; level++)
+    {
+        if(dueDelta < TIMER_WHEEL_SLOT_SPAN(level + 1))
+        {
+            break;
+        }
+    }
+
+    // beyond the top level, park the node a turn ahead where it is placed again once it cascades
+    if(dueDelta >= TIMER_WHEEL_SLOT_SPAN(TIMER_WHEEL_NUM_LEVELS))
+    {
+        slotTick = timerWheel->currentTick + TIMER_WHEEL_SLOT_SPAN(TIMER_WHEEL_NUM_LEVELS) - TIMER_WHEEL_SLOT_SPAN(TIMER_WHEEL_NUM_LEVELS - 1);
+    }
+
+    wheelSlot = &(timerWheel->wheelSlots[level][TIMER_WHEEL_SLOT_INDEX(slotTick, level)]);
+    AppendTimerNode(&(wheelSlot->slotHead), &(wheelSlot->slotTail), timerNode);
+    timerWheel->levelLengths[level]++;
+}
+
+// removes every node from a slot and returns them as a list (mutex must be held)
+static TIMER_WHEEL_NODE* TakeTimerSlot(TIMER_WHEEL *timerWheel, unsigned int level, unsigned int slotIndex)
+{
+    // nodes of the slot
+    TIMER_WHEEL_SLOT *wheelSlot = &(timerWheel->wheelSlots[level][slotIndex]);
+    TIMER_WHEEL_NODE *slotNodes = wheelSlot->slotHead;
+    TIMER_WHEEL_NODE *timerNode = 0;
+
+    for(timerNode = slotNodes; timerNode != 0; timerNode = timerNode->nextNode)
+    {
+        timerWheel->levelLengths[level]--;
+    }
+    wheelSlot->slotHead = 0;
+    wheelSlot->slotTail = 0;
+
+    return slotNodes;
+}
+
+// returns the first tick from the current tick on that moves tasks, a slot holding tasks
+// that is reached by level 0 or cascaded (mutex must be held, the wheel must not be empty)
+static unsigned long long GetNextTimerTick(TIMER_WHEEL *timerWheel)
+{
+    // loop variables
+    unsigned int level = 0;
+    unsigned int i = 0;
+
+    // ticks spanned by a slot of the level and the first tick of the slot being checked
+    unsigned long long slotSpan = 0;
+    unsigned long long slotTick = 0;
+
+    // return value
+    unsigned long long nextTick = TIMER_WHEEL_NO_TICK;
+
+    // a turn of each level reaches every one of its slots
+    for(level = 0; level < TIMER_WHEEL_NUM_LEVELS; level++)
+    {
+        if(timerWheel->levelLengths[level] == 0)
+        {
+            continue;
+        }
+
+        slotSpan = TIMER_WHEEL_SLOT_SPAN(level);
+        slotTick = (timerWheel->currentTick + slotSpan - 1) & ~(slotSpan - 1);
+        for(i = 0; (i < TIMER_WHEEL_NUM_SLOTS) && (slotTick < nextTick); i++, slotTick += slotSpan)
+        {
+            if(timerWheel->wheelSlots[level][TIMER_WHEEL_SLOT_INDEX(slotTick, level)].slotHead != 0)
+            {
+                nextTick = slotTick;
+                break;
+            }
+        }
+    }
+
+    return nextTick;
+}
+
+// processes the current tick, cascading the slots of the levels that wrap around
+// and appending the tasks due to the due list (mutex must be held)
+static void ProcessTimerTick(TIMER_WHEEL *timerWheel, TIMER_WHEEL_NODE **dueHead, TIMER_WHEEL_NODE **dueTail)
+{
+    // loop variable
+    unsigned int level = 0;
+
+    // nodes being moved
+    TIMER_WHEEL_NODE *timerNodes = 0;
+    TIMER_WHEEL_NODE *timerNode = 0;
+
+    // tick being processed
+    unsigned long long currentTick = timerWheel->currentTick;
+
+    // each level wraps around once the level below it does
+    for(level = 1; level < TIMER_WHEEL_NUM_LEVELS; level++)
+    {
+        if((currentTick & (TIMER_WHEEL_SLOT_SPAN(level) - 1)) != 0)
+        {
+            break;
+        }
+
+        timerNodes = TakeTimerSlot(timerWheel, level, TIMER_WHEEL_SLOT_INDEX(currentTick, level));
+        while(timerNodes != 0)
+        {
+            timerNode = timerNodes;
+            timerNodes = timerNode->nextNode;
+            PlaceTimerNode(timerWheel, timerNode);
+        }
+    }
+
+    // the tasks of the level 0 slot are due
+    timerNodes = TakeTimerSlot(timerWheel, 0, TIMER_WHEEL_SLOT_INDEX(currentTick, 0));
+    while(timerNodes != 0)
+    {
+        timerNode = timerNodes;
+        timerNodes = timerNode->nextNode;
+        AppendTimerNode(dueHead, dueTail, timerNode);
+        timerWheel->numTasks--;
+    }
+
+    timerWheel->currentTick = currentTick + 1;
+}
+
+// places the tasks of a list again, due at the given tick (mutex must be held)
+static void RearmTimerNodes(TIMER_WHEEL *timerWheel, TIMER_WHEEL_NODE *timerNodes, unsigned long long dueTick)
+{
+    // node being placed
+    TIMER_WHEEL_NODE *timerNode = 0;
+
+    while(timerNodes != 0)
+    {
+        timerNode = timerNodes;
+        timerNodes = timerNode->nextNode;
+        timerNode->dueTick = dueTick;
+        PlaceTimerNode(timerWheel, timerNode);
+        timerWheel->numTasks++;
+    }
+}
+
+// hands the due tasks to the due callback in batches, the tasks it does not take are offered again later
+static void DeliverTimerNodes(TIMER_WHEEL *timerWheel, TIMER_WHEEL_NODE *dueNodes)
+{
+    // loop variable
+    unsigned int i = 0;
+
+    // batch of tasks and their nodes
+    TASK_QUEUE_ITEM *taskQueueItems[TIMER_WHEEL_DUE_BATCH_SIZE];
+    TIMER_WHEEL_NODE *batchNodes[TIMER_WHEEL_DUE_BATCH_SIZE];
+    unsigned int numItems = 0;
+
+    // number of tasks taken by the due callback
+    unsigned int numTaken = 0;
+
+    while(dueNodes != 0)
+    {
+        // take a batch off the list
+        for(numItems = 0; (numItems < TIMER_WHEEL_DUE_BATCH_SIZE) && (dueNodes != 0); numItems++)
+        {
+            batchNodes[numItems] = dueNodes;
+            taskQueueItems[numItems] = dueNodes->taskQueueItem;
+            dueNodes = dueNodes->nextNode;
+        }
+
+        numTaken = timerWheel->dueCallback(timerWheel->dueContext, taskQueueItems, numItems);
+        for(i = 0; i < numTaken; i++)
+        {
+            FreeMemoryPoolBlock(timerWheel->nodePool, batchNodes[i]);
+        }
+
+        // the callback can't take more right now, offer the rest of the tasks again later
+        if(numTaken < numItems)
+        {
+            batchNodes[numItems - 1]->nextNode = dueNodes;
+            SyncLockMutex(&(timerWheel->wheelMutex));
+            RearmTimerNodes(timerWheel, batchNodes[numTaken], GetTimerWheelTick(timerWheel) + (TIMER_WHEEL_RETRY_TIME / TIMER_WHEEL_TICK_TIME));
+            SyncUnlockMutex(&(timerWheel->wheelMutex));
+            break;
+        }
+    }
+}
+
+// advances the wheel as time passes and sleeps until the next tick that moves tasks
+static THREAD_FUNC WINAPI TimerWheelFunction(void *threadArg)
+{
+    // wheel advanced by the thread
+    TIMER_WHEEL *timerWheel = (TIMER_WHEEL*)threadArg;
+
+    // tasks that became due
+    TIMER_WHEEL_NODE *dueHead = 0;
+    TIMER_WHEEL_NODE *dueTail = 0;
+
+    // tick of the current time and the next tick that moves tasks
+    unsigned long long nowTick = 0;
+    unsigned long long nextTick = 0;
+
+    SyncLockMutex(&(timerWheel->wheelMutex));
+    while(timerWheel->terminateThread == 0)
+    {
+        timerWheel->wakeTick = 0;
+
+        // process every tick that moves tasks up to the current time, skipping the others
+        nowTick = GetTimerWheelTick(timerWheel);
+        nextTick = TIMER_WHEEL_NO_TICK;
+        while(timerWheel->numTasks > 0)
+        {
+            nextTick = GetNextTimerTick(timerWheel);
+            if(nextTick > nowTick)
+            {
+                break;
+            }
+            timerWheel->currentTick = nextTick;
+            ProcessTimerTick(timerWheel, &dueHead, &dueTail);
+        }
+        if(timerWheel->currentTick <= nowTick)
+        {
+            timerWheel->currentTick = nowTick + 1;
+        }
+
+        // deliver the due tasks without holding the mutex, time moved on once they are delivered
+        if(dueHead != 0)
+        {
+            SyncUnlockMutex(&(timerWheel->wheelMutex));
+            DeliverTimerNodes(timerWheel, dueHead);
+            dueHead = 0;
+            dueTail = 0;
+            SyncLockMutex(&(timerWheel->wheelMutex));
+            continue;
+        }
+
+        // sleep until the next tick that moves tasks, or until a task is added ahead of it
+        if(timerWheel->numTasks == 0)
+        {
+            timerWheel->wakeTick = TIMER_WHEEL_NO_TICK;
+            SyncWaitCond(&(timerWheel->wheelCond), &(timerWheel->wheelMutex));
+        }
+        else
+        {
+            timerWheel->wakeTick = nextTick;
+            SyncTimedWaitCond(&(timerWheel->wheelCond), &(timerWheel->wheelMutex), (unsigned int)((nextTick - nowTick) * TIMER_WHEEL_TICK_TIME));
+        }
+    }
+    SyncUnlockMutex(&(timerWheel->wheelMutex));
+
+    // hand the blocks cached by this thread back to their pools
+    FlushMemoryPoolCaches();
+
+#ifdef _WIN32
+    _endthreadex(0);
+#endif
+
+    return THREAD_FUNC_RETURN;
+}
+
+/*---------------------------------------------------------------------------*/
+/* FUNCTION DEFINITIONS */
+/*---------------------------------------------------------------------------*/
+
+TIMER_WHEEL* CreateTimerWheel(TIMER_WHEEL_DUE_CALLBACK dueCallback, void *dueContext)
+{
+    // wheel to be returned
+    TIMER_WHEEL *timerWheel = (TIMER_WHEEL*)malloc(sizeof(TIMER_WHEEL));
+    if(timerWheel == 0)
+    {
+        return 0;
+    }
+    memset(timerWheel, 0, sizeof(TIMER_WHEEL));
+
+    timerWheel->startTime = SyncGetTime();
+    timerWheel->dueCallback = dueCallback;
+    timerWheel->dueContext = dueContext;
+    timerWheel->nodePool = GetMemoryPool(sizeof(TIMER_WHEEL_NODE));
+    SyncCreateMutex(&(timerWheel->wheelMutex), NULL);
+    SyncCreateCond(&(timerWheel->wheelCond), NULL);
+
+    if((timerWheel->nodePool == 0) || (SyncCreateThread(&(timerWheel->wheelThread), NULL, TimerWheelFunction, timerWheel) != 0))
+    {
+        SyncDestroyCond(&(timerWheel->wheelCond));
+        SyncDestroyMutex(&(timerWheel->wheelMutex));
+        free(timerWheel);
+        return 0;
+    }
+
+    return timerWheel;
+}
+
+TASK_QUEUE_STATUS AddTimerWheelTask(TIMER_WHEEL *timerWheel, TASK_QUEUE_ITEM *taskQueueItem, unsigned int delayMs)
+{
+    // node holding the task
+    TIMER_WHEEL_NODE *timerNode = (TIMER_WHEEL_NODE*)AllocMemoryPoolBlock(timerWheel->nodePool);
+    if(timerNode == 0)
+    {
+        return TASK_QUEUE_STATUS_ADD_MALLOC_FAIL;
+    }
+    timerNode->taskQueueItem = taskQueueItem;
+
+    SyncLockMutex(&(timerWheel->wheelMutex));
+
+    // the ticks of an empty wheel need not be processed
+    timerNode->dueTick = GetTimerWheelTick(timerWheel);
+    if((timerWheel->numTasks == 0) && (timerWheel->currentTick < timerNode->dueTick))
+    {
+        timerWheel->currentTick = timerNode->dueTick;
+    }
+    timerNode->dueTick += (delayMs + TIMER_WHEEL_TICK_TIME - 1) / TIMER_WHEEL_TICK_TIME;
+
+    PlaceTimerNode(timerWheel, timerNode);
+    timerWheel->numTasks++;
+
+    // wake the thread if the task is due before it would wake up
+    if(timerNode->dueTick < timerWheel->wakeTick)
+    {
+        SyncSignalCond(&(timerWheel->wheelCond));
+    }
+
+    SyncUnlockMutex(&(timerWheel->wheelMutex));
+
+    return TASK_QUEUE_STATUS_ADD_SUCCESS;
+}
+
+unsigned int ExpireTimerWheelTasks(TIMER_WHEEL *timerWheel, unsigned int taskId)
+{
+    // loop variables
+    unsigned int level = 0;
+    unsigned int i = 0;
+
+    // link to the node being checked and the slot holding it
+    TIMER_WHEEL_NODE **nodeLink = 0;
+    TIMER_WHEEL_SLOT *wheelSlot = 0;
+
+    // nodes of the tasks found
+    TIMER_WHEEL_NODE *expiredHead = 0;
+    TIMER_WHEEL_NODE *expiredTail = 0;
+    TIMER_WHEEL_NODE *timerNode = 0;
+
+    // return value
+    unsigned int numExpired = 0;
+
+    SyncLockMutex(&(timerWheel->wheelMutex));
+
+    for(level = 0; level < TIMER_WHEEL_NUM_LEVELS; level++)
+    {
+        for(i = 0; (i < TIMER_WHEEL_NUM_SLOTS) && (timerWheel->levelLengths[level] > 0); i++)
+        {
+            wheelSlot = &(timerWheel->wheelSlots[level][i]);
+            wheelSlot->slotTail = 0;
+            nodeLink = &(wheelSlot->slotHead);
+            while(*nodeLink != 0)
+            {
+                timerNode = *nodeLink;
+                if(timerNode->taskQueueItem->taskId != taskId)
+                {
+                    wheelSlot->slotTail = timerNode;
+                    nodeLink = &(timerNode->nextNode);
+                    continue;
+                }
+
+                *nodeLink = timerNode->nextNode;
+                timerWheel->levelLengths[level]--;
+                timerWheel->numTasks--;
+                AppendTimerNode(&expiredHead, &expiredTail, timerNode);
+                numExpired++;
+            }
+        }
+    }
+
+    // the tasks are due with the next tick processed
+    if(expiredHead != 0)
+    {
+        RearmTimerNodes(timerWheel, expiredHead, timerWheel->currentTick);
+        SyncSignalCond(&(timerWheel->wheelCond));
+    }
+
+    SyncUnlockMutex(&(timerWheel->wheelMutex));
+
+    return numExpired;
+}
+
+unsigned int GetTimerWheelLength(TIMER_WHEEL *timerWheel)
+{
+    // return value
+    unsigned int numTasks = 0;
+
+    SyncLockMutex(&(timerWheel->wheelMutex));
+    numTasks = timerWheel->numTasks;
+    SyncUnlockMutex(&(timerWheel->wheelMutex));
+
+    return numTasks;
+}
+
+void DestroyTimerWheel(TIMER_WHEEL *timerWheel)
+{
+    // loop variables
+    unsigned int level = 0;
+    unsigned int i = 0;
+
+    // node being destroyed
+    TIMER_WHEEL_NODE *timerNodes = 0;
+    TIMER_WHEEL_NODE *timerNode = 0;
+
+    // stop the thread
+    SyncLockMutex(&(timerWheel->wheelMutex));
+    timerWheel->terminateThread = 1;
+    SyncSignalCond(&(timerWheel->wheelCond));
+    SyncUnlockMutex(&(timerWheel->wheelMutex));
+    SyncJoinThread(timerWheel->wheelThread, NULL);
+
+    // destroy the tasks that are not yet due, the thread no longer touches the wheel
+    for(level = 0; level < TIMER_WHEEL_NUM_LEVELS; level++)
+    {
+        for(i = 0; i < TIMER_WHEEL_NUM_SLOTS; i++)
+        {
+            timerNodes = timerWheel->wheelSlots[level][i].slotHead;
+            while(timerNodes != 0)
+            {
+                timerNode = timerNodes;
+                timerNodes = timerNode->nextNode;
+                DestroyTaskQueueItem(timerNode->taskQueueItem);
+                FreeMemoryPoolBlock(timerWheel->nodePool, timerNode);
+            }
+        }
+    }
+
+    SyncDestroyCond(&(timerWheel->wheelCond));
+    SyncDestroyMutex(&(timerWheel->wheelMutex));
+    free(timerWheel);
+}
@@ -0,0 +1,86 @@
+#ifndef _TIMER_WHEEL_H_
+#define _TIMER_WHEEL_H_
+
+/*---------------------------------------------------------------------------*/
+/* FILE INCLUSION */
+/*---------------------------------------------------------------------------*/
+
+#include "synchronize.h"
+#include "task_queue.h"
+
+/*---------------------------------------------------------------------------*/
+/* MACRO DEFINITIONS */
+/*---------------------------------------------------------------------------*/
+
+// resolution (ms) of the wheel, one tick per slot of the lowest level
+#define TIMER_WHEEL_TICK_TIME           1
+
+// each level has 2^TIMER_WHEEL_LEVEL_BITS slots, a slot of a level spans a full turn of the level below it
+#define TIMER_WHEEL_LEVEL_BITS          6
+#define TIMER_WHEEL_NUM_SLOTS           (1 << TIMER_WHEEL_LEVEL_BITS)
+#define TIMER_WHEEL_NUM_LEVELS          4
+
+// time (ms) before a task the due callback did not take is offered again
+#define TIMER_WHEEL_RETRY_TIME          1
+
+/*---------------------------------------------------------------------------*/
+/* ENUMERATIONS */
+/*---------------------------------------------------------------------------*/
+
+/* N/A */
+
+/*---------------------------------------------------------------------------*/
+/* TYPE DECLARATIONS */
+/*---------------------------------------------------------------------------*/
+
+// called on the wheel's thread with the tasks that are due, in the order they became due
+// returns the number of leading tasks it took ownership of, the rest are offered again after TIMER_WHEEL_RETRY_TIME
+typedef unsigned int (*TIMER_WHEEL_DUE_CALLBACK)(void *dueContext, TASK_QUEUE_ITEM **taskQueueItems, unsigned int numItems);
+
+// forward declaration to hide implementation
+typedef struct TIMER_WHEEL_STRUCT TIMER_WHEEL;
+
+/*---------------------------------------------------------------------------*/
+// FUNCTION PROTOTYPES
+// These methods can be called from application code.
+/*---------------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// creates a hierarchical timing wheel and the thread that advances it (0 if it could not be created)
+// the thread sleeps until the next tick with tasks to move, and indefinitely while the wheel is empty
+TIMER_WHEEL*        CreateTimerWheel(TIMER_WHEEL_DUE_CALLBACK dueCallback, void *dueContext);
+
+// thread safe, adds a task that becomes due after delayMs (constant time)
+// the wheel takes ownership of the item unless it returns TASK_QUEUE_STATUS_ADD_MALLOC_FAIL
+TASK_QUEUE_STATUS   AddTimerWheelTask(TIMER_WHEEL *timerWheel, TASK_QUEUE_ITEM *taskQueueItem, unsigned int delayMs);
+
+// thread safe, makes the tasks with the given id due immediately, returns the number of tasks found
+// (every slot is searched, use it for rare events such as cancellation)
+unsigned int        ExpireTimerWheelTasks(TIMER_WHEEL *timerWheel, unsigned int taskId);
+
+// returns the number of tasks within the wheel
+unsigned int        GetTimerWheelLength(TIMER_WHEEL *timerWheel);
+
+// stops the thread and destroys the tasks that are not yet due
+void                DestroyTimerWheel(TIMER_WHEEL *timerWheel);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+/* OBJECT DECLARATIONS */
+/*---------------------------------------------------------------------------*/
+
+#ifndef _TIMER_WHEEL_C_
+
+/* N/A */
+
+#endif /* _TIMER_WHEEL_C_ */
+
+/*****************************************************************************/
+
+#endif /* _TIMER_WHEEL_H_ */